@@ -0,0 +1,197 @@
+#include "collate.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Collation works on a byte "sort string" derived from the name:
+// - ASCII letters are folded to lowercase
+// - A run of digits becomes a marker byte, its significant digit count and
+//   the digits themselves, so shorter numbers sort before longer ones
+// The sort string never contains a zero byte, so zero padding in packed keys
+// always sorts a shorter string first.
+#define COLLATE_MAX_STREAM 640
+#define COLLATE_DIGIT_MARK '0'
+#define COLLATE_KEY_BYTES 8
+
+// Runs shorter than this are insertion sorted instead of radix sorted
+#define COLLATE_SMALL_RUN 24
+
+static int is_digit(unsigned char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Build the sort string for a name, returns its length.
+// Stops early once `want` bytes are produced (callers only needing a prefix).
+static int collate_stream(const char *name, uint8_t *out, int max, int want) {
+    const unsigned char *p = (const unsigned char *)name;
+    int len = 0;
+
+    while (*p && len < want) {
+        if (is_digit(*p)) {
+            // Skip leading zeros, but keep the last zero of a run like "000"
+            while (*p == '0' && is_digit(p[1])) p++;
+
+            const unsigned char *start = p;
+            while (is_digit(*p)) p++;
+
+            int digits = p - start;
+            if (len + 2 + digits > max) break;
+
+            out[len++] = COLLATE_DIGIT_MARK;
+            out[len++] = (uint8_t)(digits > 255 ? 255 : digits);
+            memcpy(out + len, start, digits);
+            len += digits;
+        } else {
+            if (len + 1 > max) break;
+
+            unsigned char c = *p++;
+            if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+            out[len++] = c;
+        }
+    }
+    return len;
+}
+
+// Pack sort string bytes [offset, offset + 8) big-endian, zero padded
+static uint64_t collate_key_at(const char *name, int offset) {
+    uint8_t stream[COLLATE_MAX_STREAM];
+    int len = collate_stream(name, stream, sizeof(stream), offset + COLLATE_KEY_BYTES);
+
+    uint64_t key = 0;
+    for (int i = 0; i < COLLATE_KEY_BYTES; i++) {
+        int pos = offset + i;
+        key = (key << 8) | (pos < len ? stream[pos] : 0);
+    }
+    return key;
+}
+
+uint64_t collate_key(const char *name) {
+    return collate_key_at(name, 0);
+}
+
+int collate_compare(const char *a, const char *b) {
+    uint8_t stream_a[COLLATE_MAX_STREAM];
+    uint8_t stream_b[COLLATE_MAX_STREAM];
+    int len_a = collate_stream(a, stream_a, sizeof(stream_a), sizeof(stream_a));
+    int len_b = collate_stream(b, stream_b, sizeof(stream_b), sizeof(stream_b));
+
+    int common = len_a < len_b ? len_a : len_b;
+    int result = memcmp(stream_a, stream_b, common);
+    if (result != 0) return result;
+    if (len_a != len_b) return len_a - len_b;
+
+    // Same sort string ("Tetris" vs "TETRIS", "Game 02" vs "Game 2"):
+    // fall back to raw bytes so the order is still total and stable
+    return strcmp(a, b);
+}
+
+// LSD radix sort on the 64-bit keys, skipping bytes that are equal everywhere
+static void radix_sort(CollateItem *items, CollateItem *tmp, int count) {
+    uint32_t counts[COLLATE_KEY_BYTES][256];
+    memset(counts, 0, sizeof(counts));
+
+    // One histogram pass for all key bytes
+    for (int i = 0; i < count; i++) {
+        uint64_t key = items[i].key;
+        for (int b = 0; b < COLLATE_KEY_BYTES; b++) {
+            counts[b][(key >> (b * 8)) & 0xFF]++;
+        }
+    }
+
+    CollateItem *src = items;
+    CollateItem *dst = tmp;
+
+    for (int b = 0; b < COLLATE_KEY_BYTES; b++) {
+        int shift = b * 8;
+
+        // All items share this byte - the pass would not move anything
+        if (counts[b][(src[0].key >> shift) & 0xFF] == (uint32_t)count) continue;
+
+        uint32_t offset = 0;
+        for (int v = 0; v < 256; v++) {
+            uint32_t c = counts[b][v];
+            counts[b][v] = offset;
+            offset += c;
+        }
+
+        for (int i = 0; i < count; i++) {
+            dst[counts[b][(src[i].key >> shift) & 0xFF]++] = src[i];
+        }
+
+        CollateItem *swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != items) {
+        memcpy(items, src, count * sizeof(CollateItem));
+    }
+}
+
+static void insertion_sort_by_key(CollateItem *items, int count) {
+    for (int i = 1; i < count; i++) {
+        CollateItem item = items[i];
+        int j = i - 1;
+        while (j >= 0 && items[j].key > item.key) {
+            items[j + 1] = items[j];
+            j--;
+        }
+        items[j + 1] = item;
+    }
+}
+
+static int compare_raw_names(const void *a, const void *b) {
+    return strcmp(((const CollateItem *)a)->name, ((const CollateItem *)b)->name);
+}
+
+static void sort_by_key(CollateItem *items, CollateItem *tmp, int count) {
+    if (count < COLLATE_SMALL_RUN || !tmp) {
+        insertion_sort_by_key(items, count);
+    } else {
+        radix_sort(items, tmp, count);
+    }
+}
+
+// Items are sorted by the key at `offset`; sort each run of equal keys by the
+// next 8 sort string bytes until the runs are resolved
+static void refine_runs(CollateItem *items, CollateItem *tmp, int count, int offset) {
+    int start = 0;
+    while (start < count) {
+        int end = start + 1;
+        while (end < count && items[end].key == items[start].key) end++;
+
+        int run = end - start;
+        if (run > 1) {
+            // A zero low byte means every sort string in the run has ended
+            int exhausted = (items[start].key & 0xFF) == 0 ||
+                            offset + COLLATE_KEY_BYTES >= COLLATE_MAX_STREAM;
+
+            if (exhausted) {
+                qsort(items + start, run, sizeof(CollateItem), compare_raw_names);
+            } else {
+                int next_offset = offset + COLLATE_KEY_BYTES;
+                for (int i = start; i < end; i++) {
+                    items[i].key = collate_key_at(items[i].name, next_offset);
+                }
+                sort_by_key(items + start, tmp, run);
+                refine_runs(items + start, tmp, run, next_offset);
+            }
+        }
+        start = end;
+    }
+}
+
+void collate_sort(CollateItem *items, int count) {
+    if (!items || count < 2) return;
+
+    CollateItem *tmp = (CollateItem*)malloc(count * sizeof(CollateItem));
+    if (!tmp) {
+        // Out of memory - insertion sort never needs the scratch buffer
+        insertion_sort_by_key(items, count);
+        refine_runs(items, NULL, count, 0);
+        return;
+    }
+
+    sort_by_key(items, tmp, count);
+    refine_runs(items, tmp, count, 0);
+    free(tmp);
+}
@@ -0,0 +1,26 @@
+#ifndef COLLATE_H
+#define COLLATE_H
+
+#include <stdint.h>
+
+// Names sort case-insensitively with digit runs compared by numeric value,
+// so "Mega Man 2" comes before "Mega Man 10" and "zelda" after "Tetris".
+
+// Sort item: packed key plus the name used to break key ties
+typedef struct {
+    uint64_t key;
+    const char *name;
+    int index;      // Caller's position for the item (e.g. entries[] index)
+} CollateItem;
+
+// Packed collation key: first 8 bytes of the folded, number-aware sort string
+uint64_t collate_key(const char *name);
+
+// Full comparison, consistent with collate_key ordering (<0, 0, >0)
+int collate_compare(const char *a, const char *b);
+
+// Sort items by key, refining equal keys until the order is total.
+// Item keys are reused as scratch space and do not survive the sort.
+void collate_sort(CollateItem *items, int count);
+
+#endif // COLLATE_H
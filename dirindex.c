@@ -0,0 +1,1149 @@
+#include "dirindex.h"
+#include "collate.h"
+#include "hash.h"
+#include "zip.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+#ifdef SF2000
+#include "../../debug.h"
+#include "../../dirent.h"
+#else
+#include <dirent.h>
+#define xlog printf
+#endif
+
+#define DIRINDEX_NAME_MAX 255
+
+// Open index state - only the header tables live in RAM
+static FILE *index_fp = NULL;
+static DirIndexHeader index_header;
+static uint32_t index_byte_start[257];
+static long index_records_offset = 0;
+static long index_strings_offset = 0;
+static long index_journal_end = 0;
+static char index_dir_path[512];
+static char index_file_path[512];
+
+// Subfolder table of an open tree index
+static DirIndexFolder *index_folders = NULL;
+static char *index_folder_names = NULL;
+
+// Decode buffers for dirindex_read (records are read in one batch)
+static DirIndexRecord read_records[DIRINDEX_MAX_READ];
+static char read_names[DIRINDEX_MAX_READ * (DIRINDEX_NAME_MAX + 1)];
+
+// Overlay of journaled changes: file records hidden by a remove (ascending
+// record numbers) and added entries in collation order, each with the number
+// of file records that sort before it
+typedef struct {
+    uint64_t sort_key;
+    uint32_t record_pos;
+    uint32_t size;
+    int is_dir;
+    char name[DIRINDEX_NAME_MAX + 1];
+} DirIndexInsert;
+
+static uint32_t overlay_removed[DIRINDEX_MAX_JOURNAL];
+static int overlay_removed_count = 0;
+static DirIndexInsert overlay_inserted[DIRINDEX_MAX_JOURNAL];
+static int overlay_inserted_count = 0;
+
+// Merged reads copy names here, since file records are read in batches
+static char merged_names[DIRINDEX_MAX_READ * (DIRINDEX_NAME_MAX + 1)];
+
+static int replay_journal(void);
+static int read_records_at(int first, int count, DirIndexItem *items);
+static void tree_build_free(void);
+
+static void get_index_path(const char *dir_path, char *index_path, size_t index_path_size) {
+    snprintf(index_path, index_path_size, DIRINDEX_CACHE_PATTERN, (unsigned)hash_string(dir_path));
+}
+
+// Records start on an 8-byte boundary after the variable-length path
+static long get_records_offset(uint32_t path_len) {
+    long offset = sizeof(DirIndexHeader) + sizeof(index_byte_start) + path_len + 1;
+    return (offset + 7) & ~7L;
+}
+
+// Folder entries collected while building an index
+typedef struct {
+    char *names;
+    uint32_t names_size;
+    uint32_t names_capacity;
+    uint32_t *name_offsets;
+    uint32_t *sizes;
+    uint8_t *is_dir;
+    uint32_t *folders;      // Subfolder of each entry (tree builds only)
+    uint32_t folder;        // Subfolder the next added entries belong to
+    int count;
+    int capacity;
+    int failed;
+
+    // Subfolder table (tree builds only)
+    DirIndexFolder *folder_table;
+    int folder_count;
+    int folder_capacity;
+    char *folder_names;
+    uint32_t folder_names_size;
+    uint32_t folder_names_capacity;
+} DirIndexBuilder;
+
+static void builder_add(DirIndexBuilder *b, const char *name, int is_dir, uint32_t size) {
+    uint32_t len = strlen(name);
+    if (len > DIRINDEX_NAME_MAX) return;  // Too long to launch anyway
+
+    if (b->count >= b->capacity) {
+        int new_capacity = b->capacity ? b->capacity * 2 : 256;
+        uint32_t *new_offsets = (uint32_t*)realloc(b->name_offsets, new_capacity * sizeof(uint32_t));
+        if (!new_offsets) { b->failed = 1; return; }
+        b->name_offsets = new_offsets;
+        uint32_t *new_sizes = (uint32_t*)realloc(b->sizes, new_capacity * sizeof(uint32_t));
+        if (!new_sizes) { b->failed = 1; return; }
+        b->sizes = new_sizes;
+        uint8_t *new_is_dir = (uint8_t*)realloc(b->is_dir, new_capacity);
+        if (!new_is_dir) { b->failed = 1; return; }
+        b->is_dir = new_is_dir;
+        if (b->folder_table) {
+            uint32_t *new_folders = (uint32_t*)realloc(b->folders, new_capacity * sizeof(uint32_t));
+            if (!new_folders) { b->failed = 1; return; }
+            b->folders = new_folders;
+        }
+        b->capacity = new_capacity;
+    }
+
+    if (b->names_size + len + 1 > b->names_capacity) {
+        uint32_t new_capacity = b->names_capacity ? b->names_capacity * 2 : 8192;
+        while (new_capacity < b->names_size + len + 1) new_capacity *= 2;
+        char *new_names = (char*)realloc(b->names, new_capacity);
+        if (!new_names) { b->failed = 1; return; }
+        b->names = new_names;
+        b->names_capacity = new_capacity;
+    }
+
+    memcpy(b->names + b->names_size, name, len + 1);
+    b->name_offsets[b->count] = b->names_size;
+    b->is_dir[b->count] = (uint8_t)is_dir;
+    b->sizes[b->count] = size;
+    if (b->folder_table) b->folders[b->count] = b->folder;
+    b->names_size += len + 1;
+    b->count++;
+}
+
+// Add a subfolder to a tree build, returns its folder number or -1. The
+// first call must come before any builder_add (it adds the indexed folder).
+static int builder_add_folder(DirIndexBuilder *b, const char *name, uint32_t parent, uint32_t mtime) {
+    uint32_t len = strlen(name);
+    if (len > DIRINDEX_NAME_MAX || b->folder_count >= DIRINDEX_MAX_FOLDERS) return -1;
+
+    if (b->folder_count >= b->folder_capacity) {
+        int new_capacity = b->folder_capacity ? b->folder_capacity * 2 : 16;
+        DirIndexFolder *new_table = (DirIndexFolder*)realloc(b->folder_table, new_capacity * sizeof(DirIndexFolder));
+        if (!new_table) { b->failed = 1; return -1; }
+        b->folder_table = new_table;
+        b->folder_capacity = new_capacity;
+    }
+
+    if (b->folder_names_size + len + 1 > b->folder_names_capacity) {
+        uint32_t new_capacity = b->folder_names_capacity ? b->folder_names_capacity * 2 : 1024;
+        while (new_capacity < b->folder_names_size + len + 1) new_capacity *= 2;
+        char *new_names = (char*)realloc(b->folder_names, new_capacity);
+        if (!new_names) { b->failed = 1; return -1; }
+        b->folder_names = new_names;
+        b->folder_names_capacity = new_capacity;
+    }
+
+    DirIndexFolder *folder = &b->folder_table[b->folder_count];
+    folder->mtime = mtime;
+    folder->parent = parent;
+    folder->name_offset = b->folder_names_size;
+    folder->name_len = len;
+    memcpy(b->folder_names + b->folder_names_size, name, len + 1);
+    b->folder_names_size += len + 1;
+    return b->folder_count++;
+}
+
+static void builder_free(DirIndexBuilder *b) {
+    free(b->names);
+    free(b->name_offsets);
+    free(b->sizes);
+    free(b->is_dir);
+    free(b->folders);
+    free(b->folder_table);
+    free(b->folder_names);
+}
+
+// Classify a folder entry the way the browser lists it: 1 for a folder, 0
+// for a file the filter allows, -1 if hidden (dot files, frogui and save
+// folders, other files)
+static int classify_entry(const char *dir_path, const struct dirent *ent, const ExtensionFilter *filter) {
+    if (ent->d_name[0] == '.') return -1;  // Skip hidden files
+
+    if (strcasecmp(ent->d_name, "frogui") == 0 || strcasecmp(ent->d_name, "saves") == 0 || strcasecmp(ent->d_name, "save") == 0) {
+        return -1;
+    }
+
+    int is_dir = (ent->d_type == DT_DIR);
+    if (ent->d_type == DT_UNKNOWN) {
+        char full_path[512];
+        snprintf(full_path, sizeof(full_path), "%s/%s", dir_path, ent->d_name);
+        struct stat st;
+        if (stat(full_path, &st) != 0) return -1;
+        is_dir = S_ISDIR(st.st_mode);
+    }
+
+    if (!is_dir && !systems_extension_allowed(filter, ent->d_name)) return -1;
+    return is_dir;
+}
+
+// List the folder the same way the browser does: hidden files, frogui and
+// save folders are skipped, files must pass the extension filter
+static void builder_scan(DirIndexBuilder *b, const char *dir_path, const ExtensionFilter *filter) {
+    DIR *dir = opendir(dir_path);
+    if (!dir) {
+        b->failed = 1;
+        return;
+    }
+
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL && !b->failed) {
+        int is_dir = classify_entry(dir_path, ent, filter);
+        if (is_dir < 0) continue;
+        builder_add(b, ent->d_name, is_dir, 0);
+    }
+    closedir(dir);
+}
+
+typedef struct {
+    DirIndexBuilder *builder;
+    const ExtensionFilter *filter;
+    int count;                  // Members allowed (counting only)
+} ArchiveScan;
+
+static void archive_member_found(const char *name, uint32_t size, void *context) {
+    ArchiveScan *scan = (ArchiveScan*)context;
+    if (!systems_extension_allowed(scan->filter, name)) return;
+    builder_add(scan->builder, name, 0, size);
+}
+
+// List a zip archive's members from its central directory
+static void builder_scan_archive(DirIndexBuilder *b, const char *zip_path, const ExtensionFilter *filter) {
+    ArchiveScan scan = { b, filter, 0 };
+    if (zip_list_members(zip_path, archive_member_found, &scan) < 0) {
+        b->failed = 1;
+    }
+}
+
+// Sort the collected entries and write the index file
+static int builder_write(DirIndexBuilder *b, const char *dir_path, uint32_t dir_mtime, const char *index_path) {
+    int count = b->count;
+    CollateItem *items = (CollateItem*)malloc((count ? count : 1) * sizeof(CollateItem));
+    DirIndexRecord *records = (DirIndexRecord*)malloc((count ? count : 1) * sizeof(DirIndexRecord));
+    char *strings = (char*)malloc(b->names_size ? b->names_size : 1);
+    if (!items || !records || !strings) {
+        free(items);
+        free(records);
+        free(strings);
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        items[i].name = b->names + b->name_offsets[i];
+        items[i].key = collate_key(items[i].name);
+        items[i].index = i;
+    }
+    collate_sort(items, count);
+
+    // Records and strings in sorted order, plus the lead byte table
+    uint32_t byte_counts[256];
+    memset(byte_counts, 0, sizeof(byte_counts));
+    uint32_t strings_size = 0;
+    for (int i = 0; i < count; i++) {
+        const char *name = items[i].name;
+        uint32_t len = strlen(name);
+
+        DirIndexRecord *record = &records[i];
+        record->sort_key = collate_key(name);  // collate_sort reused the item keys
+        record->name_offset = strings_size;
+        record->name_len = (uint16_t)len;
+        record->flags = b->is_dir[items[i].index] ? DIRINDEX_FLAG_DIR : 0;
+        record->size = b->sizes[items[i].index];
+        record->folder = b->folder_table ? b->folders[items[i].index] : 0;
+
+        memcpy(strings + strings_size, name, len + 1);
+        strings_size += len + 1;
+        byte_counts[record->sort_key >> 56]++;
+    }
+
+    uint32_t byte_start[257];
+    byte_start[0] = 0;
+    for (int v = 0; v < 256; v++) {
+        byte_start[v + 1] = byte_start[v] + byte_counts[v];
+    }
+
+    DirIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = DIRINDEX_MAGIC;
+    header.version = DIRINDEX_VERSION;
+    header.dir_mtime = dir_mtime;
+    header.entry_count = count;
+    header.strings_size = strings_size;
+    header.path_len = strlen(dir_path);
+    header.folder_count = b->folder_count;
+    header.folder_names_size = b->folder_names_size;
+
+    // Write to a temp file first so a power cut never leaves a torn index
+    char temp_path[520];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", index_path);
+    int ok = 0;
+    FILE *fp = fopen(temp_path, "wb");
+    if (fp) {
+        static const char padding[8] = {0};
+        long path_end = sizeof(header) + sizeof(byte_start) + header.path_len + 1;
+
+        ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+             fwrite(byte_start, sizeof(byte_start), 1, fp) == 1 &&
+             fwrite(dir_path, header.path_len + 1, 1, fp) == 1 &&
+             fwrite(padding, 1, get_records_offset(header.path_len) - path_end, fp) ==
+                 (size_t)(get_records_offset(header.path_len) - path_end) &&
+             fwrite(records, sizeof(DirIndexRecord), count, fp) == (size_t)count &&
+             fwrite(strings, 1, strings_size, fp) == strings_size &&
+             fwrite(b->folder_table, sizeof(DirIndexFolder), b->folder_count, fp) == (size_t)b->folder_count &&
+             fwrite(b->folder_names, 1, b->folder_names_size, fp) == b->folder_names_size;
+        fclose(fp);
+
+        if (ok) {
+            remove(index_path);
+            rename(temp_path, index_path);
+        } else {
+            remove(temp_path);
+        }
+    }
+
+    free(items);
+    free(records);
+    free(strings);
+    return ok;
+}
+
+// Index the folder or archive at scan_path under the name dir_path (the two
+// differ only when a host tool indexes a mounted card)
+static int dirindex_build(const char *scan_path, const char *dir_path, uint32_t dir_mtime, int is_archive,
+                          const ExtensionFilter *filter, const char *index_path) {
+    DirIndexBuilder builder;
+    memset(&builder, 0, sizeof(builder));
+
+    if (is_archive) {
+        builder_scan_archive(&builder, scan_path, filter);
+    } else {
+        builder_scan(&builder, scan_path, filter);
+    }
+    int ok = !builder.failed && builder_write(&builder, dir_path, dir_mtime, index_path);
+    if (ok) {
+        xlog("DirIndex: indexed %d entries in %s\n", builder.count, dir_path);
+    }
+
+    builder_free(&builder);
+    return ok;
+}
+
+// Load the subfolder table stored after the string table
+static int load_folders(FILE *fp, const DirIndexHeader *header, long folders_offset) {
+    index_folders = (DirIndexFolder*)malloc(header->folder_count * sizeof(DirIndexFolder));
+    index_folder_names = (char*)malloc(header->folder_names_size ? header->folder_names_size : 1);
+    if (!index_folders || !index_folder_names ||
+        fseek(fp, folders_offset, SEEK_SET) != 0 ||
+        fread(index_folders, sizeof(DirIndexFolder), header->folder_count, fp) != header->folder_count ||
+        fread(index_folder_names, 1, header->folder_names_size, fp) != header->folder_names_size) {
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < header->folder_count; i++) {
+        const DirIndexFolder *folder = &index_folders[i];
+        if (folder->name_offset + folder->name_len >= header->folder_names_size ||
+            index_folder_names[folder->name_offset + folder->name_len] != '\0' ||
+            folder->parent >= header->folder_count) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Open an existing index file, 1 if it belongs to the folder and matches
+// dir_mtime (any stored mtime when dir_mtime is NULL)
+static int attach_index(const char *dir_path, const uint32_t *dir_mtime, const char *index_path) {
+    FILE *fp = fopen(index_path, "rb");
+    if (!fp) return 0;
+
+    char stored_path[512];
+    DirIndexHeader header;
+    if (fread(&header, sizeof(header), 1, fp) != 1 ||
+        header.magic != DIRINDEX_MAGIC ||
+        header.version != DIRINDEX_VERSION ||
+        (dir_mtime && header.dir_mtime != *dir_mtime) ||
+        header.folder_count > DIRINDEX_MAX_FOLDERS ||
+        header.path_len != strlen(dir_path) ||
+        header.path_len >= sizeof(stored_path) ||
+        fread(index_byte_start, sizeof(index_byte_start), 1, fp) != 1 ||
+        fread(stored_path, header.path_len + 1, 1, fp) != 1 ||
+        memcmp(stored_path, dir_path, header.path_len) != 0 ||
+        index_byte_start[256] != header.entry_count) {
+        fclose(fp);
+        return 0;
+    }
+
+    index_fp = fp;
+    index_header = header;
+    index_records_offset = get_records_offset(header.path_len);
+    index_strings_offset = index_records_offset + (long)header.entry_count * sizeof(DirIndexRecord);
+    index_journal_end = index_strings_offset + header.strings_size +
+                        header.folder_count * sizeof(DirIndexFolder) + header.folder_names_size;
+    strncpy(index_dir_path, dir_path, sizeof(index_dir_path) - 1);
+    index_dir_path[sizeof(index_dir_path) - 1] = '\0';
+    strncpy(index_file_path, index_path, sizeof(index_file_path) - 1);
+    index_file_path[sizeof(index_file_path) - 1] = '\0';
+
+    if ((header.folder_count > 0 &&
+         !load_folders(fp, &header, index_strings_offset + header.strings_size)) ||
+        !replay_journal()) {
+        dirindex_close();
+        return 0;
+    }
+    return 1;
+}
+
+static int dirindex_attach(const char *dir_path, uint32_t dir_mtime, const char *index_path) {
+    return attach_index(dir_path, &dir_mtime, index_path);
+}
+
+int dirindex_open(const char *dir_path, const ExtensionFilter *filter) {
+    dirindex_close();
+
+    struct stat st;
+    if (stat(dir_path, &st) != 0) return 0;
+    uint32_t dir_mtime = (uint32_t)st.st_mtime;
+
+    char index_path[512];
+    get_index_path(dir_path, index_path, sizeof(index_path));
+
+    if (dirindex_attach(dir_path, dir_mtime, index_path)) {
+        return 1;
+    }
+
+    // Missing or stale - rebuild from the folder
+    if (!dirindex_build(dir_path, dir_path, dir_mtime, S_ISREG(st.st_mode), filter, index_path)) {
+        return 0;
+    }
+    return dirindex_attach(dir_path, dir_mtime, index_path);
+}
+
+int dirindex_cached_count(const char *dir_path) {
+    struct stat st;
+    if (stat(dir_path, &st) != 0) return -1;
+
+    char index_path[512];
+    get_index_path(dir_path, index_path, sizeof(index_path));
+    FILE *fp = fopen(index_path, "rb");
+    if (!fp) return -1;
+
+    // Same checks as attach_index, without keeping the file open
+    char stored_path[512];
+    DirIndexHeader header;
+    int current = fread(&header, sizeof(header), 1, fp) == 1 &&
+                  header.magic == DIRINDEX_MAGIC &&
+                  header.version == DIRINDEX_VERSION &&
+                  header.dir_mtime == (uint32_t)st.st_mtime &&
+                  header.journal_count == 0 &&
+                  header.path_len == strlen(dir_path) &&
+                  header.path_len < sizeof(stored_path) &&
+                  fseek(fp, sizeof(header) + sizeof(index_byte_start), SEEK_SET) == 0 &&
+                  fread(stored_path, header.path_len + 1, 1, fp) == 1 &&
+                  memcmp(stored_path, dir_path, header.path_len) == 0;
+    fclose(fp);
+    return current ? (int)header.entry_count : -1;
+}
+
+static void archive_member_counted(const char *name, uint32_t size, void *context) {
+    (void)size;
+    ArchiveScan *scan = (ArchiveScan*)context;
+    if (systems_extension_allowed(scan->filter, name)) scan->count++;
+}
+
+int dirindex_archive_count(const char *zip_path, const ExtensionFilter *filter) {
+    int count = dirindex_cached_count(zip_path);
+    if (count >= 0) return count;
+
+    ArchiveScan scan = { NULL, filter, 0 };
+    return zip_list_members(zip_path, archive_member_counted, &scan) < 0 ? -1 : scan.count;
+}
+
+// Tree builds walk the folders breadth first, with the builder's folder table
+// as the queue. A subfolder whose mtime matches the previous tree index is not
+// read again: its subfolders come from the old table and its files are copied
+// from the old records once the walk is done.
+typedef struct {
+    int active;
+    DirIndexBuilder builder;
+    ExtensionFilter filter;
+    char scan_path[512];        // Where the folders are read (dir_path on the device)
+    char dir_path[512];
+    char index_path[512];
+    DIR *dir;                   // Folder being read
+    char folder_path[1024];     // Its full path
+    int next_folder;            // Next folder of the table to visit
+    uint32_t old_count;         // Folders of the previous index (still open), 0 if none
+    uint32_t *old_to_new;       // Per previous folder: its new number + 1 if reused
+    int reused;                 // Any records to copy
+    int next_record;            // Next previous record to copy
+} TreeBuild;
+
+// Copying a batch of old records costs this much of the step budget
+#define TREE_COPY_COST 8
+
+static TreeBuild tree_build;
+
+static void tree_build_free(void) {
+    if (!tree_build.active) return;
+    if (tree_build.dir) closedir(tree_build.dir);
+    builder_free(&tree_build.builder);
+    free(tree_build.old_to_new);
+    memset(&tree_build, 0, sizeof(tree_build));
+}
+
+// 1 if no folder of the open tree index changed since it was written
+static int tree_is_current(void) {
+    for (uint32_t i = 0; i < index_header.folder_count; i++) {
+        const char *name = index_folder_names + index_folders[i].name_offset;
+        char path[1024];
+        snprintf(path, sizeof(path), name[0] ? "%s/%s" : "%s", index_dir_path, name);
+        struct stat st;
+        if (stat(path, &st) != 0 || (uint32_t)st.st_mtime != index_folders[i].mtime) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Queue a subfolder (path relative to the indexed folder) if it is still there
+static void tree_queue_folder(const char *name, uint32_t parent) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", tree_build.scan_path, name);
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) return;
+    builder_add_folder(&tree_build.builder, name, parent, (uint32_t)st.st_mtime);
+}
+
+// Folder of the previous index with this name and mtime, -1 if none
+static int find_old_folder(const char *name, uint32_t mtime) {
+    for (uint32_t i = 0; i < tree_build.old_count; i++) {
+        if (index_folders[i].mtime == mtime &&
+            strcmp(index_folder_names + index_folders[i].name_offset, name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Take the next queued folder: reuse it from the previous index, or open it
+// for reading
+static void tree_visit_folder(void) {
+    DirIndexBuilder *b = &tree_build.builder;
+    int folder = tree_build.next_folder++;
+
+    // Queueing below may move the folder table
+    char name[DIRINDEX_NAME_MAX + 1];
+    strcpy(name, b->folder_names + b->folder_table[folder].name_offset);
+
+    int old = find_old_folder(name, b->folder_table[folder].mtime);
+    if (old >= 0) {
+        tree_build.old_to_new[old] = folder + 1;
+        tree_build.reused = 1;
+        for (uint32_t i = 1; i < tree_build.old_count; i++) {
+            if (index_folders[i].parent == (uint32_t)old) {
+                tree_queue_folder(index_folder_names + index_folders[i].name_offset, folder);
+            }
+        }
+        return;
+    }
+
+    snprintf(tree_build.folder_path, sizeof(tree_build.folder_path), name[0] ? "%s/%s" : "%s",
+             tree_build.scan_path, name);
+    tree_build.dir = opendir(tree_build.folder_path);
+    if (!tree_build.dir && folder == 0) b->failed = 1;  // A vanished subfolder is just skipped
+    b->folder = folder;
+}
+
+// Add one entry of the folder being read
+static void tree_read_entry(const struct dirent *ent) {
+    DirIndexBuilder *b = &tree_build.builder;
+    int is_dir = classify_entry(tree_build.folder_path, ent, &tree_build.filter);
+    if (is_dir < 0) return;
+    if (!is_dir) {
+        builder_add(b, ent->d_name, 0, 0);
+        return;
+    }
+
+    const char *parent = b->folder_names + b->folder_table[b->folder].name_offset;
+    char name[DIRINDEX_NAME_MAX + 1];
+    if (strlen(parent) + strlen(ent->d_name) + 1 > DIRINDEX_NAME_MAX) return;
+    snprintf(name, sizeof(name), parent[0] ? "%s/%s" : "%s%s", parent, ent->d_name);
+    tree_queue_folder(name, b->folder);
+}
+
+// Copy one batch of previous records that belong to reused folders
+static void tree_copy_records(void) {
+    DirIndexBuilder *b = &tree_build.builder;
+    DirIndexItem items[DIRINDEX_MAX_READ];
+    int decoded = read_records_at(tree_build.next_record, DIRINDEX_MAX_READ, items);
+    if (decoded <= 0) {
+        b->failed = 1;
+        return;
+    }
+
+    for (int i = 0; i < decoded; i++) {
+        uint32_t old = read_records[i].folder;
+        if (old < tree_build.old_count && tree_build.old_to_new[old]) {
+            b->folder = tree_build.old_to_new[old] - 1;
+            builder_add(b, items[i].name, 0, items[i].size);
+        }
+    }
+    tree_build.next_record += decoded;
+}
+
+// Write the collected tree and open it in place of the previous index
+static int tree_finish(void) {
+    DirIndexBuilder builder = tree_build.builder;
+    char dir_path[512];
+    char index_path[512];
+    strcpy(dir_path, tree_build.dir_path);
+    strcpy(index_path, tree_build.index_path);
+    uint32_t dir_mtime = builder.folder_table[0].mtime;
+
+    // The builder now belongs to this function
+    memset(&tree_build.builder, 0, sizeof(tree_build.builder));
+    dirindex_close();
+
+    int ok = builder_write(&builder, dir_path, dir_mtime, index_path);
+    if (ok) {
+        xlog("DirIndex: indexed %d files in %d folders under %s\n",
+             builder.count, builder.folder_count, dir_path);
+    }
+    builder_free(&builder);
+    return ok && dirindex_attach(dir_path, dir_mtime, index_path);
+}
+
+// Start a tree build, reusing the open index (if any) as the previous one
+static int tree_begin(const char *scan_path, const char *dir_path, uint32_t dir_mtime,
+                      const ExtensionFilter *filter, const char *index_path) {
+    tree_build.active = 1;
+    tree_build.filter = *filter;
+    strncpy(tree_build.scan_path, scan_path, sizeof(tree_build.scan_path) - 1);
+    strncpy(tree_build.dir_path, dir_path, sizeof(tree_build.dir_path) - 1);
+    strncpy(tree_build.index_path, index_path, sizeof(tree_build.index_path) - 1);
+    tree_build.old_count = index_fp ? index_header.folder_count : 0;
+    tree_build.old_to_new = (uint32_t*)calloc(tree_build.old_count ? tree_build.old_count : 1, sizeof(uint32_t));
+    if (!tree_build.old_to_new ||
+        builder_add_folder(&tree_build.builder, "", 0, dir_mtime) != 0) {
+        dirindex_close();
+        return 0;
+    }
+    return 1;
+}
+
+int dirindex_open_tree(const char *dir_path, const ExtensionFilter *filter) {
+    dirindex_close();
+
+    struct stat st;
+    if (stat(dir_path, &st) != 0 || !S_ISDIR(st.st_mode)) return -1;
+
+    char index_path[512];
+    snprintf(index_path, sizeof(index_path), DIRINDEX_TREE_PATTERN, (unsigned)hash_string(dir_path));
+
+    // Keep the previous index open: it is either current, or the source of
+    // every folder that did not change
+    if (attach_index(dir_path, NULL, index_path)) {
+        if (index_header.folder_count == 0) {
+            dirindex_close();
+        } else if (tree_is_current()) {
+            return 1;
+        }
+    }
+
+    return tree_begin(dir_path, dir_path, (uint32_t)st.st_mtime, filter, index_path) ? 0 : -1;
+}
+
+int dirindex_build_step(int budget) {
+    if (!tree_build.active) return index_fp ? 1 : -1;
+
+    DirIndexBuilder *b = &tree_build.builder;
+    while (budget > 0 && !b->failed) {
+        if (tree_build.dir) {
+            struct dirent *ent = readdir(tree_build.dir);
+            if (ent) {
+                tree_read_entry(ent);
+            } else {
+                closedir(tree_build.dir);
+                tree_build.dir = NULL;
+            }
+            budget--;
+        } else if (tree_build.next_folder < b->folder_count) {
+            tree_visit_folder();
+            budget--;
+        } else if (tree_build.reused && tree_build.next_record < (int)index_header.entry_count) {
+            tree_copy_records();
+            budget -= TREE_COPY_COST;
+        } else {
+            return tree_finish() ? 1 : -1;
+        }
+    }
+
+    if (b->failed) {
+        dirindex_close();
+        return -1;
+    }
+    return 0;
+}
+
+int dirindex_build_progress(void) {
+    return tree_build.active ? tree_build.builder.count : 0;
+}
+
+int dirindex_write(const char *scan_path, const char *dir_path,
+                   const ExtensionFilter *filter, const char *index_path) {
+    struct stat st;
+    if (stat(scan_path, &st) != 0) return 0;
+    return dirindex_build(scan_path, dir_path, (uint32_t)st.st_mtime, S_ISREG(st.st_mode), filter, index_path);
+}
+
+int dirindex_write_tree(const char *scan_path, const char *dir_path,
+                        const ExtensionFilter *filter, const char *index_path) {
+    dirindex_close();
+
+    struct stat st;
+    if (stat(scan_path, &st) != 0 || !S_ISDIR(st.st_mode) ||
+        !tree_begin(scan_path, dir_path, (uint32_t)st.st_mtime, filter, index_path)) {
+        return 0;
+    }
+
+    int result;
+    while ((result = dirindex_build_step(1 << 30)) == 0) {
+    }
+    dirindex_close();
+    return result > 0;
+}
+
+void dirindex_close(void) {
+    tree_build_free();
+    if (index_fp) {
+        fclose(index_fp);
+        index_fp = NULL;
+    }
+    free(index_folders);
+    free(index_folder_names);
+    index_folders = NULL;
+    index_folder_names = NULL;
+    memset(&index_header, 0, sizeof(index_header));
+    overlay_removed_count = 0;
+    overlay_inserted_count = 0;
+}
+
+int dirindex_count(void) {
+    if (!index_fp) return 0;
+    return (int)index_header.entry_count - overlay_removed_count + overlay_inserted_count;
+}
+
+// Decode file records [first, first + count), ignoring the overlay
+static int read_records_at(int first, int count, DirIndexItem *items) {
+    if (!index_fp || first < 0 || first >= (int)index_header.entry_count || count <= 0) {
+        return 0;
+    }
+    if (count > DIRINDEX_MAX_READ) count = DIRINDEX_MAX_READ;
+    if (first + count > (int)index_header.entry_count) count = index_header.entry_count - first;
+
+    // One read for the records, one for their names (stored in the same order)
+    if (fseek(index_fp, index_records_offset + (long)first * sizeof(DirIndexRecord), SEEK_SET) != 0 ||
+        fread(read_records, sizeof(DirIndexRecord), count, index_fp) != (size_t)count) {
+        return 0;
+    }
+
+    uint32_t names_start = read_records[0].name_offset;
+    uint32_t names_end = read_records[count - 1].name_offset + read_records[count - 1].name_len + 1;
+    if (names_end < names_start || names_end - names_start > sizeof(read_names) ||
+        names_end > index_header.strings_size) {
+        return 0;
+    }
+
+    if (fseek(index_fp, index_strings_offset + names_start, SEEK_SET) != 0 ||
+        fread(read_names, 1, names_end - names_start, index_fp) != names_end - names_start) {
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        uint32_t offset = read_records[i].name_offset - names_start;
+        read_names[offset + read_records[i].name_len] = '\0';
+
+        items[i].sort_key = read_records[i].sort_key;
+        items[i].is_dir = (read_records[i].flags & DIRINDEX_FLAG_DIR) != 0;
+        items[i].size = read_records[i].size;
+        items[i].name = read_names + offset;
+        items[i].folder = "";
+        if (index_folders && read_records[i].folder < index_header.folder_count) {
+            items[i].folder = index_folder_names + index_folders[read_records[i].folder].name_offset;
+        }
+    }
+    return count;
+}
+
+// Removed file records before record number pos
+static int removed_before(uint32_t pos) {
+    int n = 0;
+    while (n < overlay_removed_count && overlay_removed[n] < pos) n++;
+    return n;
+}
+
+// List position of added entry i
+static int inserted_position(int i) {
+    uint32_t pos = overlay_inserted[i].record_pos;
+    return pos - removed_before(pos) + i;
+}
+
+// Record number of the n-th file record still listed
+static uint32_t kept_record(int n) {
+    uint32_t pos = n;
+    for (int i = 0; i < overlay_removed_count && overlay_removed[i] <= pos; i++) {
+        pos++;
+    }
+    return pos;
+}
+
+// Walk file records and added entries in list order from position first
+static int read_merged(int first, int count, DirIndexItem *items) {
+    int total = dirindex_count();
+    if (first < 0 || first >= total || count <= 0) return 0;
+    if (count > DIRINDEX_MAX_READ) count = DIRINDEX_MAX_READ;
+    if (first + count > total) count = total - first;
+
+    int next_insert = 0;
+    while (next_insert < overlay_inserted_count && inserted_position(next_insert) < first) {
+        next_insert++;
+    }
+    uint32_t pos = kept_record(first - next_insert);
+    int next_removed = removed_before(pos);
+
+    DirIndexItem batch[DIRINDEX_MAX_READ];
+    uint32_t batch_first = 0;
+    int batch_count = 0;
+    size_t names_used = 0;
+    int produced = 0;
+
+    while (produced < count) {
+        DirIndexItem item;
+        if (next_insert < overlay_inserted_count && overlay_inserted[next_insert].record_pos <= pos) {
+            const DirIndexInsert *insert = &overlay_inserted[next_insert++];
+            item.sort_key = insert->sort_key;
+            item.is_dir = insert->is_dir;
+            item.size = insert->size;
+            item.name = insert->name;
+            item.folder = "";
+        } else if (next_removed < overlay_removed_count && overlay_removed[next_removed] == pos) {
+            next_removed++;
+            pos++;
+            continue;
+        } else {
+            if (pos < batch_first || pos >= batch_first + batch_count) {
+                batch_first = pos;
+                batch_count = read_records_at(pos, DIRINDEX_MAX_READ, batch);
+                if (batch_count <= 0) break;
+            }
+            item = batch[pos - batch_first];
+            pos++;
+        }
+
+        size_t len = strlen(item.name);
+        memcpy(merged_names + names_used, item.name, len + 1);
+        item.name = merged_names + names_used;
+        names_used += len + 1;
+        items[produced++] = item;
+    }
+    return produced;
+}
+
+int dirindex_read(int first, int count, DirIndexItem *items) {
+    if (overlay_removed_count == 0 && overlay_inserted_count == 0) {
+        return read_records_at(first, count, items);
+    }
+    return read_merged(first, count, items);
+}
+
+void dirindex_get_byte_range(uint8_t lead_byte, int *first, int *count) {
+    if (!index_fp) {
+        *first = 0;
+        *count = 0;
+        return;
+    }
+
+    uint32_t start = index_byte_start[lead_byte];
+    uint32_t end = index_byte_start[lead_byte + 1];
+    *first = start - removed_before(start);
+    *count = (end - start) - (removed_before(end) - removed_before(start));
+
+    // Added entries are in collation order, so by lead byte too
+    for (int i = 0; i < overlay_inserted_count; i++) {
+        uint8_t lead = (uint8_t)(overlay_inserted[i].sort_key >> 56);
+        if (lead < lead_byte) (*first)++;
+        else if (lead == lead_byte) (*count)++;
+    }
+}
+
+// First position in [lo, hi) not ordered before name, reading through reader
+static int lower_bound_in(const char *name, uint64_t key, int lo, int hi,
+                          int (*reader)(int, int, DirIndexItem*)) {
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        DirIndexItem item;
+        if (reader(mid, 1, &item) != 1) return -1;
+
+        if (item.sort_key < key ||
+            (item.sort_key == key && collate_compare(item.name, name) < 0)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// First listed entry not ordered before name, searching only its lead byte range
+static int dirindex_lower_bound(const char *name) {
+    uint64_t key = collate_key(name);
+    int first, count;
+    dirindex_get_byte_range((uint8_t)(key >> 56), &first, &count);
+    return lower_bound_in(name, key, first, first + count, dirindex_read);
+}
+
+// Overlay updates (no file writes)
+
+static int overlay_insert(const char *name, int is_dir, uint32_t size) {
+    size_t len = strlen(name);
+    if (len == 0 || len > DIRINDEX_NAME_MAX || overlay_inserted_count >= DIRINDEX_MAX_JOURNAL) return -1;
+    if (dirindex_find_name(name) >= 0) return -1;
+
+    uint64_t key = collate_key(name);
+    int record_pos = lower_bound_in(name, key, index_byte_start[key >> 56],
+                                    index_byte_start[(key >> 56) + 1], read_records_at);
+    if (record_pos < 0) return -1;
+
+    int i = overlay_inserted_count;
+    while (i > 0 && (overlay_inserted[i - 1].sort_key > key ||
+                     (overlay_inserted[i - 1].sort_key == key &&
+                      collate_compare(overlay_inserted[i - 1].name, name) > 0))) {
+        overlay_inserted[i] = overlay_inserted[i - 1];
+        i--;
+    }
+
+    DirIndexInsert *insert = &overlay_inserted[i];
+    insert->sort_key = key;
+    insert->record_pos = record_pos;
+    insert->size = size;
+    insert->is_dir = is_dir;
+    memcpy(insert->name, name, len + 1);
+    overlay_inserted_count++;
+    return inserted_position(i);
+}
+
+static int overlay_remove(const char *name, int *is_dir, uint32_t *size) {
+    int index = dirindex_find_name(name);
+    if (index < 0) return -1;
+
+    int i = 0;
+    while (i < overlay_inserted_count && inserted_position(i) < index) i++;
+    if (i < overlay_inserted_count && inserted_position(i) == index) {
+        *is_dir = overlay_inserted[i].is_dir;
+        *size = overlay_inserted[i].size;
+        overlay_inserted_count--;
+        memmove(&overlay_inserted[i], &overlay_inserted[i + 1],
+                (overlay_inserted_count - i) * sizeof(DirIndexInsert));
+        return index;
+    }
+
+    if (overlay_removed_count >= DIRINDEX_MAX_JOURNAL) return -1;
+
+    DirIndexItem item;
+    uint32_t pos = kept_record(index - i);
+    if (read_records_at(pos, 1, &item) != 1) return -1;
+    *is_dir = item.is_dir;
+    *size = item.size;
+
+    int r = removed_before(pos);
+    memmove(&overlay_removed[r + 1], &overlay_removed[r], (overlay_removed_count - r) * sizeof(uint32_t));
+    overlay_removed[r] = pos;
+    overlay_removed_count++;
+    return index;
+}
+
+// Apply the journal stored after the string table
+static int replay_journal(void) {
+    if (index_header.journal_count == 0) return 1;
+    if (fseek(index_fp, index_journal_end, SEEK_SET) != 0) return 0;
+
+    for (int i = 0; i < index_header.journal_count; i++) {
+        DirIndexJournalRecord record;
+        char name[DIRINDEX_NAME_MAX + 1];
+        if (fread(&record, sizeof(record), 1, index_fp) != 1 ||
+            record.name_len == 0 || record.name_len > DIRINDEX_NAME_MAX ||
+            fread(name, 1, record.name_len, index_fp) != record.name_len) {
+            return 0;
+        }
+        name[record.name_len] = '\0';
+        index_journal_end += sizeof(record) + record.name_len;
+
+        // Lookups below move the read position, so come back for the next record
+        int is_dir;
+        uint32_t size;
+        if (record.op == DIRINDEX_JOURNAL_INSERT) {
+            overlay_insert(name, record.is_dir, record.size);
+        } else if (record.op == DIRINDEX_JOURNAL_REMOVE) {
+            overlay_remove(name, &is_dir, &size);
+        }
+        if (fseek(index_fp, index_journal_end, SEEK_SET) != 0) return 0;
+    }
+    return 1;
+}
+
+// Write the merged listing as a fresh index with an empty journal
+static int compact_index(uint32_t dir_mtime) {
+    DirIndexBuilder builder;
+    memset(&builder, 0, sizeof(builder));
+
+    int total = dirindex_count();
+    DirIndexItem items[DIRINDEX_MAX_READ];
+    for (int i = 0; i < total && !builder.failed; ) {
+        int decoded = dirindex_read(i, DIRINDEX_MAX_READ, items);
+        if (decoded <= 0) {
+            builder.failed = 1;
+            break;
+        }
+        for (int j = 0; j < decoded; j++) {
+            builder_add(&builder, items[j].name, items[j].is_dir, items[j].size);
+        }
+        i += decoded;
+    }
+
+    char dir_path[512];
+    char index_path[512];
+    strcpy(dir_path, index_dir_path);
+    strcpy(index_path, index_file_path);
+
+    int ok = !builder.failed && builder_write(&builder, dir_path, dir_mtime, index_path);
+    builder_free(&builder);
+
+    dirindex_close();
+    return ok && dirindex_attach(dir_path, dir_mtime, index_path);
+}
+
+// Make room for records more journal records, compacting if the journal is full
+static int reserve_journal(int records) {
+    if (index_header.journal_count + records <= DIRINDEX_MAX_JOURNAL) return 1;
+    return compact_index(index_header.dir_mtime);
+}
+
+// Append one journal record and store the folder's new mtime in the header
+static int append_journal(int op, const char *name, int is_dir, uint32_t size) {
+    struct stat st;
+    uint32_t dir_mtime = stat(index_dir_path, &st) == 0 ? (uint32_t)st.st_mtime : 0;
+
+    DirIndexJournalRecord record;
+    record.op = (uint8_t)op;
+    record.is_dir = (uint8_t)is_dir;
+    record.name_len = (uint16_t)strlen(name);
+    record.size = size;
+
+    FILE *fp = fopen(index_file_path, "r+b");
+    if (!fp) return 0;
+
+    DirIndexHeader header = index_header;
+    header.journal_count++;
+    header.dir_mtime = dir_mtime;
+
+    int ok = fseek(fp, index_journal_end, SEEK_SET) == 0 &&
+             fwrite(&record, sizeof(record), 1, fp) == 1 &&
+             fwrite(name, 1, record.name_len, fp) == record.name_len &&
+             fseek(fp, 0, SEEK_SET) == 0 &&
+             fwrite(&header, sizeof(header), 1, fp) == 1;
+    fclose(fp);
+
+    if (ok) {
+        index_header = header;
+        index_journal_end += sizeof(record) + record.name_len;
+    }
+    return ok;
+}
+
+// Archives and tree indexes are never edited in place
+static int is_read_only_index(void) {
+    struct stat st;
+    return index_header.folder_count > 0 || stat(index_dir_path, &st) != 0 || !S_ISDIR(st.st_mode);
+}
+
+int dirindex_insert(const char *name, int is_dir, uint32_t size) {
+    if (!index_fp || is_read_only_index() || !reserve_journal(1)) return -1;
+
+    int index = overlay_insert(name, is_dir, size);
+    if (index < 0) return -1;
+    if (!append_journal(DIRINDEX_JOURNAL_INSERT, name, is_dir, size)) return -1;
+    return index;
+}
+
+int dirindex_remove(const char *name) {
+    if (!index_fp || is_read_only_index() || !reserve_journal(1)) return -1;
+
+    int is_dir;
+    uint32_t size;
+    int index = overlay_remove(name, &is_dir, &size);
+    if (index < 0) return -1;
+    if (!append_journal(DIRINDEX_JOURNAL_REMOVE, name, is_dir, size)) return -1;
+    return index;
+}
+
+int dirindex_rename(const char *old_name, const char *new_name) {
+    if (!index_fp || is_read_only_index() || dirindex_find_name(new_name) >= 0 ||
+        !reserve_journal(2)) {
+        return -1;
+    }
+
+    int is_dir;
+    uint32_t size;
+    if (overlay_remove(old_name, &is_dir, &size) < 0) return -1;
+    if (!append_journal(DIRINDEX_JOURNAL_REMOVE, old_name, is_dir, size)) return -1;
+
+    int index = overlay_insert(new_name, is_dir, size);
+    if (index < 0) return -1;
+    if (!append_journal(DIRINDEX_JOURNAL_INSERT, new_name, is_dir, size)) return -1;
+    return index;
+}
+
+int dirindex_find_prefix(const char *prefix) {
+    if (dirindex_count() == 0) return -1;
+    if (!prefix[0]) return 0;
+
+    int index = dirindex_lower_bound(prefix);
+    if (index < 0 || index >= dirindex_count()) return -1;
+
+    DirIndexItem item;
+    if (dirindex_read(index, 1, &item) != 1) return -1;
+    return strncasecmp(item.name, prefix, strlen(prefix)) == 0 ? index : -1;
+}
+
+int dirindex_find_name(const char *name) {
+    if (dirindex_count() == 0) return -1;
+
+    int index = dirindex_lower_bound(name);
+    if (index < 0 || index >= dirindex_count()) return -1;
+
+    DirIndexItem item;
+    if (dirindex_read(index, 1, &item) != 1) return -1;
+    return strcmp(item.name, name) == 0 ? index : -1;
+}
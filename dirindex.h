@@ -0,0 +1,166 @@
+#ifndef DIRINDEX_H
+#define DIRINDEX_H
+
+#include <stdint.h>
+#include "systems.h"
+
+// On-disk directory index: one sorted listing per ROM folder, so a folder of
+// any size is browsed by reading only the records on screen. A .zip archive
+// is indexed the same way from its central directory. A tree index lists
+// every file under a folder and its subfolders, for flattened system views.
+//
+// File layout (native little-endian):
+//   DirIndexHeader
+//   uint32_t byte_start[257]             first record per leading sort byte
+//   char path[path_len + 1]              folder the index belongs to
+//   (padding to 8 bytes)
+//   DirIndexRecord[entry_count]          sorted by collation
+//   char strings[strings_size]           names in record order
+//   DirIndexFolder[folder_count]         subfolders (tree indexes only)
+//   char folder_names[folder_names_size]
+//   journal_count x (DirIndexJournalRecord + name)   changes made in place
+//
+// Files added, removed or renamed from the menu are not rescanned: the change
+// goes into an in-memory overlay merged into the sorted listing, and one
+// journal record is appended to the file. The journal is replayed on open and
+// folded into a rewritten index once it reaches DIRINDEX_MAX_JOURNAL records.
+//
+// A tree index keeps each subfolder's mtime, so a change in one subfolder
+// rescans only that subfolder; the records of the others are copied over.
+// Tree indexes are built a slice at a time (dirindex_build_step) and take no
+// journal.
+#define DIRINDEX_CACHE_PATTERN "/mnt/sda1/configs/frogui_dir_%08x.idx"
+#define DIRINDEX_TREE_PATTERN "/mnt/sda1/configs/frogui_tree_%08x.idx"
+#define DIRINDEX_MAGIC 0x58444946  // "FIDX"
+#define DIRINDEX_VERSION 3
+
+// Most records returned by one dirindex_read call
+#define DIRINDEX_MAX_READ 64
+
+// Journal records kept before the index is rewritten
+#define DIRINDEX_MAX_JOURNAL 32
+
+// Most subfolders (the folder itself included) in a tree index
+#define DIRINDEX_MAX_FOLDERS 1024
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t journal_count; // Journal records after the string table
+    uint32_t dir_mtime;     // Folder (or archive) mtime the index matches
+    uint32_t entry_count;
+    uint32_t strings_size;
+    uint32_t path_len;
+    uint32_t folder_count;      // 0 for a plain folder or archive index
+    uint32_t folder_names_size;
+} DirIndexHeader;
+
+#define DIRINDEX_FLAG_DIR 0x0001
+
+typedef struct {
+    uint64_t sort_key;      // collate_key() of the name
+    uint32_t name_offset;   // Name in the string table
+    uint16_t name_len;
+    uint16_t flags;
+    uint32_t size;          // Uncompressed size for archive members, 0 for folder entries
+    uint32_t folder;        // Subfolder holding the file (tree indexes), 0 otherwise
+} DirIndexRecord;
+
+// Folder 0 is the indexed folder itself, with an empty name
+typedef struct {
+    uint32_t mtime;         // Subfolder mtime its records match
+    uint32_t parent;        // Folder number of the parent folder
+    uint32_t name_offset;   // Path relative to the indexed folder, in folder_names
+    uint32_t name_len;
+} DirIndexFolder;
+
+#define DIRINDEX_JOURNAL_INSERT 1
+#define DIRINDEX_JOURNAL_REMOVE 2
+
+// Followed by name_len bytes of name (no NUL)
+typedef struct {
+    uint8_t op;
+    uint8_t is_dir;
+    uint16_t name_len;
+    uint32_t size;
+} DirIndexJournalRecord;
+
+// Decoded record. name stays valid until the next dirindex call.
+typedef struct {
+    uint64_t sort_key;
+    int is_dir;
+    uint32_t size;
+    const char *name;
+    const char *folder;     // Subfolder relative to the indexed folder, "" if none
+} DirIndexItem;
+
+// Open the index for a folder or .zip archive, building it first if missing
+// or stale. filter limits which files are listed. Returns 1 on success.
+int dirindex_open(const char *dir_path, const ExtensionFilter *filter);
+
+// Entry count of the cached index of a folder or archive, from its header
+// alone (nothing is built or opened). -1 if there is none, it is stale, or it
+// has journal records to replay.
+int dirindex_cached_count(const char *dir_path);
+
+// Members of a zip archive the filter allows, the count its index lists: from
+// the cached index when it is current, otherwise counted from the central
+// directory. -1 if the archive cannot be read.
+int dirindex_archive_count(const char *zip_path, const ExtensionFilter *filter);
+
+// Open the tree index of a folder: every file the filter allows in it and
+// its subfolders, without folder entries. Returns 1 when the cached index is
+// current and open, 0 when a build was started (call dirindex_build_step until
+// it finishes), -1 on failure.
+int dirindex_open_tree(const char *dir_path, const ExtensionFilter *filter);
+
+// Run the tree build for about budget folder entries. Returns 0 while work
+// remains, 1 once the index is written and open, -1 if the build failed.
+int dirindex_build_step(int budget);
+
+// Files found so far by the tree build
+int dirindex_build_progress(void);
+
+// Write the index of a folder or archive without opening it; safe to call for
+// several folders at once. The folder is read at scan_path but the index is
+// made for dir_path, so a host tool can index a mounted card under the paths
+// the device sees. Returns 1 on success.
+int dirindex_write(const char *scan_path, const char *dir_path,
+                   const ExtensionFilter *filter, const char *index_path);
+
+// Same for a tree index, built in one go (uses the open index state, so one
+// at a time)
+int dirindex_write_tree(const char *scan_path, const char *dir_path,
+                        const ExtensionFilter *filter, const char *index_path);
+
+// Close the open index (and drop a tree build in progress)
+void dirindex_close(void);
+
+// Number of entries in the open index (0 if none)
+int dirindex_count(void);
+
+// Decode up to count records starting at first, returns the number decoded
+int dirindex_read(int first, int count, DirIndexItem *items);
+
+// Records whose sort string starts with the given byte: [*first, *first + *count)
+void dirindex_get_byte_range(uint8_t lead_byte, int *first, int *count);
+
+// First entry whose name starts with prefix (case-insensitive), -1 if none.
+// Numbers sort by value, so a prefix ending in digits only finds names whose
+// number has the same length ("Mega Man 1" finds "Mega Man 1", not "10").
+int dirindex_find_prefix(const char *prefix);
+
+// Entry with exactly this name, -1 if none
+int dirindex_find_name(const char *name);
+
+// Record a file operation already done in the open folder (not archives or
+// tree indexes).
+// Each is O(log n) record reads plus a small append to the index file, which
+// also takes the folder's new mtime so the next open does not rescan.
+// Insert and rename return the entry's new position, remove its old one;
+// -1 if the index is not open or the name is missing (or already present).
+int dirindex_insert(const char *name, int is_dir, uint32_t size);
+int dirindex_remove(const char *name);
+int dirindex_rename(const char *old_name, const char *new_name);
+
+#endif // DIRINDEX_H
@@ -31,16 +31,19 @@ void favorites_load(void) {
         char *separator1 = strchr(line, '|');
         if (separator1) {
             *separator1 = '\0';
+            SystemId system = systems_intern(line);
+            if (system == SYSTEM_ID_NONE) continue;
+
             char *separator2 = strchr(separator1 + 1, '|');
             if (separator2) {
                 *separator2 = '\0';
-                strncpy(favorites[favorite_count].core_name, line, sizeof(favorites[favorite_count].core_name) - 1);
+                favorites[favorite_count].system = system;
                 strncpy(favorites[favorite_count].game_name, separator1 + 1, sizeof(favorites[favorite_count].game_name) - 1);
                 strncpy(favorites[favorite_count].full_path, separator2 + 1, sizeof(favorites[favorite_count].full_path) - 1);
 
                 // Create display name
                 snprintf(favorites[favorite_count].display_name, sizeof(favorites[favorite_count].display_name),
-                        "%s (%s)", favorites[favorite_count].game_name, favorites[favorite_count].core_name);
+                        "%.250s (%.63s)", separator1 + 1, line);
 
                 favorite_count++;
             }
@@ -55,17 +58,19 @@ void favorites_save(void) {
     if (!fp) return;
 
     for (int i = 0; i < favorite_count; i++) {
-        fprintf(fp, "%s|%s|%s\n", favorites[i].core_name, favorites[i].game_name, favorites[i].full_path);
+        fprintf(fp, "%s|%s|%s\n", systems_folder(favorites[i].system), favorites[i].game_name, favorites[i].full_path);
     }
 
     fclose(fp);
 }
 
-bool favorites_toggle(const char *core_name, const char *game_name, const char *full_path) {
+bool favorites_toggle(SystemId system, const char *game_name, const char *full_path) {
+    if (system == SYSTEM_ID_NONE) return false;
+
     // Check if already favorited
     int existing_index = -1;
     for (int i = 0; i < favorite_count; i++) {
-        if (strcmp(favorites[i].core_name, core_name) == 0 &&
+        if (favorites[i].system == system &&
             strcmp(favorites[i].game_name, game_name) == 0) {
             existing_index = i;
             break;
@@ -86,11 +91,11 @@ bool favorites_toggle(const char *core_name, const char *game_name, const char *
             return false; // List full
         }
 
-        strncpy(favorites[favorite_count].core_name, core_name, sizeof(favorites[favorite_count].core_name) - 1);
+        favorites[favorite_count].system = system;
         strncpy(favorites[favorite_count].game_name, game_name, sizeof(favorites[favorite_count].game_name) - 1);
         strncpy(favorites[favorite_count].full_path, full_path, sizeof(favorites[favorite_count].full_path) - 1);
         snprintf(favorites[favorite_count].display_name, sizeof(favorites[favorite_count].display_name),
-                "%s (%s)", game_name, core_name);
+                "%s (%s)", game_name, systems_folder(system));
         favorite_count++;
         favorites_save();
         return true; // Added
@@ -111,9 +116,9 @@ bool favorites_remove_by_index(int index) {
     return true;
 }
 
-bool favorites_is_favorited(const char *core_name, const char *game_name) {
+bool favorites_is_favorited(SystemId system, const char *game_name) {
     for (int i = 0; i < favorite_count; i++) {
-        if (strcmp(favorites[i].core_name, core_name) == 0 &&
+        if (favorites[i].system == system &&
             strcmp(favorites[i].game_name, game_name) == 0) {
             return true;
         }
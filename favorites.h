@@ -2,11 +2,13 @@
 #define FAVORITES_H
 
 #include <stdbool.h>
+#include "systems.h"
 
 #define MAX_FAVORITES 100
 
+// The favorites file keeps the system folder name
 typedef struct {
-    char core_name[64];
+    SystemId system;
     char game_name[256];
     char full_path[512];
     char display_name[320];
@@ -15,9 +17,9 @@ typedef struct {
 void favorites_init(void);
 void favorites_load(void);
 void favorites_save(void);
-bool favorites_toggle(const char *core_name, const char *game_name, const char *full_path);
+bool favorites_toggle(SystemId system, const char *game_name, const char *full_path);
 bool favorites_remove_by_index(int index);
-bool favorites_is_favorited(const char *core_name, const char *game_name);
+bool favorites_is_favorited(SystemId system, const char *game_name);
 const FavoriteGame* favorites_get_list(void);
 int favorites_get_count(void);
 
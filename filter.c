@@ -0,0 +1,204 @@
+#include "filter.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FILTER_MAX_QUERY 64
+
+// All names folded to lowercase, NUL separated, in list order
+static char *folded_names = NULL;
+static uint32_t folded_size = 0;
+static uint32_t folded_capacity = 0;
+static uint32_t *name_offsets = NULL;
+static int name_count = 0;
+static int name_capacity = 0;
+
+// Current matches: [0, prefix_count) are prefix matches, the rest substring
+// matches; both groups ascending. scratch receives the next result.
+static int *matches = NULL;
+static int *scratch = NULL;
+static int match_count = 0;
+static int prefix_count = 0;
+static char current_query[FILTER_MAX_QUERY] = "";
+
+static void fold(const char *src, char *dst, size_t dst_size) {
+    size_t i = 0;
+    for (; src[i] && i < dst_size - 1; i++) {
+        char c = src[i];
+        dst[i] = (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+    }
+    dst[i] = '\0';
+}
+
+static const char* folded_name(int index) {
+    return folded_names + name_offsets[index];
+}
+
+int filter_begin(int capacity) {
+    filter_end();
+    if (capacity <= 0) capacity = 1;
+
+    name_offsets = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+    matches = (int*)malloc(capacity * sizeof(int));
+    scratch = (int*)malloc(capacity * sizeof(int));
+    folded_capacity = capacity * 32;
+    folded_names = (char*)malloc(folded_capacity);
+    if (!name_offsets || !matches || !scratch || !folded_names) {
+        filter_end();
+        return 0;
+    }
+
+    name_capacity = capacity;
+    return 1;
+}
+
+int filter_add_name(const char *name) {
+    if (name_count >= name_capacity) return 0;
+
+    uint32_t len = strlen(name);
+    if (folded_size + len + 1 > folded_capacity) {
+        uint32_t new_capacity = folded_capacity * 2;
+        while (new_capacity < folded_size + len + 1) new_capacity *= 2;
+        char *new_names = (char*)realloc(folded_names, new_capacity);
+        if (!new_names) return 0;
+        folded_names = new_names;
+        folded_capacity = new_capacity;
+    }
+
+    fold(name, folded_names + folded_size, len + 1);
+    name_offsets[name_count] = folded_size;
+    matches[name_count] = name_count;
+    folded_size += len + 1;
+    name_count++;
+    match_count = name_count;
+    prefix_count = name_count;
+    return 1;
+}
+
+void filter_end(void) {
+    free(folded_names);
+    free(name_offsets);
+    free(matches);
+    free(scratch);
+    folded_names = NULL;
+    name_offsets = NULL;
+    matches = NULL;
+    scratch = NULL;
+    folded_size = 0;
+    folded_capacity = 0;
+    name_count = 0;
+    name_capacity = 0;
+    match_count = 0;
+    prefix_count = 0;
+    current_query[0] = '\0';
+}
+
+// First index whose folded name compares above (strict) or at least (!strict)
+// the query over its length. The list is collation sorted, which agrees with
+// folded byte order for queries without digits.
+static int search_prefix_bound(const char *query, size_t len, int strict) {
+    int lo = 0;
+    int hi = name_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        int cmp = strncmp(folded_name(mid), query, len);
+        if (cmp < 0 || (strict && cmp == 0)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+int filter_set_query(const char *query) {
+    char folded_query[FILTER_MAX_QUERY];
+    fold(query, folded_query, sizeof(folded_query));
+    size_t len = strlen(folded_query);
+
+    if (!matches) return 0;
+
+    if (len == 0) {
+        for (int i = 0; i < name_count; i++) matches[i] = i;
+        match_count = name_count;
+        prefix_count = name_count;
+        current_query[0] = '\0';
+        return match_count;
+    }
+
+    // A longer query can only match a subset of what the shorter one matched
+    size_t previous_len = strlen(current_query);
+    int incremental = previous_len > 0 && previous_len <= len &&
+                      strncmp(folded_query, current_query, previous_len) == 0;
+
+    int has_digit = strpbrk(folded_query, "0123456789") != NULL;
+
+    // Prefix matches form one sorted range found by binary search; digit runs
+    // collate by value, so queries with digits fall back to the scan below
+    int range_start = 0, range_end = 0;
+    if (!has_digit) {
+        range_start = search_prefix_bound(folded_query, len, 0);
+        range_end = search_prefix_bound(folded_query, len, 1);
+    }
+
+    int count = 0;
+    for (int i = range_start; i < range_end; i++) {
+        scratch[count++] = i;
+    }
+
+    // One pass over the candidates in list order (every name, or the previous
+    // two match groups merged). Digit queries collect prefix matches at the
+    // front; substring matches are stacked from the back and moved up after.
+    int candidate_total = incremental ? match_count : name_count;
+    int next_prefix = 0;
+    int next_substring = prefix_count;
+    int tail = name_count;
+
+    for (int n = 0; n < candidate_total; n++) {
+        int index;
+        if (!incremental) {
+            index = n;
+        } else if (next_substring >= match_count ||
+                   (next_prefix < prefix_count && matches[next_prefix] < matches[next_substring])) {
+            index = matches[next_prefix++];
+        } else {
+            index = matches[next_substring++];
+        }
+
+        const char *name = folded_name(index);
+        if (has_digit ? strncmp(name, folded_query, len) == 0
+                      : (index >= range_start && index < range_end)) {
+            if (has_digit) scratch[count++] = index;
+        } else if (name[0] && strstr(name + 1, folded_query)) {
+            scratch[--tail] = index;
+        }
+    }
+
+    int new_prefix_count = count;
+    for (int lo = tail, hi = name_count - 1; lo < hi; lo++, hi--) {
+        int swap = scratch[lo];
+        scratch[lo] = scratch[hi];
+        scratch[hi] = swap;
+    }
+    memmove(scratch + count, scratch + tail, (name_count - tail) * sizeof(int));
+    count += name_count - tail;
+
+    int *swap = matches;
+    matches = scratch;
+    scratch = swap;
+    match_count = count;
+    prefix_count = new_prefix_count;
+
+    strncpy(current_query, folded_query, sizeof(current_query) - 1);
+    current_query[sizeof(current_query) - 1] = '\0';
+    return match_count;
+}
+
+int filter_get_match_count(void) {
+    return match_count;
+}
+
+int filter_get_match(int i) {
+    if (i < 0 || i >= match_count) return -1;
+    return matches[i];
+}
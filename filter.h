@@ -0,0 +1,32 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+// Type-ahead filter over a collation-sorted name list (see collate.h).
+// Names are case-folded once into a single buffer when the filter opens;
+// every query after that is answered from RAM without touching the card.
+//
+// Matches are returned prefix matches first, then names containing the
+// query elsewhere, each group in list order.
+
+// Start a filter for up to capacity names, returns 1 on success
+int filter_begin(int capacity);
+
+// Append the next name in list order (call once per name after filter_begin).
+// Returns 0 when it does not fit (out of memory); the filter is then
+// incomplete and must be ended.
+int filter_add_name(const char *name);
+
+// Free the folded buffer and match lists
+void filter_end(void);
+
+// Set the query and return the number of matches. Extending the previous
+// query only rescans the previous matches; an empty query matches everything.
+int filter_set_query(const char *query);
+
+// Number of matches for the current query
+int filter_get_match_count(void);
+
+// Position (in add order) of the match at rank i
+int filter_get_match(int i);
+
+#endif // FILTER_H
@@ -6,9 +6,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <stdint.h>
 #include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
 
 #ifdef SF2000
 
@@ -32,96 +34,15 @@ static loader_func_t direct_loader = (loader_func_t)LOADER_ADDR;
 #include "recent_games.h"
 #include "favorites.h"
 #include "settings.h"
-
-// Console to core name mapping (from buildcoresworking.sh)
-typedef struct {
-    const char *console_name;
-    const char *core_name;
-} ConsoleMapping;
-
-static const ConsoleMapping console_mappings[] = {
-    {"gb", "Gambatte"},
-    {"gbb", "TGBDual"}, 
-    {"gbgb", "Gearboy"},
-    {"dblcherrygb", "DoubleCherry-GB"},
-    {"gba", "gpSP"},
-    {"gbaf", "gpSP"}, 
-    {"gbaff", "gpSP"},
-    {"gbav", "VBA-Next"},
-    {"mgba", "mGBA"},
-    {"nes", "FCEUmm"},
-    {"nesq", "QuickNES"},
-    {"nest", "Nestopia"},
-    {"snes", "Snes9x2005"},
-    {"snes02", "Snes9x2002"},
-    {"sega", "PicoDrive"},
-    {"gg", "Gearsystem"},
-    {"gpgx", "Genesis-Plus-GX"},
-    {"pce", "Beetle-PCE-Fast"},
-    {"pcesgx", "Beetle-SuperGrafx"},
-    {"pcfx", "Beetle-PCFX"},
-    {"ngpc", "RACE"},
-    {"lnx", "Handy"},
-    {"lnxb", "Beetle-Lynx"},
-    {"wswan", "Beetle-WonderSwan"},
-    {"wsv", "Potator"},
-    {"pokem", "PokeMini"},
-    {"vb", "Beetle-VB"},
-    {"a26", "Stella2014"},
-    {"a5200", "Atari5200"},
-    {"a78", "ProSystem"},
-    {"a800", "Atari800"},
-    {"int", "FreeIntv"},
-    {"col", "Gearcoleco"},
-    {"msx", "BlueMSX"},
-    {"spec", "Fuse"},
-    {"zx81", "EightyOne"},
-    {"thom", "Theodore"},
-    {"vec", "VecX"},
-    {"c64", "VICE-x64"},
-    {"c64sc", "VICE-x64sc"},
-    {"c64f", "Frodo"},
-    {"c64fc", "Frodo"},
-    {"vic20", "VICE-xvic"},
-    {"amstradb", "CAP32"},
-    {"amstrad", "CrocoDS"},
-    {"bk", "BK-Emulator"},
-    {"pc8800", "QUASI88"},
-    {"xmil", "X-Millennium"},
-    {"m2k", "MAME2000"},
-    {"chip8", "JAXE"},
-    {"fcf", "FreeChaF"},
-    {"retro8", "Retro8"},
-    {"vapor", "VaporSpec"},
-    {"gong", "Gong"},
-    {"outrun", "Cannonball"},
-    {"wolf3d", "ECWolf"},
-    {"prboom", "PrBoom"},
-    {"flashback", "REminiscence"},
-    {"xrick", "XRick"},
-    {"gw", "Game-and-Watch"},
-    {"cdg", "PocketCDG"},
-    {"gme", "Game-Music-Emu"},
-    {"fake08", "FAKE-08"},
-    {"lowres-nx", "LowRes-NX"},
-    {"jnb", "Jump-n-Bump"},
-    {"cavestory", "NXEngine"},
-    {"o2em", "O2EM"},
-    {"quake", "TyrQuake"},
-    {"arduboy", "Arduous"},
-    {"js2000", "js2000"}
-};
-
-// Get core name for a console folder
-static const char* get_core_name_for_console(const char* console_name) {
-    int mapping_count = sizeof(console_mappings) / sizeof(console_mappings[0]);
-    for (int i = 0; i < mapping_count; i++) {
-        if (strcmp(console_mappings[i].console_name, console_name) == 0) {
-            return console_mappings[i].core_name;
-        }
-    }
-    return NULL; // Unknown console
-}
+#include "collate.h"
+#include "library.h"
+#include "systems.h"
+#include "dirindex.h"
+#include "zip.h"
+#include "filter.h"
+#include "search.h"
+#include "metadb.h"
+#include "sysicons.h"
 
 // Show core-specific settings menu
 static void show_core_settings(const char* core_name) {
@@ -145,123 +66,33 @@ static void show_core_settings(const char* core_name) {
 #define MAX_RECENT_GAMES 10
 #define INITIAL_ENTRIES_CAPACITY 64
 
-// Empty folders cache - avoid rescanning on every navigation
-#define EMPTY_DIRS_CACHE_FILE "/mnt/sda1/configs/frogui_empty_dirs.cache"
-#define MAX_EMPTY_DIRS 256
-static char empty_dirs[MAX_EMPTY_DIRS][64];  // Store folder names (not full paths)
-static int empty_dirs_count = 0;
-static int empty_dirs_loaded = 0;
-
-// Forward declarations
-static void rebuild_empty_dirs_cache(void);
-static void show_cache_rebuild_screen(void);
-
-// Load empty directories cache from file (or rebuild if missing)
-static void load_empty_dirs_cache(void) {
-    if (empty_dirs_loaded) return;
-    empty_dirs_loaded = 1;
-    empty_dirs_count = 0;
-
-    FILE *fp = fopen(EMPTY_DIRS_CACHE_FILE, "r");
-    if (!fp) {
-        // Cache file doesn't exist - rebuild it
-        xlog("Empty dirs cache: file not found, rebuilding...\n");
-        rebuild_empty_dirs_cache();
-        return;
-    }
-
-    char line[64];
-    while (fgets(line, sizeof(line), fp) && empty_dirs_count < MAX_EMPTY_DIRS) {
-        // Remove newline
-        int len = strlen(line);
-        if (len > 0 && line[len-1] == '\n') line[len-1] = '\0';
-        if (line[0] != '\0') {
-            strncpy(empty_dirs[empty_dirs_count], line, sizeof(empty_dirs[0]) - 1);
-            empty_dirs[empty_dirs_count][sizeof(empty_dirs[0]) - 1] = '\0';
-            empty_dirs_count++;
-        }
-    }
-    fclose(fp);
-    xlog("Empty dirs cache: loaded %d entries\n", empty_dirs_count);
-}
-
-// Check if a folder name is in the empty dirs cache
-static int is_in_empty_cache(const char *folder_name) {
-    for (int i = 0; i < empty_dirs_count; i++) {
-        if (strcasecmp(empty_dirs[i], folder_name) == 0) {
-            return 1;
-        }
-    }
-    return 0;
-}
-
-// Rebuild and save empty directories cache by scanning ROMS folder
-static void rebuild_empty_dirs_cache(void) {
-    show_cache_rebuild_screen();
-    empty_dirs_count = 0;
-
-    DIR *dir = opendir(ROMS_PATH);
-    if (!dir) return;
-
-    struct dirent *ent;
-    while ((ent = readdir(dir)) != NULL && empty_dirs_count < MAX_EMPTY_DIRS) {
-        if (ent->d_name[0] == '.') continue;
-        if (strcasecmp(ent->d_name, "frogui") == 0 ||
-            strcasecmp(ent->d_name, "saves") == 0 ||
-            strcasecmp(ent->d_name, "save") == 0) continue;
-
-        // Skip non-directories using d_type (avoids stat() syscall)
-        if (ent->d_type != DT_DIR) continue;
-
-        // Save entry name BEFORE inner readdir (readdir uses static buffer!)
-        char entry_name[64];
-        strncpy(entry_name, ent->d_name, sizeof(entry_name) - 1);
-        entry_name[sizeof(entry_name) - 1] = '\0';
-
-        char full_path[MAX_PATH_LEN];
-        snprintf(full_path, sizeof(full_path), "%s/%s", ROMS_PATH, entry_name);
-
-        // Check if directory is empty via opendir/readdir
-        DIR *check = opendir(full_path);
-        if (check) {
-            int has_content = 0;
-            struct dirent *sub;
-            while ((sub = readdir(check)) != NULL) {
-                if (sub->d_name[0] != '.') {
-                    has_content = 1;
-                    break;
-                }
-            }
-            closedir(check);
-
-            if (!has_content) {
-                strncpy(empty_dirs[empty_dirs_count], entry_name, sizeof(empty_dirs[0]) - 1);
-                empty_dirs[empty_dirs_count][sizeof(empty_dirs[0]) - 1] = '\0';
-                empty_dirs_count++;
-            }
-        }
-    }
-    closedir(dir);
-
-    // Save to file
-    FILE *fp = fopen(EMPTY_DIRS_CACHE_FILE, "w");
-    if (fp) {
-        for (int i = 0; i < empty_dirs_count; i++) {
-            fprintf(fp, "%s\n", empty_dirs[i]);
-        }
-        fclose(fp);
-    }
-    xlog("Empty dirs cache: rebuilt with %d entries\n", empty_dirs_count);
-}
+// Empty folders cache of older versions, replaced by the library catalog
+#define LEGACY_EMPTY_DIRS_CACHE_FILE "/mnt/sda1/configs/frogui_empty_dirs.cache"
 
 // Layout constants are now in render.h
 
 // Thumbnail cache
 static Thumbnail current_thumbnail;
-static char cached_thumbnail_path[MAX_PATH_LEN];
 static int thumbnail_cache_valid = 0;
 static int last_selected_index = -1;
 
+// Prefetch: idle frames read the thumbnails of the selection's neighbours
+// into the thumbnail cache (render.h), the scroll direction first, so moving
+// onto them reads nothing
+#define THUMB_PREFETCH_RADIUS 2
+static int thumb_scroll_direction = 1;     // Last selection move: 1 down, -1 up
+static int thumb_prev_selected = -1;
+static int thumb_loaded_this_frame = 0;    // A thumbnail file was read this frame
+
+// Debounce: a thumbnail that is not cached is read only once the selection
+// has rested for THUMB_DEBOUNCE_FRAMES, so scrolling through a list reads
+// nothing; from THUMB_PREVIEW_FRAMES on, a low-resolution preview from the
+// pack is shown meanwhile
+#define THUMB_DEBOUNCE_FRAMES 6
+#define THUMB_PREVIEW_FRAMES 3
+static int thumb_pending_frames = 0;       // Frames left before the selection's thumbnail is read
+static int thumb_rest_frames = 0;          // Frames since the selection changed (up to THUMB_DEBOUNCE_FRAMES)
+
 // Text scrolling state
 static int text_scroll_frame_counter = 0;
 static int text_scroll_offset = 0;
@@ -272,6 +103,9 @@ typedef struct {
     char path[MAX_PATH_LEN];
     char name[256];
     int is_dir;
+    int rom_count;      // Game count for system folders in the root, -1 otherwise
+    uint32_t size;      // Member size inside a zip archive (archive view only)
+    uint64_t sort_key;  // Collation key, computed once when the entry is added
 } MenuEntry;
 
 static MenuEntry *entries = NULL;
@@ -291,6 +125,83 @@ static int at_boundary = 0; // 1 = at top, 2 = at bottom
 static int az_picker_active = 0;
 static int az_selected_index = 0; // 0-25 for A-Z, 26 for 0-9, 27 for #
 
+// A-Z jump table - rebuilt after each folder scan so a jump is a single lookup
+#define AZ_BUCKET_COUNT 28
+#define AZ_BUCKET_DIGITS 26
+#define AZ_BUCKET_OTHER 27
+static int az_bucket_first[AZ_BUCKET_COUNT]; // First entry index, -1 if empty
+static int az_bucket_size[AZ_BUCKET_COUNT];  // Number of entries in the bucket
+
+// Type-ahead filter: the list shows only matches for the typed query
+#define FILTER_QUERY_MAX 24
+#define FILTER_KEY_COLUMNS 10
+#define FILTER_KEY_ROWS 6
+#define FILTER_KEY_SPACE 50   // Bottom row: SPACE, DEL, DONE
+#define FILTER_KEY_DELETE 51
+#define FILTER_KEY_DONE 52
+#define FILTER_KEY_LAST_ROW (FILTER_KEY_SPACE - FILTER_KEY_COLUMNS)  // First key of the row above
+// Enough for No-Intro style names ("Tetris (World) (Rev 1)") when renaming
+static const char filter_key_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ-'.&0123456789(),_![]+~@";
+static int filter_keyboard_active = 0;
+static int filter_applied = 0;                // List is showing filter matches
+static int filter_base_count = 0;             // entry_count of the unfiltered list
+static int filter_first = 0;                  // First filtered list index (after "..")
+static int filter_key_index = 0;
+static char filter_query[FILTER_QUERY_MAX + 1];
+static int keyboard_lowercase = 0;            // L switches the letter keys' case
+
+// File actions on the selected ROM (START in a ROM folder)
+#define FILE_ACTION_RENAME 0
+#define FILE_ACTION_DELETE 1
+#define FILE_ACTION_FLATTEN 2     // Switch the system between folder and flattened view
+#define FILE_ACTION_COUNT 3
+#define FILE_RENAME_MAX 200
+static int file_menu_active = 0;
+static int file_menu_index = 0;               // Into file_menu_actions
+static int file_menu_actions[FILE_ACTION_COUNT];
+static int file_menu_action_count = 0;
+static int file_delete_confirm = 0;           // Waiting for A to confirm the delete
+static int file_rename_active = 0;            // Keyboard is editing a new file name
+static char file_action_name[256];            // Entry the action applies to
+static char file_rename_text[FILE_RENAME_MAX + 1];
+
+// Virtual list: ROM folders are read from their on-disk directory index, with
+// only a window around the visible rows decoded. entries[] then holds just the
+// leading fixed items (".."), so memory no longer grows with folder size.
+#define LIST_WINDOW_SIZE 32
+#define LIST_WINDOW_MARGIN 8
+static int list_virtual = 0;
+static int list_fixed_count = 0;               // entries[] items before the indexed ones
+static int list_archive = 0;                   // Listing the members of a .zip archive
+static MenuEntry list_window[LIST_WINDOW_SIZE];
+static int list_window_index[LIST_WINDOW_SIZE]; // List index held by each slot, -1 if empty
+static int list_metadata = 0;                  // The system has a metadata table (metadb.h)
+static GameInfo list_window_info[LIST_WINDOW_SIZE]; // Metadata of each slot, title NULL if none
+
+// A filter's matches are scattered through the index, so filtered virtual
+// lists get their own window of consecutive match ranks, refilled only when
+// the query changes or the rows on screen leave it
+static MenuEntry filter_window[LIST_WINDOW_SIZE];
+static GameInfo filter_window_info[LIST_WINDOW_SIZE];
+static int filter_window_start = -1;          // First match rank held, -1 if none
+static int filter_window_count = 0;
+
+// Short message drawn over the list (a failed filter build or random pick)
+#define LIST_NOTICE_FRAMES 90
+static const char *list_notice = NULL;
+static int list_notice_frames = 0;
+
+// Flattened systems list every ROM under the system folder, subfolders
+// included, from a tree index that is built a slice per frame when stale
+#define FLATTEN_FILE "/mnt/sda1/configs/frogui_flatten.txt"
+#define MAX_FLATTENED_SYSTEMS 64
+#define TREE_BUILD_SLICE 64        // Folder entries read per frame while building
+static char flattened_systems[MAX_FLATTENED_SYSTEMS][64];
+static int flattened_count = -1;               // -1 until the file is read
+static int list_tree = 0;                      // Listing a flattened system
+static int tree_build_active = 0;              // Its tree index is still being built
+static int skip_flatten_once = 0;              // Tree build failed - list the folder itself
+
 // Ensure entries array has enough capacity
 static void ensure_entries_capacity(int required_capacity) {
     if (entries_capacity >= required_capacity) {
@@ -313,6 +224,257 @@ static void ensure_entries_capacity(int required_capacity) {
     entries_capacity = new_capacity;
 }
 
+// Empty the current list (materialized and virtual)
+static void clear_entries(void) {
+    if (filter_applied || filter_keyboard_active) {
+        filter_end();
+        filter_applied = 0;
+        filter_keyboard_active = 0;
+    }
+    entry_count = 0;
+    list_virtual = 0;
+    list_fixed_count = 0;
+    list_archive = 0;
+    list_tree = 0;
+    tree_build_active = 0;
+    list_metadata = 0;
+    dirindex_close();
+}
+
+// Switch the list to the open directory index, after the fixed entries
+static void attach_directory_index(void) {
+    list_virtual = 1;
+    list_fixed_count = entry_count;
+    entry_count += dirindex_count();
+    for (int i = 0; i < LIST_WINDOW_SIZE; i++) {
+        list_window_index[i] = -1;
+    }
+}
+
+// Copy a decoded index record into a window slot. Returns 0 if its path does
+// not fit (the slot must not be used).
+static int set_window_entry(MenuEntry *entry, GameInfo *info, const DirIndexItem *item) {
+    int path_len;
+    if (item->folder[0]) {
+        path_len = snprintf(entry->path, sizeof(entry->path), "%s/%s/%s", current_path, item->folder, item->name);
+    } else {
+        path_len = snprintf(entry->path, sizeof(entry->path), "%s/%s", current_path, item->name);
+    }
+    if (path_len < 0 || path_len >= (int)sizeof(entry->path)) return 0;
+
+    strncpy(entry->name, item->name, sizeof(entry->name) - 1);
+    entry->name[sizeof(entry->name) - 1] = '\0';
+    entry->is_dir = item->is_dir;
+    entry->rom_count = -1;
+    entry->size = item->size;
+    entry->sort_key = item->sort_key;
+    // Looked up once per decode, so rendering reads the title directly
+    if (!list_metadata || item->is_dir || !metadb_find_name(item->name, info)) {
+        info->title = NULL;
+    }
+    return 1;
+}
+
+// Read failed (card removed?) or the path is too long - a harmless entry for
+// the current folder
+static void set_placeholder_entry(MenuEntry *entry, GameInfo *info) {
+    entry->name[0] = '\0';
+    strncpy(entry->path, current_path, sizeof(entry->path) - 1);
+    entry->path[sizeof(entry->path) - 1] = '\0';
+    entry->is_dir = 1;
+    entry->rom_count = -1;
+    entry->size = 0;
+    entry->sort_key = 0;
+    info->title = NULL;
+}
+
+// Decode the window around index from the directory index
+static void fill_list_window(int index) {
+    int start = index - LIST_WINDOW_MARGIN;
+    if (start < list_fixed_count) start = list_fixed_count;
+
+    DirIndexItem items[LIST_WINDOW_SIZE];
+    int decoded = dirindex_read(start - list_fixed_count, LIST_WINDOW_SIZE, items);
+
+    for (int i = 0; i < decoded; i++) {
+        int slot = (start + i) % LIST_WINDOW_SIZE;
+        if (!set_window_entry(&list_window[slot], &list_window_info[slot], &items[i])) {
+            set_placeholder_entry(&list_window[slot], &list_window_info[slot]);
+        }
+        list_window_index[slot] = start + i;
+    }
+
+    int slot = index % LIST_WINDOW_SIZE;
+    if (list_window_index[slot] != index) {
+        set_placeholder_entry(&list_window[slot], &list_window_info[slot]);
+        list_window_index[slot] = index;
+    }
+}
+
+// Decode the matches ranked around rank, reading runs of adjacent records
+// together (prefix matches are one run)
+static void fill_filter_window(int rank) {
+    int start = rank - LIST_WINDOW_MARGIN;
+    if (start < 0) start = 0;
+    int count = filter_get_match_count() - start;
+    if (count > LIST_WINDOW_SIZE) count = LIST_WINDOW_SIZE;
+
+    DirIndexItem items[LIST_WINDOW_SIZE];
+    for (int i = 0; i < count; ) {
+        int index = filter_first + filter_get_match(start + i);
+        if (index < list_fixed_count) {
+            filter_window[i] = entries[index];
+            filter_window_info[i].title = NULL;
+            i++;
+            continue;
+        }
+
+        int run = 1;
+        while (i + run < count && filter_first + filter_get_match(start + i + run) == index + run) {
+            run++;
+        }
+        int decoded = dirindex_read(index - list_fixed_count, run, items);
+        for (int j = 0; j < run; j++) {
+            if (j >= decoded ||
+                !set_window_entry(&filter_window[i + j], &filter_window_info[i + j], &items[j])) {
+                set_placeholder_entry(&filter_window[i + j], &filter_window_info[i + j]);
+            }
+        }
+        i += run;
+    }
+
+    filter_window_start = start;
+    filter_window_count = count;
+}
+
+// Metadata of a list entry, NULL if the system's table does not know it
+static const GameInfo *entry_info(const MenuEntry *entry) {
+    const GameInfo *info;
+    if (!list_virtual) {
+        return NULL;
+    } else if (entry >= list_window && entry < list_window + LIST_WINDOW_SIZE) {
+        info = &list_window_info[entry - list_window];
+    } else if (entry >= filter_window && entry < filter_window + LIST_WINDOW_SIZE) {
+        info = &filter_window_info[entry - filter_window];
+    } else {
+        return NULL;
+    }
+    return info->title ? info : NULL;
+}
+
+// Get item of the unfiltered list
+static MenuEntry *list_entry_at(int index) {
+    if (!list_virtual || index < list_fixed_count) {
+        return &entries[index];
+    }
+
+    int slot = index % LIST_WINDOW_SIZE;
+    if (list_window_index[slot] != index) {
+        fill_list_window(index);
+    }
+    return &list_window[slot];
+}
+
+// Get list item at index (0 <= index < entry_count), through the filter if active
+static MenuEntry *list_get(int index) {
+    if (filter_applied && list_virtual) {
+        if (filter_window_start < 0 || index < filter_window_start ||
+            index >= filter_window_start + filter_window_count) {
+            fill_filter_window(index);
+        }
+        return &filter_window[index - filter_window_start];
+    }
+    if (filter_applied) {
+        return list_entry_at(filter_first + filter_get_match(index));
+    }
+    return list_entry_at(index);
+}
+
+// Find a list item by exact name, -1 if not found
+static int list_find_name(const char *name) {
+    int materialized = list_virtual ? list_fixed_count : entry_count;
+    for (int i = 0; i < materialized; i++) {
+        if (strcmp(entries[i].name, name) == 0) {
+            return i;
+        }
+    }
+
+    if (list_virtual) {
+        int index = dirindex_find_name(name);
+        return index < 0 ? -1 : index + list_fixed_count;
+    }
+    return -1;
+}
+
+// Map a name to its A-Z picker bucket by first character (case insensitive)
+static int az_bucket_for_name(const char *name) {
+    char c = name[0];
+    if (c >= 'a' && c <= 'z') return c - 'a';
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= '0' && c <= '9') return AZ_BUCKET_DIGITS;
+    return AZ_BUCKET_OTHER;
+}
+
+// Menu rows (Recent games, Favorites, Search, Tools, ...) rather than files:
+// their path is a view name, not a path on the card
+static int is_special_entry(const MenuEntry *entry) {
+    return strchr(entry->path, '/') == NULL;
+}
+
+// Fill the A-Z jump table from the directory index lead byte table
+static void build_az_buckets_from_index(void) {
+    uint8_t bucket_byte[AZ_BUCKET_DIGITS + 1];
+    char letter[2] = {0, 0};
+    for (int b = 0; b < AZ_BUCKET_DIGITS; b++) {
+        letter[0] = 'a' + b;
+        bucket_byte[b] = (uint8_t)(collate_key(letter) >> 56);
+    }
+    bucket_byte[AZ_BUCKET_DIGITS] = (uint8_t)(collate_key("0") >> 56);
+
+    int first, count;
+    int named_total = 0;
+    for (int b = 0; b <= AZ_BUCKET_DIGITS; b++) {
+        dirindex_get_byte_range(bucket_byte[b], &first, &count);
+        if (count > 0) {
+            az_bucket_first[b] = first + list_fixed_count;
+            az_bucket_size[b] = count;
+            named_total += count;
+        }
+    }
+
+    // Everything else lands in "#", starting at the first other lead byte
+    az_bucket_size[AZ_BUCKET_OTHER] = dirindex_count() - named_total;
+    for (int v = 0; v < 256 && az_bucket_size[AZ_BUCKET_OTHER] > 0; v++) {
+        dirindex_get_byte_range((uint8_t)v, &first, &count);
+        if (count == 0 || memchr(bucket_byte, v, sizeof(bucket_byte))) continue;
+        az_bucket_first[AZ_BUCKET_OTHER] = first + list_fixed_count;
+        break;
+    }
+}
+
+// Build the A-Z jump table from the current entries
+static void build_az_buckets(void) {
+    for (int b = 0; b < AZ_BUCKET_COUNT; b++) {
+        az_bucket_first[b] = -1;
+        az_bucket_size[b] = 0;
+    }
+
+    if (list_virtual) {
+        build_az_buckets_from_index();
+        return;
+    }
+
+    for (int i = 0; i < entry_count; i++) {
+        if (strcmp(entries[i].name, "..") == 0 || is_special_entry(&entries[i])) continue;
+
+        int b = az_bucket_for_name(entries[i].name);
+        if (az_bucket_first[b] < 0) {
+            az_bucket_first[b] = i;
+        }
+        az_bucket_size[b]++;
+    }
+}
+
 // Reset navigation state when entering new folder
 static void reset_navigation_state(void) {
     selected_index = 0;
@@ -321,6 +483,126 @@ static void reset_navigation_state(void) {
     at_boundary = 0;
 }
 
+// Open the filter keyboard, folding every name of the current folder once
+static void open_filter(void) {
+    if (!filter_applied) {
+        filter_first = (entry_count > 0 && strcmp(list_entry_at(0)->name, "..") == 0) ? 1 : 0;
+        int count = entry_count - filter_first;
+        if (count <= 0) return;
+
+        // Every name must go in, or match positions would point at the wrong entries
+        int added = 0;
+        if (filter_begin(count)) {
+            if (list_virtual) {
+                // Read straight from the index in large batches instead of through the window
+                DirIndexItem items[DIRINDEX_MAX_READ];
+                while (added < count) {
+                    int decoded = dirindex_read(added, DIRINDEX_MAX_READ, items);
+                    if (decoded <= 0) break;
+                    int j = 0;
+                    while (j < decoded && filter_add_name(items[j].name)) j++;
+                    added += j;
+                    if (j < decoded) break;
+                }
+            } else {
+                while (added < count && filter_add_name(entries[filter_first + added].name)) added++;
+            }
+        }
+        if (added < count) {
+            filter_end();
+            list_notice = "Not enough memory to filter this folder";
+            list_notice_frames = LIST_NOTICE_FRAMES;
+            return;
+        }
+
+        filter_window_start = -1;
+        filter_base_count = entry_count;
+        filter_query[0] = '\0';
+        filter_applied = 1;
+    }
+
+    filter_keyboard_active = 1;
+    filter_key_index = 0;
+}
+
+// Re-run the query after a keystroke and show the best match first
+static void update_filter(void) {
+    entry_count = filter_set_query(filter_query);
+    filter_window_start = -1;
+    selected_index = 0;
+    scroll_offset = 0;
+    last_selected_index = -1;  // Reload the thumbnail for the new selection
+}
+
+// Leave the filter, keeping the selected entry selected in the full list
+static void close_filter(void) {
+    int selected = -1;
+    if (entry_count > 0 && selected_index < entry_count) {
+        selected = filter_first + filter_get_match(selected_index);
+    }
+
+    filter_end();
+    filter_applied = 0;
+    filter_keyboard_active = 0;
+    entry_count = filter_base_count;
+
+    reset_navigation_state();
+    if (selected >= 0) {
+        selected_index = selected;
+        if (selected_index >= VISIBLE_ENTRIES) {
+            scroll_offset = selected_index - VISIBLE_ENTRIES + 1;
+        }
+    }
+    last_selected_index = -1;
+}
+
+// Fill the search screen with the best matches for the typed query, ".." last
+static void update_search(void) {
+    SearchResult results[SEARCH_MAX_RESULTS];
+    int result_count = filter_query[0] ? search_query(filter_query, results, SEARCH_MAX_RESULTS) : 0;
+
+    entry_count = 0;
+    ensure_entries_capacity(result_count + 1);
+    for (int i = 0; i < result_count; i++) {
+        int rom_index = results[i].rom_index;
+        strncpy(entries[entry_count].name, library_get_rom_name(rom_index), sizeof(entries[entry_count].name) - 1);
+        entries[entry_count].name[sizeof(entries[entry_count].name) - 1] = '\0';
+        library_get_rom_path(rom_index, entries[entry_count].path, sizeof(entries[entry_count].path));
+        entries[entry_count].is_dir = 0;
+        entries[entry_count].rom_count = -1;
+        entries[entry_count].size = library_get_rom(rom_index)->size;
+        entry_count++;
+    }
+
+    strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
+    strncpy(entries[entry_count].path, ROMS_PATH, sizeof(entries[entry_count].path) - 1);
+    entries[entry_count].is_dir = 1;
+    entries[entry_count].rom_count = -1;
+    entry_count++;
+
+    selected_index = 0;
+    scroll_offset = 0;
+    last_selected_index = -1;  // Reload the thumbnail for the new selection
+}
+
+// Open the library-wide search screen with the keyboard up
+static void show_search(void) {
+    clear_entries();
+    reset_navigation_state();
+
+    strncpy(current_path, "SEARCH", sizeof(current_path) - 1);
+    current_path[sizeof(current_path) - 1] = '\0';
+    thumbnail_cache_mixed_folders(1);
+
+    // Loads the trigram index, or builds it if the catalog changed
+    search_open();
+
+    filter_query[0] = '\0';
+    update_search();
+    filter_keyboard_active = 1;
+    filter_key_index = 0;
+}
+
 // Libretro callbacks
 static retro_video_refresh_t video_cb = NULL;
 static retro_audio_sample_t audio_cb = NULL;
@@ -333,15 +615,14 @@ static retro_input_state_t input_state_cb = NULL;
 static int prev_input[16] = {0};
 static bool game_queued = false;  // Flag to indicate game is queued
 
-// Show a loading screen during cache rebuild
-static void show_cache_rebuild_screen(void) {
+// Show a centered status message immediately (used during long cache work)
+static void show_status_screen(const char *msg) {
     if (!framebuffer || !video_cb) return;
 
     // Fill background
     render_fill_rect(framebuffer, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, theme_bg());
 
     // Draw centered message
-    const char* msg = "Rebuilding folder cache...";
     int text_width = font_measure_text(msg);
     int x = (SCREEN_WIDTH - text_width) / 2;
     int y = (SCREEN_HEIGHT - FONT_CHAR_HEIGHT) / 2;
@@ -351,12 +632,46 @@ static void show_cache_rebuild_screen(void) {
     video_cb(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_WIDTH * sizeof(uint16_t));
 }
 
+// Library catalog callback - a system folder is about to be (re)scanned
+static void show_library_scan_screen(const char *system_name) {
+    char msg[96];
+    snprintf(msg, sizeof(msg), "Indexing %s...", system_name);
+    show_status_screen(msg);
+}
+
 // Get the base name from a path
 static const char *get_basename(const char *path) {
     const char *base = strrchr(path, '/');
     return base ? base + 1 : path;
 }
 
+// Separates an archive from the member launched out of it
+#define ARCHIVE_MEMBER_SEPARATOR '#'
+
+// Name a launched game is saved under: the file's base name, or for an
+// archive member ("<archive>.zip#<member>") the member's
+static const char *launch_base_name(const char *filename) {
+    for (const char *mark = strchr(filename, ARCHIVE_MEMBER_SEPARATOR); mark;
+         mark = strchr(mark + 1, ARCHIVE_MEMBER_SEPARATOR)) {
+        if (mark - filename >= 4 && strncasecmp(mark - 4, ".zip", 4) == 0) {
+            filename = mark + 1;
+            break;
+        }
+    }
+    return get_basename(filename);
+}
+
+// Name a ROM entry is launched and favorited under: its path below the
+// system folder, so ROMs listed from subfolders keep the subfolder
+static const char *entry_game_name(const MenuEntry *entry) {
+    size_t len = strlen(current_path);
+    if (list_tree && strncmp(entry->path, current_path, len) == 0 && entry->path[len] == '/') {
+        return entry->path + len + 1;
+    }
+    const char *filename_path = strrchr(entry->path, '/');
+    return filename_path ? filename_path + 1 : entry->name;
+}
+
 // Auto-launch most recent game if resume on boot is enabled
 static void auto_launch_recent_game(void) {
     // Check if resume on boot is enabled
@@ -375,13 +690,13 @@ static void auto_launch_recent_game(void) {
 
     // Get the first (most recent) game
     const RecentGame *game = &recent_list[0];
-    const char *core_name = game->core_name;
+    const char *core_name = systems_folder(game->system);
     const char *filename = game->game_name;
 
     // Queue the game for launch
     sprintf((char *)ptr_gs_run_game_file, "%s;%s;%s.gba", core_name, core_name, filename); // TODO: Replace second core_name with full directory (besides /mnt/sda1) and seperate core_name from directory
     // Don't set ptr_gs_run_folder - inherit from menu core for savestates to work
-    sprintf((char *)ptr_gs_run_game_name, "%s", filename);
+    sprintf((char *)ptr_gs_run_game_name, "%s", launch_base_name(filename));
 
     // Remove extension from ptr_gs_run_game_name
     char *dot_position = strrchr(ptr_gs_run_game_name, '.');
@@ -454,85 +769,94 @@ static void get_scrolling_text(const char *full_name, int is_selected, char *dis
     display_name[copy_len] = '\0';
 }
 
-// Load thumbnail for currently selected item
+// Thumbnail file of a list item, 0 if it has none (folders, "..")
+static int get_entry_thumbnail_path(int index, char *thumb_path, size_t thumb_path_size) {
+    if (index < 0 || index >= entry_count || list_get(index)->is_dir) {
+        return 0;
+    }
+
+    // Recent games and favorites use the full path kept with the game
+    const char *game_path;
+    if (strcmp(current_path, "RECENT_GAMES") == 0) {
+        if (index >= recent_games_get_count()) return 0;
+        game_path = recent_games_get_list()[index].full_path;
+    } else if (strcmp(current_path, "FAVORITES") == 0) {
+        if (index >= favorites_get_count()) return 0;
+        game_path = favorites_get_list()[index].full_path;
+    } else {
+        game_path = list_get(index)->path;
+    }
+
+    if (game_path[0] == '\0') return 0;  // No full path available
+    get_thumbnail_path(game_path, thumb_path, thumb_path_size);
+    return thumb_path[0] != '\0';
+}
+
+// Load thumbnail for currently selected item (from the cache when prefetched)
 static void load_current_thumbnail() {
-    if (selected_index < 0 || selected_index >= entry_count || entry_count == 0) {
-        thumbnail_cache_valid = 0;
-        return;
+    if (thumb_prev_selected >= 0 && selected_index != thumb_prev_selected) {
+        thumb_scroll_direction = selected_index > thumb_prev_selected ? 1 : -1;
     }
-    
-    // Only load thumbnails for files, not directories
-    if (entries[selected_index].is_dir) {
+    thumb_prev_selected = selected_index;
+    thumb_pending_frames = 0;
+
+    char thumb_path[MAX_PATH_LEN];
+    if (!get_entry_thumbnail_path(selected_index, thumb_path, sizeof(thumb_path))) {
         thumbnail_cache_valid = 0;
         return;
     }
-    
+
+    if (!thumbnail_cache_has(thumb_path)) {
+        thumb_loaded_this_frame = 1;
+    }
+    thumbnail_cache_valid = load_thumbnail(thumb_path, &current_thumbnail);
+}
+
+// Show the selection's preview while its thumbnail waits to be read
+static void load_current_preview(void) {
+    const char *preview_setting = settings_get_value("frogui_thumb_preview");
+    if (preview_setting && strcmp(preview_setting, "true") != 0) return;
+
     char thumb_path[MAX_PATH_LEN];
-    
-    // Check if we're in Recent games mode
-    if (strcmp(current_path, "RECENT_GAMES") == 0) {
-        // For recent games, we need to use the full_path from the RecentGame structure
-        const RecentGame* recent_list = recent_games_get_list();
-        int recent_count = recent_games_get_count();
+    if (!get_entry_thumbnail_path(selected_index, thumb_path, sizeof(thumb_path))) return;
 
-        if (selected_index < recent_count) {
-            const RecentGame *recent_game = &recent_list[selected_index];
+    thumbnail_cache_valid = thumbnail_cache_preview(thumb_path, &current_thumbnail);
+    thumb_loaded_this_frame = 1;
+}
 
-            if (recent_game->full_path[0] != '\0') {
-                get_thumbnail_path(recent_game->full_path, thumb_path, sizeof(thumb_path));
-            } else {
-                // No full path available, skip thumbnail
-                thumbnail_cache_valid = 0;
-                return;
-            }
-        } else {
-            // This is the ".." entry, no thumbnail
-            thumbnail_cache_valid = 0;
-            return;
-        }
-    } else if (strcmp(current_path, "FAVORITES") == 0) {
-        // For favorites, we need to use the full_path from the FavoriteGame structure
-        const FavoriteGame* favorites_list = favorites_get_list();
-        int favorites_count = favorites_get_count();
+// New selection: show its thumbnail now if that reads nothing, otherwise read
+// its preview and then the thumbnail as the selection rests
+static void request_current_thumbnail(void) {
+    thumb_rest_frames = 0;
+    thumb_pending_frames = 0;
 
-        if (selected_index < favorites_count) {
-            const FavoriteGame *favorite_game = &favorites_list[selected_index];
+    char thumb_path[MAX_PATH_LEN];
+    if (!get_entry_thumbnail_path(selected_index, thumb_path, sizeof(thumb_path)) ||
+        thumbnail_cache_has(thumb_path)) {
+        load_current_thumbnail();
+        return;
+    }
 
-            if (favorite_game->full_path[0] != '\0') {
-                get_thumbnail_path(favorite_game->full_path, thumb_path, sizeof(thumb_path));
-            } else {
-                // No full path available, skip thumbnail
-                thumbnail_cache_valid = 0;
+    thumb_pending_frames = THUMB_DEBOUNCE_FRAMES;
+    thumbnail_cache_valid = 0;
+}
+
+// Read one neighbour thumbnail of the selection into the cache: nearest
+// first, the scroll direction before the other side
+static void prefetch_thumbnails(void) {
+    for (int distance = 1; distance <= THUMB_PREFETCH_RADIUS; distance++) {
+        for (int side = 0; side < 2; side++) {
+            int step = side == 0 ? thumb_scroll_direction : -thumb_scroll_direction;
+            int index = selected_index + step * distance;
+
+            char thumb_path[MAX_PATH_LEN];
+            if (!get_entry_thumbnail_path(index, thumb_path, sizeof(thumb_path))) continue;
+
+            if (thumbnail_cache_prefetch(thumb_path)) {
+                thumb_loaded_this_frame = 1;
                 return;
             }
-        } else {
-            // This is the ".." entry, no thumbnail
-            thumbnail_cache_valid = 0;
-            return;
         }
-    } else {
-        // Regular file browser mode
-        get_thumbnail_path(entries[selected_index].path, thumb_path, sizeof(thumb_path));
-    }
-    
-    // Check if we already have this thumbnail cached
-    if (thumbnail_cache_valid && strcmp(cached_thumbnail_path, thumb_path) == 0) {
-        return; // Already cached
-    }
-    
-    // Free previous thumbnail
-    if (thumbnail_cache_valid) {
-        free_thumbnail(&current_thumbnail);
-        thumbnail_cache_valid = 0;
-    }
-    
-    // Try to load new thumbnail
-    if (load_thumbnail(thumb_path, &current_thumbnail)) {
-        strncpy(cached_thumbnail_path, thumb_path, sizeof(cached_thumbnail_path) - 1);
-        cached_thumbnail_path[sizeof(cached_thumbnail_path) - 1] = '\0';
-        thumbnail_cache_valid = 1;
-        
-    } else {
     }
 }
 
@@ -551,16 +875,151 @@ static inline int is_directory_fast(const char *path, unsigned char d_type) {
     return 0;
 }
 
-// Comparison function to sort entries alphabetically by name
-int compare_entries(const void *a, const void *b) {
-    const MenuEntry *entry_a = (const MenuEntry *)a;
-    const MenuEntry *entry_b = (const MenuEntry *)b;
-    return strcmp(entry_a->name, entry_b->name);  // Compare by name
+// Get the system folder ("gba") for a path inside the ROMs root, 0 if outside
+static int get_system_folder(const char *path, char *folder, size_t folder_size) {
+    size_t root_len = strlen(ROMS_PATH);
+    if (strncmp(path, ROMS_PATH, root_len) != 0 || path[root_len] != '/') {
+        return 0;
+    }
+
+    const char *start = path + root_len + 1;
+    size_t len = strcspn(start, "/");
+    if (len == 0 || len >= folder_size) {
+        return 0;
+    }
+
+    memcpy(folder, start, len);
+    folder[len] = '\0';
+    return 1;
+}
+
+static void load_flattened_systems(void) {
+    flattened_count = 0;
+    FILE *fp = fopen(FLATTEN_FILE, "r");
+    if (!fp) return;
+
+    char line[64];
+    while (flattened_count < MAX_FLATTENED_SYSTEMS && fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0]) {
+            strcpy(flattened_systems[flattened_count++], line);
+        }
+    }
+    fclose(fp);
+}
+
+// Whether path is a system folder the user chose to see flattened
+static int is_system_flattened(const char *path) {
+    char system_folder[64];
+    if (!get_system_folder(path, system_folder, sizeof(system_folder)) ||
+        strlen(path) != strlen(ROMS_PATH) + 1 + strlen(system_folder)) {
+        return 0;
+    }
+
+    if (flattened_count < 0) load_flattened_systems();
+    for (int i = 0; i < flattened_count; i++) {
+        if (strcmp(flattened_systems[i], system_folder) == 0) return 1;
+    }
+    return 0;
+}
+
+// Switch a system between flattened and folder view, and save the choice
+static void toggle_system_flattened(const char *system_name) {
+    if (strlen(system_name) >= sizeof(flattened_systems[0])) return;
+    if (flattened_count < 0) load_flattened_systems();
+
+    int found = 0;
+    for (int i = 0; i < flattened_count; i++) {
+        if (strcmp(flattened_systems[i], system_name) == 0) {
+            memmove(flattened_systems[i], flattened_systems[i + 1], (flattened_count - i - 1) * sizeof(flattened_systems[0]));
+            flattened_count--;
+            found = 1;
+            break;
+        }
+    }
+    if (!found) {
+        if (flattened_count >= MAX_FLATTENED_SYSTEMS) return;
+        strcpy(flattened_systems[flattened_count++], system_name);
+    }
+
+    FILE *fp = fopen(FLATTEN_FILE, "w");
+    if (!fp) return;
+    for (int i = 0; i < flattened_count; i++) {
+        fprintf(fp, "%s\n", flattened_systems[i]);
+    }
+    fclose(fp);
+}
+
+// A .zip worth opening as a folder: more than one member, in a system whose
+// core does not load zips natively (arcade sets are always launched whole).
+// The count comes from the archive's own index once it has been opened, so
+// the central directory is only read the first time.
+static int is_browsable_archive(const char *path) {
+    char system_folder[256];
+    if (!zip_is_archive_name(path) ||
+        !get_system_folder(path, system_folder, sizeof(system_folder)) ||
+        systems_loads_archives(system_folder)) {
+        return 0;
+    }
+    ExtensionFilter filter;
+    systems_get_extension_filter(system_folder, &filter);
+    return dirindex_archive_count(path, &filter) > 1;
+}
+
+// Human-readable size for list details ("512B", "64K", "3.2M")
+static void format_file_size(uint32_t size, char *text, size_t text_size) {
+    if (size < 1024) {
+        snprintf(text, text_size, "%uB", (unsigned)size);
+    } else if (size < 1024 * 1024) {
+        snprintf(text, text_size, "%uK", (unsigned)((size + 512) / 1024));
+    } else {
+        unsigned tenths = (unsigned)(((uint64_t)size * 10 + 512 * 1024) / (1024 * 1024));
+        snprintf(text, text_size, "%u.%uM", tenths / 10, tenths % 10);
+    }
+}
+
+// Sort entries[first..first+count) by their precomputed collation keys.
+// Only small key/index pairs are sorted; each MenuEntry is moved once at the end.
+static void sort_entries(int first, int count) {
+    if (count < 2) return;
+
+    CollateItem *items = (CollateItem*)malloc(count * sizeof(CollateItem));
+    if (!items) return;
+
+    for (int i = 0; i < count; i++) {
+        items[i].key = entries[first + i].sort_key;
+        items[i].name = entries[first + i].name;
+        items[i].index = i;
+    }
+
+    collate_sort(items, count);
+
+    // Apply the permutation in place by following its cycles
+    // (index is set to -1 once a slot holds its final entry)
+    MenuEntry *base = entries + first;
+    for (int start = 0; start < count; start++) {
+        if (items[start].index < 0 || items[start].index == start) continue;
+
+        MenuEntry held = base[start];
+        int slot = start;
+        while (1) {
+            int source = items[slot].index;
+            items[slot].index = -1;
+            if (source == start) {
+                base[slot] = held;
+                break;
+            }
+            base[slot] = base[source];
+            slot = source;
+        }
+    }
+
+    free(items);
 }
 
 // Show recent games list
 static void show_recent_games(void) {
-    entry_count = 0;
+    clear_entries();
     reset_navigation_state();
     
     // Set current_path so thumbnail loading knows we're in recent games mode
@@ -569,6 +1028,8 @@ static void show_recent_games(void) {
     
     // Clear thumbnail cache when switching to recent games mode
     thumbnail_cache_valid = 0;
+    thumbnail_cache_recheck();
+    thumbnail_cache_mixed_folders(1);
 
     const RecentGame* recent_list = recent_games_get_list();
     int recent_count = recent_games_get_count();
@@ -579,15 +1040,16 @@ static void show_recent_games(void) {
         strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
         strncpy(entries[entry_count].path, ROMS_PATH, sizeof(entries[entry_count].path) - 1);
         entries[entry_count].is_dir = 1;
+        entries[entry_count].rom_count = -1;
         entry_count++;
     } else {
         // Add recent games first
         ensure_entries_capacity(entry_count + recent_count + 1);
         for (int i = 0; i < recent_count; i++) {
             strncpy(entries[entry_count].name, recent_list[i].display_name, sizeof(entries[entry_count].name) - 1);
-            snprintf(entries[entry_count].path, sizeof(entries[entry_count].path),
-                    "%s;%s", recent_list[i].core_name, recent_list[i].game_name);
+            strncpy(entries[entry_count].path, recent_list[i].game_name, sizeof(entries[entry_count].path) - 1);
             entries[entry_count].is_dir = 0;
+            entries[entry_count].rom_count = -1;
             entry_count++;
         }
 
@@ -595,6 +1057,7 @@ static void show_recent_games(void) {
         strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
         strncpy(entries[entry_count].path, ROMS_PATH, sizeof(entries[entry_count].path) - 1);
         entries[entry_count].is_dir = 1;
+        entries[entry_count].rom_count = -1;
         entry_count++;
     }
     
@@ -605,7 +1068,7 @@ static void show_recent_games(void) {
 
 // Show favorites
 static void show_favorites(void) {
-    entry_count = 0;
+    clear_entries();
     reset_navigation_state();
 
     // Set current_path so thumbnail loading knows we're in favorites mode
@@ -614,6 +1077,8 @@ static void show_favorites(void) {
 
     // Clear thumbnail cache when switching to favorites mode
     thumbnail_cache_valid = 0;
+    thumbnail_cache_recheck();
+    thumbnail_cache_mixed_folders(1);
 
     const FavoriteGame* favorites_list = favorites_get_list();
     int favorites_count = favorites_get_count();
@@ -624,15 +1089,16 @@ static void show_favorites(void) {
         strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
         strncpy(entries[entry_count].path, ROMS_PATH, sizeof(entries[entry_count].path) - 1);
         entries[entry_count].is_dir = 1;
+        entries[entry_count].rom_count = -1;
         entry_count++;
     } else {
         // Add favorites first
         ensure_entries_capacity(entry_count + favorites_count + 1);
         for (int i = 0; i < favorites_count; i++) {
             strncpy(entries[entry_count].name, favorites_list[i].display_name, sizeof(entries[entry_count].name) - 1);
-            snprintf(entries[entry_count].path, sizeof(entries[entry_count].path),
-                    "%s;%s", favorites_list[i].core_name, favorites_list[i].game_name);
+            strncpy(entries[entry_count].path, favorites_list[i].game_name, sizeof(entries[entry_count].path) - 1);
             entries[entry_count].is_dir = 0;
+            entries[entry_count].rom_count = -1;
             entry_count++;
         }
 
@@ -640,6 +1106,7 @@ static void show_favorites(void) {
         strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
         strncpy(entries[entry_count].path, ROMS_PATH, sizeof(entries[entry_count].path) - 1);
         entries[entry_count].is_dir = 1;
+        entries[entry_count].rom_count = -1;
         entry_count++;
     }
 
@@ -650,7 +1117,7 @@ static void show_favorites(void) {
 
 // Show tools menu
 static void show_tools_menu(void) {
-    entry_count = 0;
+    clear_entries();
     reset_navigation_state();
 
     // Set current_path for tools mode
@@ -667,24 +1134,28 @@ static void show_tools_menu(void) {
     strncpy(entries[entry_count].name, "Hotkeys", sizeof(entries[entry_count].name) - 1);
     strncpy(entries[entry_count].path, "HOTKEYS", sizeof(entries[entry_count].path) - 1);
     entries[entry_count].is_dir = 1;
+    entries[entry_count].rom_count = -1;
     entry_count++;
 
     // Add Credits entry
     strncpy(entries[entry_count].name, "Credits", sizeof(entries[entry_count].name) - 1);
     strncpy(entries[entry_count].path, "CREDITS", sizeof(entries[entry_count].path) - 1);
     entries[entry_count].is_dir = 1;
+    entries[entry_count].rom_count = -1;
     entry_count++;
 
     // Add Utils entry
     strncpy(entries[entry_count].name, "Utils", sizeof(entries[entry_count].name) - 1);
     strncpy(entries[entry_count].path, "UTILS", sizeof(entries[entry_count].path) - 1);
     entries[entry_count].is_dir = 1;
+    entries[entry_count].rom_count = -1;
     entry_count++;
 
     // Add back entry
     strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
     strncpy(entries[entry_count].path, ROMS_PATH, sizeof(entries[entry_count].path) - 1);
     entries[entry_count].is_dir = 1;
+    entries[entry_count].rom_count = -1;
     entry_count++;
 
     // Load thumbnail for initially selected item AND reset last_selected_index to prevent duplicate loading
@@ -694,7 +1165,7 @@ static void show_tools_menu(void) {
 
 // Show utils menu with js2000 files
 static void show_utils_menu(void) {
-    entry_count = 0;
+    clear_entries();
     reset_navigation_state();
     
     // Set current_path for utils mode
@@ -723,6 +1194,7 @@ static void show_utils_menu(void) {
                 strncpy(entries[entry_count].name, ent->d_name, sizeof(entries[entry_count].name) - 1);
                 strncpy(entries[entry_count].path, full_path, sizeof(entries[entry_count].path) - 1);
                 entries[entry_count].is_dir = S_ISDIR(st.st_mode);
+                entries[entry_count].rom_count = -1;
                 entry_count++;
             }
         }
@@ -734,6 +1206,7 @@ static void show_utils_menu(void) {
     strncpy(entries[entry_count].name, "Rebuild folder cache", sizeof(entries[entry_count].name) - 1);
     strncpy(entries[entry_count].path, "REBUILD_CACHE", sizeof(entries[entry_count].path) - 1);
     entries[entry_count].is_dir = 0;
+    entries[entry_count].rom_count = -1;
     entry_count++;
 
     // Add back entry
@@ -741,6 +1214,7 @@ static void show_utils_menu(void) {
     strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
     strncpy(entries[entry_count].path, "TOOLS", sizeof(entries[entry_count].path) - 1);
     entries[entry_count].is_dir = 1;
+    entries[entry_count].rom_count = -1;
     entry_count++;
     
     // Load thumbnail for initially selected item
@@ -756,7 +1230,7 @@ static void show_hotkeys_screen(void) {
 
     // Clear thumbnail cache and entries for hotkeys mode
     thumbnail_cache_valid = 0;
-    entry_count = 0;
+    clear_entries();
     reset_navigation_state();
 }
 
@@ -768,7 +1242,7 @@ static void show_credits_screen(void) {
     
     // Clear thumbnail cache and entries for credits mode
     thumbnail_cache_valid = 0;
-    entry_count = 0;
+    clear_entries();
     reset_navigation_state();
 }
 
@@ -777,8 +1251,10 @@ static void scan_directory(const char *path) {
     DIR *dir;
     struct dirent *ent;
 
-    entry_count = 0;
+    clear_entries();
     reset_navigation_state();
+    thumbnail_cache_recheck();
+    thumbnail_cache_mixed_folders(0);
 
     // Store whether we're at root for recent games insertion later
     int is_root = (strcmp(path, ROMS_PATH) == 0);
@@ -789,14 +1265,69 @@ static void scan_directory(const char *path) {
         strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
         strncpy(entries[entry_count].path, path, sizeof(entries[entry_count].path) - 1);
         entries[entry_count].is_dir = 1;
+        entries[entry_count].rom_count = -1;
         entry_count++;
     }
 
+    // Only files the system's core can load are listed (saves, readmes, BIOS are skipped)
+    ExtensionFilter ext_filter;
+    char system_folder[256];
+    int in_system = get_system_folder(path, system_folder, sizeof(system_folder));
+    systems_get_extension_filter(in_system ? system_folder : NULL, &ext_filter);
+
+    // Clean titles for indexed lists come from the system's metadata table
+    list_metadata = in_system && metadb_open(system_folder);
+
+    // Zip archives list their members from the central directory (via the
+    // same index); there is no folder to fall back to
+    if (!is_root && zip_is_archive_name(path)) {
+        if (dirindex_open(path, &ext_filter)) {
+            attach_directory_index();
+            list_archive = 1;
+        }
+        build_az_buckets();
+        thumbnail_cache_valid = 0;
+        last_selected_index = -1;
+        return;
+    }
+
+    // Flattened systems list their whole tree; while its index is built the
+    // list holds just ".." and retro_run advances the build every frame
+    if (!is_root && !skip_flatten_once && is_system_flattened(path)) {
+        int opened = dirindex_open_tree(path, &ext_filter);
+        if (opened >= 0) {
+            list_tree = 1;
+            tree_build_active = (opened == 0);
+            if (opened) {
+                attach_directory_index();
+            }
+            build_az_buckets();
+            thumbnail_cache_valid = 0;
+            last_selected_index = -1;
+            return;
+        }
+    }
+    skip_flatten_once = 0;
+
+    // ROM folders are browsed through their directory index; the full scan
+    // below is only the fallback when no index can be written
+    if (!is_root && dirindex_open(path, &ext_filter)) {
+        attach_directory_index();
+        build_az_buckets();
+        thumbnail_cache_valid = 0;
+        last_selected_index = -1;
+        return;
+    }
+
     dir = opendir(path);
     if (!dir) {
         return;
     }
 
+    // Hide empty system folders unless disabled (default to hiding if setting not found)
+    const char *hide_empty_setting = settings_get_value("frogui_hide_empty");
+    int hide_empty = !hide_empty_setting || strcmp(hide_empty_setting, "true") == 0;
+
     // Collect all entries in a single pass - optimized
     while ((ent = readdir(dir)) != NULL) {
         if (ent->d_name[0] == '.') continue;  // Skip hidden files
@@ -806,6 +1337,13 @@ static void scan_directory(const char *path) {
             continue;
         }
 
+        // Extension test runs on d_name before any copying; folders always pass
+        int wrong_extension = 0;
+        if (ent->d_type != DT_DIR && !systems_extension_allowed(&ext_filter, ent->d_name)) {
+            if (ent->d_type != DT_UNKNOWN) continue;  // Known to be a file
+            wrong_extension = 1;                      // Decided after the stat below
+        }
+
         // Save entry name and type BEFORE any nested readdir calls (readdir uses static buffer)
         char entry_name[256];
         strncpy(entry_name, ent->d_name, sizeof(entry_name) - 1);
@@ -822,16 +1360,20 @@ static void scan_directory(const char *path) {
         if (is_root && !is_dir) {
             continue;
         }
+        if (wrong_extension && !is_dir) {
+            continue;
+        }
 
-        // Skip empty directories in root ROMS directory (use cache for speed)
+        // System folders in the root: the library catalog's folder stats
+        // give the game count and hide empty folders with no extra I/O
+        int rom_count = -1;
         if (is_root && is_dir) {
-            const char *hide_empty = settings_get_value("frogui_hide_empty");
-            if (!hide_empty || strcmp(hide_empty, "true") == 0) {
-                // Load cache on first use (default to hiding if setting not found)
-                load_empty_dirs_cache();
-                if (is_in_empty_cache(entry_name)) {
-                    continue; // Skip cached empty directory
+            const LibrarySystem *stats = library_get_system(library_find_system(entry_name));
+            if (stats) {
+                if (hide_empty && stats->rom_count == 0 && stats->subdir_count == 0) {
+                    continue; // Skip empty system folder
                 }
+                rom_count = stats->rom_count;
             }
         }
 
@@ -844,26 +1386,29 @@ static void scan_directory(const char *path) {
             strncpy(entries[entry_count].name, entry_name, sizeof(entries[entry_count].name) - 1);
             strncpy(entries[entry_count].path, full_path, sizeof(entries[entry_count].path) - 1);
             entries[entry_count].is_dir = 1;
-            entry_count++;
         } else {
             // Add file entry
             strncpy(entries[entry_count].name, entry_name, sizeof(entries[entry_count].name) - 1);
             strncpy(entries[entry_count].path, full_path, sizeof(entries[entry_count].path) - 1);
             entries[entry_count].is_dir = 0;
-            entry_count++;
         }
+        entries[entry_count].rom_count = rom_count;
+        entries[entry_count].sort_key = collate_key(entry_name);
+        entry_count++;
     }
 
     // Close the directory after reading
     closedir(dir);
 
-    // Sort all entries alphabetically by name
-    qsort(entries, entry_count, sizeof(MenuEntry), compare_entries);
+    // Sort entries alphabetically (case-insensitive, natural numbers),
+    // keeping ".." pinned at the top
+    int first_sorted = is_root ? 0 : 1;
+    sort_entries(first_sorted, entry_count - first_sorted);
 
     // Add Recent games at the very top if in root directory
     if (is_root) {
-        // Ensure we have space for 4 more entries (Recent games, Favorites, Random game, Tools)
-        ensure_entries_capacity(entry_count + 4);
+        // Ensure we have space for 5 more entries (Recent games, Favorites, Random game, Search, Tools)
+        ensure_entries_capacity(entry_count + 5);
 
         // Shift all entries down by 1 to make room for Recent games at index 0
         for (int i = entry_count; i > 0; i--) {
@@ -874,6 +1419,7 @@ static void scan_directory(const char *path) {
         strncpy(entries[0].name, "Recent games", sizeof(entries[0].name) - 1);
         strncpy(entries[0].path, "RECENT_GAMES", sizeof(entries[0].path) - 1);
         entries[0].is_dir = 1;
+        entries[0].rom_count = -1;
         entry_count++;
 
         // Shift entries down by 1 more to make room for Favorites
@@ -885,6 +1431,7 @@ static void scan_directory(const char *path) {
         strncpy(entries[1].name, "Favorites", sizeof(entries[1].name) - 1);
         strncpy(entries[1].path, "FAVORITES", sizeof(entries[1].path) - 1);
         entries[1].is_dir = 1;
+        entries[1].rom_count = -1;
         entry_count++;
 
         // Shift entries down by 1 more to make room for Random Game
@@ -896,15 +1443,32 @@ static void scan_directory(const char *path) {
         strncpy(entries[2].name, "Random game", sizeof(entries[2].name) - 1);
         strncpy(entries[2].path, "RANDOM_GAME", sizeof(entries[2].path) - 1);
         entries[2].is_dir = 1;
+        entries[2].rom_count = -1;
+        entry_count++;
+
+        // Shift entries down by 1 more to make room for Search
+        for (int i = entry_count; i > 3; i--) {
+            entries[i] = entries[i - 1];
+        }
+
+        // Insert Search at position 3 (right after Random game)
+        strncpy(entries[3].name, "Search", sizeof(entries[3].name) - 1);
+        strncpy(entries[3].path, "SEARCH", sizeof(entries[3].path) - 1);
+        entries[3].is_dir = 1;
+        entries[3].rom_count = -1;
         entry_count++;
 
         // Add Tools at the bottom
         strncpy(entries[entry_count].name, "Tools", sizeof(entries[entry_count].name) - 1);
         strncpy(entries[entry_count].path, "TOOLS", sizeof(entries[entry_count].path) - 1);
         entries[entry_count].is_dir = 1;
+        entries[entry_count].rom_count = -1;
         entry_count++;
     }
 
+    // Rebuild the quick jump table for the final entry order
+    build_az_buckets();
+
     // Defer thumbnail loading to first render for faster boot
     // The render loop will handle loading thumbnails on the first frame
     thumbnail_cache_valid = 0;
@@ -1072,13 +1636,21 @@ static void render_menu() {
         return;
     }
 
+    // Favorites are keyed by folder ID - resolved once per frame, not per row
+    SystemId folder_system = systems_lookup(get_basename(current_path));
+
     // Draw header with current folder name
     const char *display_path = current_path;
     if (strcmp(current_path, ROMS_PATH) == 0) {
         display_path = "FROGUI: SYSTEMS";  // Marketing branding
     } else {
-        // Show just the folder name, not full path
+        // Show just the folder name, not full path; system folders get their
+        // registry display name
         display_path = get_basename(current_path);
+        const SystemInfo *system = systems_get(folder_system);
+        if (system && system->display_name && display_path == current_path + strlen(ROMS_PATH) + 1) {
+            display_path = system->display_name;
+        }
     }
     render_header(framebuffer, display_path);
 
@@ -1092,42 +1664,116 @@ static void render_menu() {
     // Load and display thumbnail for selected item FIRST (background layer)
     // Only reload if selection changed
     if (last_selected_index != selected_index) {
-        load_current_thumbnail();
+        request_current_thumbnail();
         last_selected_index = selected_index;
         // Reset scrolling state for new selection
         text_scroll_frame_counter = 0;
         text_scroll_offset = 0;
         text_scroll_direction = 1;
+    } else {
+        if (thumb_rest_frames < THUMB_DEBOUNCE_FRAMES) thumb_rest_frames++;
+        if (thumb_pending_frames > 0 && --thumb_pending_frames == 0) {
+            load_current_thumbnail();
+        } else if (thumb_pending_frames == THUMB_DEBOUNCE_FRAMES - THUMB_PREVIEW_FRAMES) {
+            load_current_preview();
+        }
     }
     
     if (thumbnail_cache_valid) {
         render_thumbnail(framebuffer, &current_thumbnail);
     }
 
+    // System icons beside the root list rows when there is an atlas
+    int root_icons = sysicons_width() > 0 && strcmp(current_path, ROMS_PATH) == 0;
+
     // Draw menu entries ON TOP of thumbnail
     for (int i = scroll_offset; i < entry_count && i < scroll_offset + VISIBLE_ENTRIES; i++) {
-        // Get display name (with scrolling for selected item)
+        const MenuEntry *entry = list_get(i);
+        const GameInfo *info = entry_info(entry);
+
+        // Get display name (with scrolling for selected item), the clean title if known
         char display_name[MAX_FILENAME_DISPLAY_LEN + 4];
-        get_scrolling_text(entries[i].name, (i == selected_index), display_name, sizeof(display_name));
+        get_scrolling_text(info ? info->title : entry->name, (i == selected_index), display_name, sizeof(display_name));
 
         // Check if this item is favorited
         int is_favorited = 0;
-        if (!entries[i].is_dir &&
+        if (!entry->is_dir && !list_archive &&
             strcmp(current_path, ROMS_PATH) != 0 &&
             strcmp(current_path, "RECENT_GAMES") != 0 &&
             strcmp(current_path, "FAVORITES") != 0 &&
+            strcmp(current_path, "SEARCH") != 0 &&
             strcmp(current_path, "TOOLS") != 0 &&
             strcmp(current_path, "UTILS") != 0 &&
             strcmp(current_path, "HOTKEYS") != 0 &&
             strcmp(current_path, "CREDITS") != 0) {
-            const char *core_name = get_basename(current_path);
-            const char *filename_path = strrchr(entries[i].path, '/');
-            const char *filename = filename_path ? filename_path + 1 : entries[i].name;
-            is_favorited = favorites_is_favorited(core_name, filename);
+            is_favorited = folder_system != SYSTEM_ID_NONE &&
+                           favorites_is_favorited(folder_system, entry_game_name(entry));
+        }
+
+        int icon = SYSICON_NONE;
+        if (root_icons) {
+            icon = sysicons_find(get_basename(entry->path));
+            if (icon == SYSICON_NONE) icon = SYSICON_BLANK;
+        }
+
+        int item_right = render_menu_item(framebuffer, i, display_name, entry->is_dir,
+                                          (i == selected_index), scroll_offset, is_favorited, icon);
+
+        // Game count beside system folders (root list only), member size in archives
+        if (entry->rom_count >= 0) {
+            char count_text[16];
+            snprintf(count_text, sizeof(count_text), "%d", entry->rom_count);
+            render_menu_item_detail(framebuffer, i, scroll_offset, count_text, item_right);
+        } else if (list_archive && !entry->is_dir) {
+            char size_text[16];
+            format_file_size(entry->size, size_text, sizeof(size_text));
+            render_menu_item_detail(framebuffer, i, scroll_offset, size_text, item_right);
+        } else if (!entry->is_dir && strcmp(current_path, "SEARCH") == 0) {
+            // Search results come from every system - show which one
+            char system_folder[MAX_PATH_LEN];
+            strncpy(system_folder, entry->path, sizeof(system_folder) - 1);
+            system_folder[sizeof(system_folder) - 1] = '\0';
+            char *slash = strrchr(system_folder, '/');
+            if (slash) *slash = '\0';
+            render_menu_item_detail(framebuffer, i, scroll_offset, get_basename(system_folder), item_right);
+        } else if (list_tree && !entry->is_dir) {
+            // Flattened systems show which subfolder each ROM is in
+            const char *game_name = entry_game_name(entry);
+            const char *slash = strrchr(game_name, '/');
+            if (slash) {
+                char subfolder[MAX_PATH_LEN];
+                snprintf(subfolder, sizeof(subfolder), "%.*s", (int)(slash - game_name), game_name);
+                render_menu_item_detail(framebuffer, i, scroll_offset, subfolder, item_right);
+            }
+        } else if (info && i == selected_index && (info->region[0] || info->year)) {
+            // Region and year of the selected game, from its metadata
+            char release_text[48];
+            if (info->region[0] && info->year) {
+                snprintf(release_text, sizeof(release_text), "%s %d", info->region, info->year);
+            } else if (info->region[0]) {
+                snprintf(release_text, sizeof(release_text), "%s", info->region);
+            } else {
+                snprintf(release_text, sizeof(release_text), "%d", info->year);
+            }
+            render_menu_item_detail(framebuffer, i, scroll_offset, release_text, item_right);
         }
+    }
 
-        render_menu_item(framebuffer, i, display_name, entries[i].is_dir,
-                        (i == selected_index), scroll_offset, is_favorited);
+    // Tree index of a flattened system still being built
+    if (tree_build_active) {
+        char progress[48];
+        snprintf(progress, sizeof(progress), "Indexing subfolders... %d", dirindex_build_progress());
+        int progress_width = font_measure_text(progress);
+        render_text_pillbox(framebuffer, (SCREEN_WIDTH - progress_width) / 2, (SCREEN_HEIGHT - FONT_CHAR_HEIGHT) / 2,
+                            progress, theme_header(), theme_bg(), 6);
+    }
+
+    // Notice for something the last action could not do, for a moment
+    if (list_notice_frames > 0) {
+        list_notice_frames--;
+        int notice_width = font_measure_text(list_notice);
+        render_text_pillbox(framebuffer, (SCREEN_WIDTH - notice_width) / 2, (SCREEN_HEIGHT - FONT_CHAR_HEIGHT) / 2,
+                            list_notice, theme_header(), theme_bg(), 6);
     }
 
     // Draw legend - determine X button mode based on current view
@@ -1135,8 +1781,10 @@ static void render_menu() {
     if (strcmp(current_path, "FAVORITES") == 0) {
         // In favorites menu, show "X - REMOVE"
         x_button_mode = LEGEND_X_REMOVE;
-    } else if (strcmp(current_path, ROMS_PATH) != 0 &&
+    } else if (!list_archive &&
+               strcmp(current_path, ROMS_PATH) != 0 &&
                strcmp(current_path, "RECENT_GAMES") != 0 &&
+               strcmp(current_path, "SEARCH") != 0 &&
                strcmp(current_path, "TOOLS") != 0 &&
                strcmp(current_path, "UTILS") != 0 &&
                strcmp(current_path, "HOTKEYS") != 0 &&
@@ -1191,103 +1839,290 @@ static void render_menu() {
             if (i == az_selected_index) {
                 render_text_pillbox(framebuffer, x, y, labels[i], COLOR_SELECT_BG, COLOR_SELECT_TEXT, 6);
             } else {
-                font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, x, y, labels[i], COLOR_TEXT);
+                // Grey out letters with no entries
+                uint16_t color = az_bucket_size[i] > 0 ? COLOR_TEXT : COLOR_DISABLED;
+                font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, x, y, labels[i], color);
             }
         }
+
+        // Show how many entries the selected letter holds
+        char count_label[32];
+        int bucket_size = az_bucket_size[az_selected_index];
+        snprintf(count_label, sizeof(count_label), "%d %s", bucket_size, bucket_size == 1 ? "entry" : "entries");
+        int count_width = font_measure_text(count_label);
+        font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, (SCREEN_WIDTH - count_width) / 2,
+                       grid_start_y + 4 * row_height, count_label, COLOR_HEADER);
     }
-}
 
-// Pick and launch a random game by randomly navigating the menu
-static void pick_random_game(void) {
-    int max_attempts = 100;
-    int attempts = 0;
+    // Draw filter keyboard over the lower part of the list (top matches stay visible)
+    if (filter_keyboard_active) {
+        int col_width = 29;
+        int row_height = 18;
+        int box_x = 6;
+        int box_height = 32 + FILTER_KEY_ROWS * row_height + 6;   // Text line, key rows
+        int box_y = SCREEN_HEIGHT - box_height - 4;
+        int box_width = SCREEN_WIDTH - 12;
+        render_fill_rect(framebuffer, box_x, box_y, box_width, box_height, COLOR_BG);
 
-    while (attempts < max_attempts) {
-        attempts++;
+        // Text with cursor (its tail when long), match count on the right
+        const char *text = file_rename_active ? file_rename_text : filter_query;
+        int text_len = strlen(text);
+        char query_label[FILTER_QUERY_MAX + 8];
+        snprintf(query_label, sizeof(query_label), "%s_", text + (text_len > FILTER_QUERY_MAX ? text_len - FILTER_QUERY_MAX : 0));
+        render_text_pillbox(framebuffer, box_x + 8, box_y + 6, query_label, COLOR_SELECT_BG, COLOR_SELECT_TEXT, 6);
+
+        // The search screen always ends with ".."
+        int found = strcmp(current_path, "SEARCH") == 0 ? entry_count - 1 : entry_count;
+        char match_label[24];
+        if (file_rename_active) {
+            snprintf(match_label, sizeof(match_label), "RENAME");
+        } else {
+            snprintf(match_label, sizeof(match_label), "%d found", found);
+        }
+        int match_width = font_measure_text(match_label);
+        font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, box_x + box_width - match_width - 8,
+                       box_y + 6, match_label, (found > 0 || file_rename_active) ? COLOR_HEADER : COLOR_DISABLED);
 
-        // Pick a random console directory from root
-        strncpy(current_path, ROMS_PATH, sizeof(current_path) - 1);
-        scan_directory(current_path);
+        int grid_x = box_x + 14;
+        int grid_y = box_y + 32;
 
-        // Filter out non-console entries
-        int valid_console_count = 0;
-        for (int i = 0; i < entry_count; i++) {
-            if (entries[i].is_dir &&
-                strcmp(entries[i].path, "RECENT_GAMES") != 0 &&
-                strcmp(entries[i].path, "FAVORITES") != 0 &&
-                strcmp(entries[i].path, "RANDOM_GAME") != 0 &&
-                strcmp(entries[i].path, "TOOLS") != 0) {
-                valid_console_count++;
+        for (int i = 0; i < FILTER_KEY_SPACE; i++) {
+            char key_label[2] = { filter_key_chars[i], '\0' };
+            if (keyboard_lowercase && key_label[0] >= 'A' && key_label[0] <= 'Z') {
+                key_label[0] += 'a' - 'A';
+            }
+            int x = grid_x + (i % FILTER_KEY_COLUMNS) * col_width;
+            int y = grid_y + (i / FILTER_KEY_COLUMNS) * row_height;
+            if (i == filter_key_index) {
+                render_text_pillbox(framebuffer, x, y, key_label, COLOR_SELECT_BG, COLOR_SELECT_TEXT, 4);
+            } else {
+                font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, x, y, key_label, COLOR_TEXT);
             }
         }
 
-        if (valid_console_count == 0) {
-            strncpy(current_path, ROMS_PATH, sizeof(current_path) - 1);
-            scan_directory(current_path);
-            return;
+        // Bottom row of wide keys, aligned under columns 0, 4 and 7
+        const char *wide_labels[] = { "SPACE", "DEL", "DONE" };
+        const int wide_columns[] = { 0, 4, 7 };
+        for (int i = 0; i < 3; i++) {
+            int x = grid_x + wide_columns[i] * col_width;
+            int y = grid_y + (FILTER_KEY_ROWS - 1) * row_height;
+            if (FILTER_KEY_SPACE + i == filter_key_index) {
+                render_text_pillbox(framebuffer, x, y, wide_labels[i], COLOR_SELECT_BG, COLOR_SELECT_TEXT, 4);
+            } else {
+                font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, x, y, wide_labels[i], COLOR_TEXT);
+            }
         }
+    }
 
-        // Pick a random console directory
-        int random_console = rand() % valid_console_count;
-        int console_idx = 0;
-        for (int i = 0; i < entry_count; i++) {
-            if (entries[i].is_dir &&
-                strcmp(entries[i].path, "RECENT_GAMES") != 0 &&
-                strcmp(entries[i].path, "FAVORITES") != 0 &&
-                strcmp(entries[i].path, "RANDOM_GAME") != 0 &&
-                strcmp(entries[i].path, "TOOLS") != 0) {
-                if (console_idx == random_console) {
-                    strncpy(current_path, entries[i].path, sizeof(current_path) - 1);
-                    break;
+    // Draw file actions menu for the selected ROM
+    if (file_menu_active) {
+        int box_width = 240;
+        int box_height = 100;
+        int box_x = (SCREEN_WIDTH - box_width) / 2;
+        int box_y = (SCREEN_HEIGHT - box_height) / 2;
+        render_fill_rect(framebuffer, box_x, box_y, box_width, box_height, COLOR_BG);
+
+        const char *title = file_delete_confirm ? "DELETE FILE?" :
+                            file_menu_actions[0] == FILE_ACTION_FLATTEN ? "VIEW" : "FILE";
+        int title_width = font_measure_text(title);
+        render_text_pillbox(framebuffer, (SCREEN_WIDTH - title_width) / 2, box_y + 8, title,
+                            COLOR_SELECT_BG, COLOR_SELECT_TEXT, 6);
+
+        char name_label[MAX_FILENAME_DISPLAY_LEN + 4];
+        get_scrolling_text(file_action_name, 1, name_label, sizeof(name_label));
+        font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, box_x + 12, box_y + 36, name_label, COLOR_HEADER);
+
+        if (file_delete_confirm) {
+            font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, box_x + 12, box_y + 64,
+                           "A: DELETE   B: CANCEL", COLOR_TEXT);
+        } else {
+            const char *labels[FILE_ACTION_COUNT] = { "Rename", "Delete", list_tree ? "Folders" : "Flatten" };
+            for (int i = 0; i < file_menu_action_count; i++) {
+                const char *label = labels[file_menu_actions[i]];
+                int x = box_x + 12 + i * ((box_width - 24) / file_menu_action_count);
+                if (i == file_menu_index) {
+                    render_text_pillbox(framebuffer, x, box_y + 64, label, COLOR_SELECT_BG, COLOR_SELECT_TEXT, 6);
+                } else {
+                    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, x, box_y + 64, label, COLOR_TEXT);
                 }
-                console_idx++;
             }
         }
+    }
+}
+
+// System folder name when current_path is directly under the ROMs root, else NULL
+static const char *current_system_name(void) {
+    size_t root_len = strlen(ROMS_PATH);
+    if (strncmp(current_path, ROMS_PATH "/", root_len + 1) != 0) return NULL;
+    const char *name = current_path + root_len + 1;
+    return strchr(name, '/') ? NULL : name;
+}
 
-        // Scan the console directory
+// Advance the tree index build of a flattened system by one slice, and list
+// the tree once it is open (or the folder itself if the build failed)
+static void step_tree_build(void) {
+    int result = dirindex_build_step(TREE_BUILD_SLICE);
+    if (result == 0) return;
+
+    tree_build_active = 0;
+    if (result > 0) {
+        attach_directory_index();
+        build_az_buckets();
+        last_selected_index = -1;
+    } else {
+        skip_flatten_once = 1;
         scan_directory(current_path);
+    }
+}
 
-        // Count files (not directories, not ..)
-        int file_count = 0;
-        for (int i = 0; i < entry_count; i++) {
-            if (!entries[i].is_dir && strcmp(entries[i].name, "..") != 0) {
-                file_count++;
-            }
-        }
+// Pick up a changed directory index without rescanning, selecting position
+static void refresh_after_file_change(int position) {
+    entry_count = list_fixed_count + dirindex_count();
+    for (int i = 0; i < LIST_WINDOW_SIZE; i++) {
+        list_window_index[i] = -1;
+    }
+    build_az_buckets();
 
-        if (file_count == 0) {
-            continue;
-        }
+    selected_index = position < entry_count ? position : entry_count - 1;
+    if (selected_index < 0) selected_index = 0;
+    if (selected_index < scroll_offset) {
+        scroll_offset = selected_index;
+    } else if (selected_index >= scroll_offset + VISIBLE_ENTRIES) {
+        scroll_offset = selected_index - VISIBLE_ENTRIES + 1;
+    }
+    last_selected_index = -1;
+}
 
-        // Pick a random file
-        int random_file = rand() % file_count;
-        int file_idx = 0;
-        for (int i = 0; i < entry_count; i++) {
-            if (!entries[i].is_dir && strcmp(entries[i].name, "..") != 0) {
-                if (file_idx == random_file) {
-                    const char *core_name = get_basename(current_path);
-                    const char *filename_path = strrchr(entries[i].path, '/');
-                    const char *filename = filename_path ? filename_path + 1 : entries[i].name;
+// Delete the file the actions menu was opened on and update every index in place
+static void delete_selected_file(void) {
+    char path[MAX_PATH_LEN];
+    int path_len = snprintf(path, sizeof(path), "%s/%s", current_path, file_action_name);
+    if (path_len < 0 || path_len >= (int)sizeof(path)) return;
+    if (remove(path) != 0) return;
 
-                    sprintf((char *)ptr_gs_run_game_file, "%s;%s;%s.gba", core_name, core_name, filename);
-                    sprintf((char *)ptr_gs_run_game_name, "%s", filename);
+    char thumb_path[MAX_PATH_LEN];
+    get_thumbnail_path(path, thumb_path, sizeof(thumb_path));
+    thumbnail_files_remove(thumb_path);
 
-                    char *dot_position = strrchr(ptr_gs_run_game_name, '.');
-                    if (dot_position != NULL) {
-                        *dot_position = '\0';
-                    }
+    SystemId folder_system = systems_lookup(get_basename(current_path));
+    if (favorites_is_favorited(folder_system, file_action_name)) {
+        favorites_toggle(folder_system, file_action_name, path);
+    }
+    recent_games_remove(folder_system, file_action_name);
 
-                    recent_games_add(core_name, filename, entries[i].path);
-                    game_queued = true;
-                    return;
-                }
-                file_idx++;
-            }
+    // Saved now so a power-off does not bring the game back
+    const char *system_name = current_system_name();
+    if (system_name && library_remove_rom(system_name, file_action_name)) {
+        library_save();
+    }
+
+    int position = dirindex_remove(file_action_name);
+    if (position < 0) {
+        // Index could not be updated - fall back to a rescan
+        scan_directory(current_path);
+        return;
+    }
+    refresh_after_file_change(list_fixed_count + position);
+}
+
+// Rename the file the actions menu was opened on to the typed name (the
+// extension is kept), with its thumbnail, and update every index in place
+static void rename_selected_file(void) {
+    int text_len = strlen(file_rename_text);
+    while (text_len > 0 && file_rename_text[text_len - 1] == ' ') {
+        file_rename_text[--text_len] = '\0';
+    }
+    if (text_len == 0) return;
+
+    const char *extension = strrchr(file_action_name, '.');
+    // Names longer than the entry names the menu keeps are refused, not cut
+    char new_name[sizeof(file_action_name)];
+    int name_len = snprintf(new_name, sizeof(new_name), "%s%s", file_rename_text, extension ? extension : "");
+    if (name_len < 0 || name_len >= (int)sizeof(new_name)) return;
+    if (strcmp(new_name, file_action_name) == 0) return;
+
+    char old_path[MAX_PATH_LEN];
+    char new_path[MAX_PATH_LEN];
+    int old_len = snprintf(old_path, sizeof(old_path), "%s/%s", current_path, file_action_name);
+    int new_len = snprintf(new_path, sizeof(new_path), "%s/%s", current_path, new_name);
+    if (old_len < 0 || old_len >= (int)sizeof(old_path)) return;
+    if (new_len < 0 || new_len >= (int)sizeof(new_path)) return;
+    if (access(new_path, F_OK) == 0) return;  // Never replace another file
+    if (rename(old_path, new_path) != 0) return;
+
+    char old_thumb[MAX_PATH_LEN];
+    char new_thumb[MAX_PATH_LEN];
+    get_thumbnail_path(old_path, old_thumb, sizeof(old_thumb));
+    get_thumbnail_path(new_path, new_thumb, sizeof(new_thumb));
+    thumbnail_files_rename(old_thumb, new_thumb);
+
+    SystemId folder_system = systems_lookup(get_basename(current_path));
+    if (favorites_is_favorited(folder_system, file_action_name)) {
+        favorites_toggle(folder_system, file_action_name, old_path);
+        favorites_toggle(folder_system, new_name, new_path);
+    }
+    recent_games_rename(folder_system, file_action_name, new_name, new_path);
+
+    const char *system_name = current_system_name();
+    if (system_name && library_rename_rom(system_name, file_action_name, new_name)) {
+        library_save();
+    }
+
+    int position = dirindex_rename(file_action_name, new_name);
+    if (position < 0) {
+        scan_directory(current_path);
+        position = list_find_name(new_name);
+        refresh_after_file_change(position < 0 ? 0 : position);
+        return;
+    }
+    refresh_after_file_change(list_fixed_count + position);
+}
+
+// Pick and launch a random game straight from the library catalog
+#define RANDOM_PICK_ATTEMPTS 8
+static void pick_random_game(void) {
+    const char *mode = settings_get_value("frogui_random_mode");
+    int per_system = mode && strcmp(mode, "per system") == 0;
+
+    // Only touch the card to confirm each pick still exists; the first
+    // missing one means the catalog is stale, so it is refreshed once
+    char rom_path[MAX_PATH_LEN];
+    int rom_index = -1;
+    int refreshed = 0;
+    for (int attempt = 0; attempt < RANDOM_PICK_ATTEMPTS; attempt++) {
+        rom_index = library_pick_random_rom(per_system);
+        if (rom_index < 0) break;
+        library_get_rom_path(rom_index, rom_path, sizeof(rom_path));
+        if (access(rom_path, F_OK) == 0) break;
+        rom_index = -1;
+        if (!refreshed) {
+            library_refresh(show_library_scan_screen);
+            refreshed = 1;
         }
     }
 
-    strncpy(current_path, ROMS_PATH, sizeof(current_path) - 1);
-    scan_directory(current_path);
+    if (rom_index < 0) {
+        strncpy(current_path, ROMS_PATH, sizeof(current_path) - 1);
+        scan_directory(current_path);
+        list_notice = "No game found to pick";
+        list_notice_frames = LIST_NOTICE_FRAMES;
+        return;
+    }
+
+    const LibraryRom *rom = library_get_rom(rom_index);
+    const char *core_name = library_get_system_name(rom->system_id);
+    const char *filename = library_get_rom_name(rom_index);
+
+    sprintf((char *)ptr_gs_run_game_file, "%s;%s;%s.gba", core_name, core_name, filename);
+    sprintf((char *)ptr_gs_run_game_name, "%s", filename);
+
+    char *dot_position = strrchr(ptr_gs_run_game_name, '.');
+    if (dot_position != NULL) {
+        *dot_position = '\0';
+    }
+
+    recent_games_add(systems_intern(core_name), filename, rom_path);
+    game_queued = true;
 }
 
 // Handle input
@@ -1312,6 +2147,7 @@ static void handle_input() {
     int l = input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_L);
     int r = input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_R);
     int select = input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_SELECT);
+    int start = input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_START);
 
     int left = input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_LEFT);
     int right = input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_RIGHT);
@@ -1332,6 +2168,7 @@ static void handle_input() {
         prev_input[8] = right;
         prev_input[9] = x;
         prev_input[10] = y;
+        prev_input[11] = start;
         return;
     }
 
@@ -1353,64 +2190,234 @@ static void handle_input() {
 
         // A button - select letter and jump
         if (prev_input[2] && !a) {
-            const char *search_chars[] = {
-                "A", "B", "C", "D", "E", "F", "G",
-                "H", "I", "J", "K", "L", "M", "N",
-                "O", "P", "Q", "R", "S", "T", "U",
-                "V", "W", "X", "Y", "Z", "0", ""
-            };
+            // Jump straight to the first entry of the bucket (stay put if empty)
+            int first = az_bucket_first[az_selected_index];
+            if (first >= 0 && first < entry_count) {
+                selected_index = first;
+            }
 
-            char first_char = search_chars[az_selected_index][0];
+            az_picker_active = 0;
+        }
 
-            // Find first entry starting with this letter (case insensitive)
-            for (int i = 0; i < entry_count; i++) {
-                char entry_first = entries[i].name[0];
-                if (entry_first >= 'a' && entry_first <= 'z') {
-                    entry_first = entry_first - 'a' + 'A'; // Convert to uppercase
-                }
+        // B button - cancel
+        if (prev_input[3] && !b) {
+            az_picker_active = 0;
+        }
 
-                // Handle 0-9 category
-                if (az_selected_index == 26 && entry_first >= '0' && entry_first <= '9') {
-                    selected_index = i;
-                    break;
+        // Update prev_input and return (picker consumed input)
+        prev_input[0] = up;
+        prev_input[1] = down;
+        prev_input[2] = a;
+        prev_input[3] = b;
+        prev_input[7] = left;
+        prev_input[8] = right;
+        return;
+    }
+
+    // Handle file actions menu input
+    if (file_menu_active) {
+        if (file_delete_confirm) {
+            if (prev_input[2] && !a) {
+                delete_selected_file();
+                file_menu_active = 0;
+            } else if (prev_input[3] && !b) {
+                file_menu_active = 0;
+            }
+        } else {
+            if ((prev_input[7] && !left) || (prev_input[0] && !up)) {
+                file_menu_index = (file_menu_index + file_menu_action_count - 1) % file_menu_action_count;
+            }
+            if ((prev_input[8] && !right) || (prev_input[1] && !down)) {
+                file_menu_index = (file_menu_index + 1) % file_menu_action_count;
+            }
+
+            if (prev_input[2] && !a) {
+                int action = file_menu_actions[file_menu_index];
+                if (action == FILE_ACTION_DELETE) {
+                    file_delete_confirm = 1;
+                } else if (action == FILE_ACTION_FLATTEN) {
+                    toggle_system_flattened(current_system_name());
+                    file_menu_active = 0;
+                    scan_directory(current_path);
+                } else {
+                    // Edit the name without its extension on the keyboard
+                    strncpy(file_rename_text, file_action_name, FILE_RENAME_MAX);
+                    file_rename_text[FILE_RENAME_MAX] = '\0';
+                    char *dot = strrchr(file_rename_text, '.');
+                    if (dot && dot != file_rename_text) *dot = '\0';
+
+                    file_menu_active = 0;
+                    file_rename_active = 1;
+                    filter_keyboard_active = 1;
+                    filter_key_index = 0;
                 }
-                // Handle # category (special characters)
-                else if (az_selected_index == 27 &&
-                         !((entry_first >= 'A' && entry_first <= 'Z') ||
-                           (entry_first >= '0' && entry_first <= '9'))) {
-                    selected_index = i;
-                    break;
+            } else if ((prev_input[3] && !b) || (prev_input[11] && !start)) {
+                file_menu_active = 0;
+            }
+        }
+
+        // Update prev_input and return (menu consumed input)
+        prev_input[0] = up;
+        prev_input[1] = down;
+        prev_input[2] = a;
+        prev_input[3] = b;
+        prev_input[7] = left;
+        prev_input[8] = right;
+        prev_input[11] = start;
+        return;
+    }
+
+    // Handle filter keyboard input
+    if (filter_keyboard_active) {
+        char *text = file_rename_active ? file_rename_text : filter_query;
+        int text_max = file_rename_active ? FILE_RENAME_MAX : FILTER_QUERY_MAX;
+        int query_len = strlen(text);
+        int query_changed = 0;
+        int in_search = strcmp(current_path, "SEARCH") == 0;
+
+        // Navigate the key grid; the bottom row holds three wide keys
+        if (prev_input[0] && !up) { // UP
+            if (filter_key_index == FILTER_KEY_SPACE) filter_key_index = FILTER_KEY_LAST_ROW;
+            else if (filter_key_index == FILTER_KEY_DELETE) filter_key_index = FILTER_KEY_LAST_ROW + 4;
+            else if (filter_key_index == FILTER_KEY_DONE) filter_key_index = FILTER_KEY_LAST_ROW + 7;
+            else if (filter_key_index >= FILTER_KEY_COLUMNS) filter_key_index -= FILTER_KEY_COLUMNS;
+        }
+        if (prev_input[1] && !down) { // DOWN
+            if (filter_key_index < FILTER_KEY_LAST_ROW) {
+                filter_key_index += FILTER_KEY_COLUMNS;
+            } else if (filter_key_index < FILTER_KEY_SPACE) {
+                int col = filter_key_index % FILTER_KEY_COLUMNS;
+                filter_key_index = col < 4 ? FILTER_KEY_SPACE : (col < 7 ? FILTER_KEY_DELETE : FILTER_KEY_DONE);
+            }
+        }
+        if (prev_input[7] && !left) { // LEFT
+            if (filter_key_index >= FILTER_KEY_SPACE) {
+                if (filter_key_index > FILTER_KEY_SPACE) filter_key_index--;
+            } else if (filter_key_index % FILTER_KEY_COLUMNS > 0) {
+                filter_key_index--;
+            }
+        }
+        if (prev_input[8] && !right) { // RIGHT
+            if (filter_key_index >= FILTER_KEY_SPACE) {
+                if (filter_key_index < FILTER_KEY_DONE) filter_key_index++;
+            } else if (filter_key_index % FILTER_KEY_COLUMNS < FILTER_KEY_COLUMNS - 1) {
+                filter_key_index++;
+            }
+        }
+
+        // L button - switch letter case
+        if (prev_input[4] && !l) {
+            keyboard_lowercase = !keyboard_lowercase;
+        }
+
+        // A button - type the key
+        if (prev_input[2] && !a) {
+            if (filter_key_index == FILTER_KEY_DONE) {
+                if (file_rename_active) {
+                    rename_selected_file();
+                    file_rename_active = 0;
+                    filter_keyboard_active = 0;
+                } else if (query_len == 0 && !in_search) {
+                    // Nothing typed = no filter
+                    close_filter();
+                } else {
+                    // Keep the matches on screen and browse them
+                    filter_keyboard_active = 0;
                 }
-                // Handle A-Z
-                else if (az_selected_index < 26 && entry_first == first_char) {
-                    selected_index = i;
-                    break;
+            } else if (filter_key_index == FILTER_KEY_DELETE) {
+                if (query_len > 0) {
+                    text[query_len - 1] = '\0';
+                    query_changed = 1;
                 }
+            } else if (query_len < text_max) {
+                char c = filter_key_index == FILTER_KEY_SPACE ? ' ' : filter_key_chars[filter_key_index];
+                if (keyboard_lowercase && c >= 'A' && c <= 'Z') c += 'a' - 'A';
+                text[query_len] = c;
+                text[query_len + 1] = '\0';
+                query_changed = 1;
             }
+        }
 
-            az_picker_active = 0;
+        // Y button - delete the last character
+        if (prev_input[10] && !y && query_len > 0) {
+            text[query_len - 1] = '\0';
+            query_changed = 1;
         }
 
-        // B button - cancel
+        if (query_changed && !file_rename_active) {
+            if (in_search) {
+                update_search();
+            } else {
+                update_filter();
+            }
+        }
+
+        // B button - cancel and show the whole folder again (search keeps its
+        // results, a rename leaves the file alone)
         if (prev_input[3] && !b) {
-            az_picker_active = 0;
+            if (file_rename_active) {
+                file_rename_active = 0;
+                filter_keyboard_active = 0;
+            } else if (in_search) {
+                filter_keyboard_active = 0;
+            } else {
+                close_filter();
+            }
         }
 
-        // Update prev_input and return (picker consumed input)
+        // Update prev_input and return (keyboard consumed input)
         prev_input[0] = up;
         prev_input[1] = down;
         prev_input[2] = a;
         prev_input[3] = b;
+        prev_input[4] = l;
         prev_input[7] = left;
         prev_input[8] = right;
+        prev_input[10] = y;
         return;
     }
 
+    // Handle START button to open file actions on the selected ROM, or the
+    // view switch of a system folder (on button release)
+    if (prev_input[11] && !start && entry_count > 0 && !filter_applied) {
+        MenuEntry *entry = list_get(selected_index);
+        file_menu_action_count = 0;
+        if (list_virtual && !list_archive && !list_tree && !entry->is_dir) {
+            file_menu_actions[file_menu_action_count++] = FILE_ACTION_RENAME;
+            file_menu_actions[file_menu_action_count++] = FILE_ACTION_DELETE;
+            strncpy(file_action_name, entry->name, sizeof(file_action_name) - 1);
+        } else if (current_system_name()) {
+            strncpy(file_action_name, current_system_name(), sizeof(file_action_name) - 1);
+        }
+        if (current_system_name()) {
+            file_menu_actions[file_menu_action_count++] = FILE_ACTION_FLATTEN;
+        }
+
+        if (file_menu_action_count > 0) {
+            file_action_name[sizeof(file_action_name) - 1] = '\0';
+            file_menu_active = 1;
+            file_menu_index = 0;
+            file_delete_confirm = 0;
+        }
+    }
+
+    // Handle Y button to open the filter keyboard in ROM folders, or to edit
+    // the search query (on button release)
+    if (prev_input[10] && !y) {
+        if (strcmp(current_path, "SEARCH") == 0) {
+            filter_keyboard_active = 1;
+        } else if (filter_applied ||
+            (strncmp(current_path, ROMS_PATH "/", strlen(ROMS_PATH) + 1) == 0 && entry_count > 1)) {
+            open_filter();
+        }
+    }
+
     // Handle RIGHT button to open A-Z picker (on button release)
-    if (prev_input[8] && !right) {
+    if (prev_input[8] && !right && !filter_applied) {
         // Don't activate in special menus
         if (strcmp(current_path, "RECENT_GAMES") != 0 &&
             strcmp(current_path, "FAVORITES") != 0 &&
+            strcmp(current_path, "SEARCH") != 0 &&
             strcmp(current_path, "TOOLS") != 0 &&
             strcmp(current_path, "UTILS") != 0 &&
             strcmp(current_path, "HOTKEYS") != 0 &&
@@ -1434,7 +2441,7 @@ static void handle_input() {
             if (slash && slash != current_path) {
                 // Extract folder name from path like "/mnt/sda1/ROMS/gb"
                 strcpy(console_folder, slash + 1);
-                const char *core_name = get_core_name_for_console(console_folder);
+                const char *core_name = systems_get_core_name(console_folder);
                 if (core_name) {
                     // Show core-specific settings
                     show_core_settings(core_name);
@@ -1503,7 +2510,7 @@ static void handle_input() {
 
     // Handle X button (toggle favorite / remove from favorites) - on button release
     if (prev_input[9] && !x && entry_count > 0) {
-        MenuEntry *entry = &entries[selected_index];
+        MenuEntry *entry = list_get(selected_index);
 
         // Handle removing from favorites when in FAVORITES view
         if (strcmp(current_path, "FAVORITES") == 0) {
@@ -1529,28 +2536,27 @@ static void handle_input() {
                 }
             }
         }
-        // Only allow favoriting in ROM directories (not in special menus)
-        else if (!entry->is_dir &&
+        // Only allow favoriting in ROM directories (not in special menus or archives)
+        else if (!entry->is_dir && !list_archive &&
             strcmp(current_path, "RECENT_GAMES") != 0 &&
+            strcmp(current_path, "SEARCH") != 0 &&
             strcmp(current_path, "TOOLS") != 0 &&
             strcmp(current_path, "UTILS") != 0 &&
             strcmp(current_path, "HOTKEYS") != 0 &&
             strcmp(current_path, "CREDITS") != 0 &&
             strcmp(current_path, ROMS_PATH) != 0) {
 
-            // Get core name and filename
-            const char *core_name = get_basename(current_path);
-            const char *filename_path = strrchr(entry->path, '/');
-            const char *filename = filename_path ? filename_path + 1 : entry->name;
+            // Toggle favorite under the folder's system ID
+            SystemId folder_system = systems_intern(get_basename(current_path));
+            const char *filename = entry_game_name(entry);
 
-            // Toggle favorite
-            favorites_toggle(core_name, filename, entry->path);
+            favorites_toggle(folder_system, filename, entry->path);
         }
     }
 
     // Handle A button (select) - on button release
     if (prev_input[2] && !a && entry_count > 0) {
-        MenuEntry *entry = &entries[selected_index];
+        MenuEntry *entry = list_get(selected_index);
 
         if (strcmp(entry->name, "..") == 0) {
             // Go to parent directory
@@ -1565,16 +2571,14 @@ static void handle_input() {
                 scan_directory(current_path);
 
                 // Find the directory we just left and restore selection to it
-                for (int i = 0; i < entry_count; i++) {
-                    if (strcmp(entries[i].name, prev_dir) == 0) {
-                        selected_index = i;
-                        // Update scroll offset to keep selection visible
-                        if (selected_index < scroll_offset) {
-                            scroll_offset = selected_index;
-                        } else if (selected_index >= scroll_offset + VISIBLE_ENTRIES) {
-                            scroll_offset = selected_index - VISIBLE_ENTRIES + 1;
-                        }
-                        break;
+                int prev_index = list_find_name(prev_dir);
+                if (prev_index >= 0) {
+                    selected_index = prev_index;
+                    // Update scroll offset to keep selection visible
+                    if (selected_index < scroll_offset) {
+                        scroll_offset = selected_index;
+                    } else if (selected_index >= scroll_offset + VISIBLE_ENTRIES) {
+                        scroll_offset = selected_index - VISIBLE_ENTRIES + 1;
                     }
                 }
             }
@@ -1592,6 +2596,9 @@ static void handle_input() {
                 // Pick and launch a random game
                 pick_random_game();
                 return;
+            } else if (strcmp(entry->path, "SEARCH") == 0) {
+                // Search every system from the library catalog
+                show_search();
             } else if (strcmp(entry->path, "TOOLS") == 0) {
                 // Show tools menu
                 show_tools_menu();
@@ -1612,6 +2619,10 @@ static void handle_input() {
                 strncpy(current_path, entry->path, sizeof(current_path) - 1);
                 scan_directory(current_path);
             }
+        } else if (!list_archive && is_browsable_archive(entry->path)) {
+            // Multi-ROM archive - open it like a folder
+            strncpy(current_path, entry->path, sizeof(current_path) - 1);
+            scan_directory(current_path);
         } else {
             // File selected - try to launch it
             const char *core_name;
@@ -1621,7 +2632,8 @@ static void handle_input() {
             if (strcmp(current_path, "UTILS") == 0) {
                 // Handle "Rebuild folder cache" action
                 if (strcmp(entry->path, "REBUILD_CACHE") == 0) {
-                    rebuild_empty_dirs_cache();
+                    show_status_screen("Rebuilding folder cache...");
+                    library_rebuild(show_library_scan_screen);
                     // Go back to ROMS root after rebuild
                     strncpy(current_path, ROMS_PATH, sizeof(current_path) - 1);
                     scan_directory(current_path);
@@ -1645,70 +2657,75 @@ static void handle_input() {
             
             // Check if we're in Recent games
             if (strcmp(current_path, "RECENT_GAMES") == 0) {
-                // Parse core_name;game_name from entry->path
-                char *separator = strchr(entry->path, ';');
-                if (separator) {
-                    *separator = '\0';
-                    core_name = entry->path;
-                    filename = separator + 1;
-
-                    // For recent games, get the full_path from the RecentGame structure
-                    const RecentGame* recent_list = recent_games_get_list();
-                    int recent_count = recent_games_get_count();
-                    const char* full_path = "";
-
-                    for (int i = 0; i < recent_count; i++) {
-                        if (strcmp(recent_list[i].core_name, core_name) == 0 &&
-                            strcmp(recent_list[i].game_name, filename) == 0) {
-                            full_path = recent_list[i].full_path;
-                            break;
-                        }
-                    }
-
-                    // Add to recent history (moves to top) - use actual full path
-                    recent_games_add(core_name, filename, full_path);
-                } else {
-                    return; // Invalid format
-                }
+                // Recent games are the first entries, in history order
+                int recent_index = (int)(entry - entries);
+                if (recent_index >= recent_games_get_count()) return;
+
+                // Copied: adding the game below reorders the history
+                static RecentGame recent_game;
+                recent_game = recent_games_get_list()[recent_index];
+                core_name = systems_folder(recent_game.system);
+                filename = recent_game.game_name;
+
+                // Add to recent history (moves to top) - use actual full path
+                recent_games_add(recent_game.system, filename, recent_game.full_path);
             } else if (strcmp(current_path, "FAVORITES") == 0) {
-                // Parse core_name;game_name from entry->path
-                char *separator = strchr(entry->path, ';');
-                if (separator) {
-                    *separator = '\0';
-                    core_name = entry->path;
-                    filename = separator + 1;
-
-                    // For favorites, get the full_path from the FavoriteGame structure
-                    const FavoriteGame* favorites_list = favorites_get_list();
-                    int favorites_count = favorites_get_count();
-                    const char* full_path = "";
-
-                    for (int i = 0; i < favorites_count; i++) {
-                        if (strcmp(favorites_list[i].core_name, core_name) == 0 &&
-                            strcmp(favorites_list[i].game_name, filename) == 0) {
-                            full_path = favorites_list[i].full_path;
-                            break;
-                        }
-                    }
-
-                    // Add to recent history when launching from favorites
-                    recent_games_add(core_name, filename, full_path);
-                } else {
-                    return; // Invalid format
+                // Favorites are the first entries, in list order
+                int favorite_index = (int)(entry - entries);
+                if (favorite_index >= favorites_get_count()) return;
+
+                const FavoriteGame *favorite = &favorites_get_list()[favorite_index];
+                core_name = systems_folder(favorite->system);
+                filename = favorite->game_name;
+
+                // Add to recent history when launching from favorites
+                recent_games_add(favorite->system, filename, favorite->full_path);
+            } else if (strcmp(current_path, "SEARCH") == 0) {
+                // Results hold the full ROM path - the system is its folder
+                static char search_folder[MAX_PATH_LEN];
+                strncpy(search_folder, entry->path, sizeof(search_folder) - 1);
+                search_folder[sizeof(search_folder) - 1] = '\0';
+                char *search_slash = strrchr(search_folder, '/');
+                if (!search_slash) return;
+                *search_slash = '\0';
+
+                core_name = get_basename(search_folder);
+                filename = search_slash + 1;
+
+                recent_games_add(systems_intern(core_name), filename, entry->path);
+            } else if (list_archive) {
+                // The member is launched through its archive
+                // ("<archive>.zip#<member>"), named after the folder that
+                // holds the archive
+                static char archive_folder[MAX_PATH_LEN];
+                static char archive_member[MAX_PATH_LEN];
+                strncpy(archive_folder, current_path, sizeof(archive_folder) - 1);
+                archive_folder[sizeof(archive_folder) - 1] = '\0';
+                char *archive_slash = strrchr(archive_folder, '/');
+                if (!archive_slash) return;
+                *archive_slash = '\0';
+                if (snprintf(archive_member, sizeof(archive_member), "%s%c%s", archive_slash + 1,
+                             ARCHIVE_MEMBER_SEPARATOR, entry->name) >= (int)sizeof(archive_member)) {
+                    return;
                 }
+
+                core_name = get_basename(archive_folder);
+                filename = archive_member;
+
+                recent_games_add(systems_intern(core_name), filename, current_path);
             } else {
-                // Extract core name from parent directory
+                // Extract core name from parent directory (flattened
+                // systems launch subfolder ROMs by their path below it)
                 core_name = get_basename(current_path);
-                const char *filename_path = strrchr(entry->path, '/');
-                filename = filename_path ? filename_path + 1 : entry->name;
+                filename = entry_game_name(entry);
 
                 // Add to recent history - use full entry path
-                recent_games_add(core_name, filename, entry->path);
+                recent_games_add(systems_intern(core_name), filename, entry->path);
             }
 
             sprintf((char *)ptr_gs_run_game_file, "%s;%s;%s.gba", core_name, core_name, filename); // TODO: Replace second core_name with full directory (besides /mnt/sda1) and seperate core_name from directory
             // Don't set ptr_gs_run_folder - inherit from menu core for savestates to work
-            sprintf((char *)ptr_gs_run_game_name, "%s", filename); // Expects the filename without any extension
+            sprintf((char *)ptr_gs_run_game_name, "%s", launch_base_name(filename)); // Expects the filename without any extension
 
             // Remove extension from ptr_gs_run_game_name
             char *dot_position = strrchr(ptr_gs_run_game_name, '.');
@@ -1722,13 +2739,30 @@ static void handle_input() {
 
     // Handle B button (back) - on button release
     if (prev_input[3] && !b) {
-        if (strcmp(current_path, "RECENT_GAMES") == 0) {
+        if (filter_applied) {
+            // Leave the filtered view first, staying on the selected entry
+            close_filter();
+        } else if (strcmp(current_path, "RECENT_GAMES") == 0) {
             // Go back from Recent games to main ROMS directory
             strncpy(current_path, ROMS_PATH, sizeof(current_path) - 1);
             scan_directory(current_path);
             // Restore selection to "Recent games" entry
             for (int i = 0; i < entry_count; i++) {
-                if (strcmp(entries[i].path, "RECENT_GAMES") == 0) {
+                if (strcmp(list_get(i)->path, "RECENT_GAMES") == 0) {
+                    selected_index = i;
+                    if (selected_index >= scroll_offset + VISIBLE_ENTRIES) {
+                        scroll_offset = selected_index - VISIBLE_ENTRIES + 1;
+                    }
+                    break;
+                }
+            }
+        } else if (strcmp(current_path, "SEARCH") == 0) {
+            // Go back from Search to main ROMS directory
+            strncpy(current_path, ROMS_PATH, sizeof(current_path) - 1);
+            scan_directory(current_path);
+            // Restore selection to "Search" entry
+            for (int i = 0; i < entry_count; i++) {
+                if (strcmp(list_get(i)->path, "SEARCH") == 0) {
                     selected_index = i;
                     if (selected_index >= scroll_offset + VISIBLE_ENTRIES) {
                         scroll_offset = selected_index - VISIBLE_ENTRIES + 1;
@@ -1742,7 +2776,7 @@ static void handle_input() {
             scan_directory(current_path);
             // Restore selection to "Favorites" entry
             for (int i = 0; i < entry_count; i++) {
-                if (strcmp(entries[i].path, "FAVORITES") == 0) {
+                if (strcmp(list_get(i)->path, "FAVORITES") == 0) {
                     selected_index = i;
                     if (selected_index >= scroll_offset + VISIBLE_ENTRIES) {
                         scroll_offset = selected_index - VISIBLE_ENTRIES + 1;
@@ -1756,7 +2790,7 @@ static void handle_input() {
             scan_directory(current_path);
             // Restore selection to "Tools" entry
             for (int i = 0; i < entry_count; i++) {
-                if (strcmp(entries[i].path, "TOOLS") == 0) {
+                if (strcmp(list_get(i)->path, "TOOLS") == 0) {
                     selected_index = i;
                     if (selected_index >= scroll_offset + VISIBLE_ENTRIES) {
                         scroll_offset = selected_index - VISIBLE_ENTRIES + 1;
@@ -1788,16 +2822,14 @@ static void handle_input() {
                 scan_directory(current_path);
 
                 // Find the directory we just left and restore selection to it
-                for (int i = 0; i < entry_count; i++) {
-                    if (strcmp(entries[i].name, prev_dir) == 0) {
-                        selected_index = i;
-                        // Update scroll offset to keep selection visible
-                        if (selected_index < scroll_offset) {
-                            scroll_offset = selected_index;
-                        } else if (selected_index >= scroll_offset + VISIBLE_ENTRIES) {
-                            scroll_offset = selected_index - VISIBLE_ENTRIES + 1;
-                        }
-                        break;
+                int prev_index = list_find_name(prev_dir);
+                if (prev_index >= 0) {
+                    selected_index = prev_index;
+                    // Update scroll offset to keep selection visible
+                    if (selected_index < scroll_offset) {
+                        scroll_offset = selected_index;
+                    } else if (selected_index >= scroll_offset + VISIBLE_ENTRIES) {
+                        scroll_offset = selected_index - VISIBLE_ENTRIES + 1;
                     }
                 }
             }
@@ -1815,6 +2847,8 @@ static void handle_input() {
     prev_input[7] = left;
     prev_input[8] = right;
     prev_input[9] = x;
+    prev_input[10] = y;
+    prev_input[11] = start;
 }
 
 // Libretro API implementation
@@ -1828,6 +2862,7 @@ void retro_init(void) {
     render_init(framebuffer);
     font_init();
     theme_init();
+    sysicons_load(SYSICONS_FILE);
     recent_games_init();
     favorites_init();
     settings_init();
@@ -1841,17 +2876,32 @@ void retro_init(void) {
 
     // Skip directory scan if we're auto-launching a game (faster boot)
     if (!game_queued) {
+        // Load the library catalog in one read, then rescan only the
+        // system folders that changed since it was written
+        library_init(ROMS_PATH, LIBRARY_CACHE_FILE);
+        if (!library_load()) {
+            // First boot without a catalog: drop the empty-dirs cache it replaced
+            remove(LEGACY_EMPTY_DIRS_CACHE_FILE);
+        }
+        library_refresh(show_library_scan_screen);
+
         strncpy(current_path, ROMS_PATH, sizeof(current_path) - 1);
         scan_directory(current_path);
     }
 }
 
 void retro_deinit(void) {
-    // Free thumbnail cache
-    if (thumbnail_cache_valid) {
-        free_thumbnail(&current_thumbnail);
-        thumbnail_cache_valid = 0;
-    }
+    // Drop the thumbnail cache
+    thumbnail_cache_valid = 0;
+    thumbnail_cache_clear();
+
+    // Write back in-place catalog edits, then free the catalog, search index
+    // and any open directory index
+    library_save();
+    library_free();
+    search_free();
+    dirindex_close();
+    sysicons_free();
 
     // Free entries array
     if (entries) {
@@ -1931,11 +2981,33 @@ void retro_reset(void) {
 }
 
 void retro_run(void) {
+    thumb_loaded_this_frame = 0;
+    if (tree_build_active) {
+        step_tree_build();
+    }
     handle_input();
     render_menu();
     if (video_cb) {
         video_cb(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_WIDTH * sizeof(uint16_t));
     }
+
+    // Thumbnail being made from .png / .jpg art: one piece per frame, then
+    // the selection is read again
+    if (thumbnail_cache_busy() && !game_queued) {
+        thumb_loaded_this_frame = 1;
+        if (thumbnail_cache_step() && thumb_pending_frames == 0) {
+            thumb_pending_frames = 1;
+        }
+    }
+
+    // Idle frame (nothing read for the selection, no tree build): warm up
+    // the neighbours' thumbnails once the selection has rested and its own
+    // is settled
+    if (!thumb_loaded_this_frame && !tree_build_active && !game_queued &&
+        last_selected_index == selected_index && thumb_rest_frames >= THUMB_DEBOUNCE_FRAMES &&
+        thumb_pending_frames == 0 && entry_count > 0) {
+        prefetch_thumbnails();
+    }
     if (game_queued) {
         const char *stub_path = "/mnt/sda1/temp_launch.gba";
         FILE *stub_file = fopen(stub_path, "wb");
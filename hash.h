@@ -0,0 +1,42 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stdint.h>
+
+// 32-bit FNV-1a string hashes shared by the lookup tables and cache files.
+// The values are stored on disk, so they must never change.
+#define HASH_FNV_OFFSET 2166136261u
+#define HASH_FNV_PRIME  16777619u
+
+static inline uint32_t hash_string(const char *str) {
+    uint32_t hash = HASH_FNV_OFFSET;
+    while (*str) {
+        hash ^= (uint8_t)*str++;
+        hash *= HASH_FNV_PRIME;
+    }
+    return hash;
+}
+
+// Case-insensitive variant (ASCII folding) for FAT file and folder names
+static inline uint32_t hash_string_nocase(const char *str) {
+    uint32_t hash = HASH_FNV_OFFSET;
+    while (*str) {
+        uint8_t c = (uint8_t)*str++;
+        if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+        hash ^= c;
+        hash *= HASH_FNV_PRIME;
+    }
+    return hash;
+}
+
+// Seeded variant for the generated perfect hash tables (seed 0 == hash_string)
+static inline uint32_t hash_string_seeded(const char *str, uint32_t seed) {
+    uint32_t hash = HASH_FNV_OFFSET ^ (seed * 0x9E3779B9u);
+    while (*str) {
+        hash ^= (uint8_t)*str++;
+        hash *= HASH_FNV_PRIME;
+    }
+    return hash;
+}
+
+#endif // HASH_H
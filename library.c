@@ -0,0 +1,749 @@
+#include "library.h"
+#include "collate.h"
+#include "hash.h"
+#include "systems.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+#ifdef SF2000
+#include "../../debug.h"
+#include "../../dirent.h"
+#else
+#include <dirent.h>
+#define xlog printf
+#endif
+
+static char library_roms_path[512] = "";
+static char library_cache_path[512] = "";
+
+// Current catalog - a single buffer laid out exactly like the cache file
+static uint8_t *library_data = NULL;
+static const LibraryHeader *library_header = NULL;
+static const LibrarySystem *library_systems = NULL;
+static const LibraryRom *library_roms = NULL;
+static const char *library_strings = NULL;
+
+// IDs of systems holding at least one ROM (for per-system random picks)
+static uint16_t *library_nonempty_systems = NULL;
+static int library_nonempty_count = 0;
+
+// Open-addressing hash of folder name -> system ID + 1 (0 = empty slot)
+static uint16_t *library_system_hash = NULL;
+static uint32_t library_system_hash_mask = 0;
+
+// Set when the catalog was edited in memory and the cache file is behind
+static int library_dirty = 0;
+
+// Growable tables used while (re)building the catalog
+typedef struct {
+    LibrarySystem *systems;
+    int system_count;
+    int system_capacity;
+    LibraryRom *roms;
+    int rom_count;
+    int rom_capacity;
+    char *strings;
+    uint32_t strings_size;
+    uint32_t strings_capacity;
+    int failed;             // Set when an allocation fails
+} LibraryBuilder;
+
+// System folder found in the ROMs root
+typedef struct {
+    char name[256];
+    uint32_t mtime;
+} SystemFolder;
+
+void library_init(const char *roms_path, const char *cache_path) {
+    strncpy(library_roms_path, roms_path, sizeof(library_roms_path) - 1);
+    library_roms_path[sizeof(library_roms_path) - 1] = '\0';
+    strncpy(library_cache_path, cache_path, sizeof(library_cache_path) - 1);
+    library_cache_path[sizeof(library_cache_path) - 1] = '\0';
+}
+
+void library_free(void) {
+    if (library_data) {
+        free(library_data);
+    }
+    library_data = NULL;
+    library_header = NULL;
+    library_systems = NULL;
+    library_roms = NULL;
+    library_strings = NULL;
+
+    free(library_nonempty_systems);
+    library_nonempty_systems = NULL;
+    library_nonempty_count = 0;
+
+    free(library_system_hash);
+    library_system_hash = NULL;
+    library_system_hash_mask = 0;
+}
+
+static size_t library_layout_size(uint32_t system_count, uint32_t rom_count, uint32_t strings_size) {
+    return sizeof(LibraryHeader) +
+           (size_t)system_count * sizeof(LibrarySystem) +
+           (size_t)rom_count * sizeof(LibraryRom) +
+           strings_size;
+}
+
+// Validate a catalog buffer and make it current (takes ownership on success)
+static int library_attach(uint8_t *data, size_t size) {
+    if (size < sizeof(LibraryHeader)) return 0;
+
+    const LibraryHeader *header = (const LibraryHeader *)data;
+    if (header->magic != LIBRARY_MAGIC || header->version != LIBRARY_VERSION) return 0;
+    if (library_layout_size(header->system_count, header->rom_count, header->strings_size) != size) return 0;
+    if (header->strings_size == 0) return 0;
+
+    const LibrarySystem *systems = (const LibrarySystem *)(data + sizeof(LibraryHeader));
+    const LibraryRom *roms = (const LibraryRom *)(systems + header->system_count);
+    const char *strings = (const char *)(roms + header->rom_count);
+
+    // Every name must be inside the string table, which must end with a NUL
+    if (strings[header->strings_size - 1] != '\0') return 0;
+    for (uint32_t i = 0; i < header->system_count; i++) {
+        if (systems[i].name_offset >= header->strings_size) return 0;
+        if (systems[i].first_rom + systems[i].rom_count > header->rom_count) return 0;
+    }
+    for (uint32_t i = 0; i < header->rom_count; i++) {
+        if (roms[i].name_offset >= header->strings_size) return 0;
+        if (roms[i].system_id >= header->system_count) return 0;
+    }
+
+    library_free();
+    library_data = data;
+    library_header = header;
+    library_systems = systems;
+    library_roms = roms;
+    library_strings = strings;
+
+    library_nonempty_systems = (uint16_t*)malloc((header->system_count + 1) * sizeof(uint16_t));
+    if (library_nonempty_systems) {
+        for (uint32_t i = 0; i < header->system_count; i++) {
+            if (systems[i].rom_count > 0) {
+                library_nonempty_systems[library_nonempty_count++] = (uint16_t)i;
+            }
+        }
+    }
+
+    // Size the folder hash at 2x the system count (power of two)
+    uint32_t hash_size = 16;
+    while (hash_size < header->system_count * 2) hash_size *= 2;
+    library_system_hash = (uint16_t*)calloc(hash_size, sizeof(uint16_t));
+    if (library_system_hash) {
+        library_system_hash_mask = hash_size - 1;
+        for (uint32_t i = 0; i < header->system_count; i++) {
+            uint32_t slot = hash_string_nocase(strings + systems[i].name_offset) & library_system_hash_mask;
+            while (library_system_hash[slot]) slot = (slot + 1) & library_system_hash_mask;
+            library_system_hash[slot] = (uint16_t)(i + 1);
+        }
+    }
+    return 1;
+}
+
+int library_load(void) {
+    FILE *fp = fopen(library_cache_path, "rb");
+    if (!fp) {
+        return 0;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long file_size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    if (file_size <= 0) {
+        fclose(fp);
+        return 0;
+    }
+
+    uint8_t *data = (uint8_t*)malloc(file_size);
+    if (!data) {
+        fclose(fp);
+        return 0;
+    }
+
+    // Whole catalog in one read
+    size_t read_bytes = fread(data, 1, file_size, fp);
+    fclose(fp);
+
+    if (read_bytes != (size_t)file_size || !library_attach(data, file_size)) {
+        xlog("Library: cache invalid, ignoring\n");
+        free(data);
+        return 0;
+    }
+
+    xlog("Library: loaded %u systems, %u roms\n",
+         (unsigned)library_header->system_count, (unsigned)library_header->rom_count);
+    return 1;
+}
+
+// Builder helpers
+
+static uint32_t builder_add_string(LibraryBuilder *b, const char *str) {
+    uint32_t len = strlen(str) + 1;
+    if (b->strings_size + len > b->strings_capacity) {
+        uint32_t new_capacity = b->strings_capacity ? b->strings_capacity : 4096;
+        while (new_capacity < b->strings_size + len) new_capacity *= 2;
+
+        char *new_strings = (char*)realloc(b->strings, new_capacity);
+        if (!new_strings) {
+            b->failed = 1;
+            return 0;
+        }
+        b->strings = new_strings;
+        b->strings_capacity = new_capacity;
+    }
+
+    uint32_t offset = b->strings_size;
+    memcpy(b->strings + offset, str, len);
+    b->strings_size += len;
+    return offset;
+}
+
+static LibraryRom *builder_add_rom(LibraryBuilder *b) {
+    if (b->rom_count >= b->rom_capacity) {
+        int new_capacity = b->rom_capacity ? b->rom_capacity * 2 : 256;
+        LibraryRom *new_roms = (LibraryRom*)realloc(b->roms, new_capacity * sizeof(LibraryRom));
+        if (!new_roms) {
+            b->failed = 1;
+            return NULL;
+        }
+        b->roms = new_roms;
+        b->rom_capacity = new_capacity;
+    }
+    LibraryRom *rom = &b->roms[b->rom_count++];
+    memset(rom, 0, sizeof(*rom));
+    return rom;
+}
+
+static LibrarySystem *builder_add_system(LibraryBuilder *b) {
+    if (b->system_count >= b->system_capacity) {
+        int new_capacity = b->system_capacity ? b->system_capacity * 2 : 64;
+        LibrarySystem *new_systems = (LibrarySystem*)realloc(b->systems, new_capacity * sizeof(LibrarySystem));
+        if (!new_systems) {
+            b->failed = 1;
+            return NULL;
+        }
+        b->systems = new_systems;
+        b->system_capacity = new_capacity;
+    }
+    LibrarySystem *system = &b->systems[b->system_count++];
+    memset(system, 0, sizeof(*system));
+    return system;
+}
+
+static void builder_free(LibraryBuilder *b) {
+    free(b->systems);
+    free(b->roms);
+    free(b->strings);
+    memset(b, 0, sizeof(*b));
+}
+
+// Sort roms[first..first+count) by name using precomputed collation keys
+static void builder_sort_roms(LibraryBuilder *b, int first, int count) {
+    if (count < 2) return;
+
+    CollateItem *items = (CollateItem*)malloc(count * sizeof(CollateItem));
+    LibraryRom *sorted = (LibraryRom*)malloc(count * sizeof(LibraryRom));
+    if (!items || !sorted) {
+        free(items);
+        free(sorted);
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const char *name = b->strings + b->roms[first + i].name_offset;
+        items[i].key = collate_key(name);
+        items[i].name = name;
+        items[i].index = i;
+    }
+    collate_sort(items, count);
+
+    for (int i = 0; i < count; i++) {
+        sorted[i] = b->roms[first + items[i].index];
+    }
+    memcpy(b->roms + first, sorted, count * sizeof(LibraryRom));
+
+    free(items);
+    free(sorted);
+}
+
+// Read one system folder into the builder
+static void builder_scan_system(LibraryBuilder *b, int system_id, const char *system_name) {
+    char system_path[512];
+    int path_len = snprintf(system_path, sizeof(system_path), "%s/%s", library_roms_path, system_name);
+
+    LibrarySystem *system = &b->systems[system_id];
+    system->first_rom = b->rom_count;
+    system->rom_count = 0;
+    system->subdir_count = 0;
+    system->newest_mtime = 0;
+    system->total_bytes = 0;
+
+    if (path_len >= (int)sizeof(system_path)) return;
+    DIR *dir = opendir(system_path);
+    if (!dir) return;
+
+    ExtensionFilter ext_filter;
+    systems_get_extension_filter(system_name, &ext_filter);
+
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] == '.') continue;  // Skip hidden files
+
+        // Subfolders are only counted - ROMs come from the system folder itself
+        if (ent->d_type == DT_DIR) {
+            b->systems[system_id].subdir_count++;
+            continue;
+        }
+
+        // Same extension filter as the browser, checked before the stat
+        int allowed = systems_extension_allowed(&ext_filter, ent->d_name);
+        if (!allowed && ent->d_type != DT_UNKNOWN) continue;
+
+        char full_path[512];
+        if (snprintf(full_path, sizeof(full_path), "%s/%s", system_path, ent->d_name) >= (int)sizeof(full_path)) {
+            continue;
+        }
+
+        struct stat st;
+        if (stat(full_path, &st) != 0) continue;
+        if (S_ISDIR(st.st_mode)) {
+            b->systems[system_id].subdir_count++;
+            continue;
+        }
+        if (!allowed) continue;
+
+        uint32_t name_offset = builder_add_string(b, ent->d_name);
+        LibraryRom *rom = builder_add_rom(b);
+        if (b->failed || !rom) break;
+
+        rom->name_offset = name_offset;
+        rom->size = (uint32_t)st.st_size;
+        rom->mtime = (uint32_t)st.st_mtime;
+        rom->system_id = (uint16_t)system_id;
+
+        // The system table may have moved while growing the other tables
+        system = &b->systems[system_id];
+        system->rom_count++;
+        system->total_bytes += (uint32_t)st.st_size;
+        if (rom->mtime > system->newest_mtime) system->newest_mtime = rom->mtime;
+    }
+    closedir(dir);
+
+    builder_sort_roms(b, b->systems[system_id].first_rom, b->systems[system_id].rom_count);
+}
+
+// Copy an unchanged system section from the current catalog
+static void builder_copy_system(LibraryBuilder *b, int system_id, int old_id) {
+    const LibrarySystem *old_system = &library_systems[old_id];
+
+    b->systems[system_id].first_rom = b->rom_count;
+    b->systems[system_id].rom_count = old_system->rom_count;
+    b->systems[system_id].subdir_count = old_system->subdir_count;
+    b->systems[system_id].newest_mtime = old_system->newest_mtime;
+    b->systems[system_id].total_bytes = old_system->total_bytes;
+
+    for (uint32_t i = 0; i < old_system->rom_count; i++) {
+        const LibraryRom *old_rom = &library_roms[old_system->first_rom + i];
+        uint32_t name_offset = builder_add_string(b, library_strings + old_rom->name_offset);
+        LibraryRom *rom = builder_add_rom(b);
+        if (b->failed || !rom) return;
+
+        *rom = *old_rom;
+        rom->name_offset = name_offset;
+        rom->system_id = (uint16_t)system_id;
+    }
+}
+
+// List the system folders in the ROMs root, sorted by name
+static SystemFolder *list_system_folders(int *count) {
+    *count = 0;
+
+    DIR *dir = opendir(library_roms_path);
+    if (!dir) return NULL;
+
+    SystemFolder *folders = NULL;
+    int capacity = 0;
+
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        if (strcasecmp(ent->d_name, "frogui") == 0 ||
+            strcasecmp(ent->d_name, "saves") == 0 ||
+            strcasecmp(ent->d_name, "save") == 0) continue;
+        if (ent->d_type != DT_DIR && ent->d_type != DT_UNKNOWN) continue;
+
+        char full_path[512];
+        if (snprintf(full_path, sizeof(full_path), "%s/%s", library_roms_path, ent->d_name) >= (int)sizeof(full_path)) {
+            continue;
+        }
+
+        struct stat st;
+        if (stat(full_path, &st) != 0 || !S_ISDIR(st.st_mode)) continue;
+
+        if (*count >= capacity) {
+            int new_capacity = capacity ? capacity * 2 : 64;
+            SystemFolder *new_folders = (SystemFolder*)realloc(folders, new_capacity * sizeof(SystemFolder));
+            if (!new_folders) break;
+            folders = new_folders;
+            capacity = new_capacity;
+        }
+
+        strncpy(folders[*count].name, ent->d_name, sizeof(folders[*count].name) - 1);
+        folders[*count].name[sizeof(folders[*count].name) - 1] = '\0';
+        folders[*count].mtime = (uint32_t)st.st_mtime;
+        (*count)++;
+    }
+    closedir(dir);
+
+    if (*count > 1) {
+        CollateItem *items = (CollateItem*)malloc(*count * sizeof(CollateItem));
+        SystemFolder *sorted = (SystemFolder*)malloc(*count * sizeof(SystemFolder));
+        if (items && sorted) {
+            for (int i = 0; i < *count; i++) {
+                items[i].key = collate_key(folders[i].name);
+                items[i].name = folders[i].name;
+                items[i].index = i;
+            }
+            collate_sort(items, *count);
+            for (int i = 0; i < *count; i++) {
+                sorted[i] = folders[items[i].index];
+            }
+            memcpy(folders, sorted, *count * sizeof(SystemFolder));
+        }
+        free(items);
+        free(sorted);
+    }
+
+    return folders;
+}
+
+// Write a catalog buffer to the cache file
+static void library_write_cache(const uint8_t *data, size_t size) {
+    // Write to a temp file first so a power cut never leaves a torn cache
+    char temp_path[520];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", library_cache_path);
+    FILE *fp = fopen(temp_path, "wb");
+    if (fp) {
+        size_t written = fwrite(data, 1, size, fp);
+        fclose(fp);
+        if (written == size) {
+            remove(library_cache_path);
+            rename(temp_path, library_cache_path);
+        } else {
+            remove(temp_path);
+        }
+    }
+}
+
+// Write the builder tables as a cache file and make them the current catalog
+static int builder_commit(LibraryBuilder *b) {
+    size_t size = library_layout_size(b->system_count, b->rom_count, b->strings_size);
+    uint8_t *data = (uint8_t*)malloc(size);
+    if (!data) return 0;
+
+    LibraryHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = LIBRARY_MAGIC;
+    header.version = LIBRARY_VERSION;
+    header.system_count = b->system_count;
+    header.rom_count = b->rom_count;
+    header.strings_size = b->strings_size;
+    header.generation = (library_header ? library_header->generation : 0) + 1;
+
+    uint8_t *p = data;
+    memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+    memcpy(p, b->systems, b->system_count * sizeof(LibrarySystem));
+    p += b->system_count * sizeof(LibrarySystem);
+    memcpy(p, b->roms, b->rom_count * sizeof(LibraryRom));
+    p += b->rom_count * sizeof(LibraryRom);
+    memcpy(p, b->strings, b->strings_size);
+
+    library_write_cache(data, size);
+
+    if (!library_attach(data, size)) {
+        free(data);
+        return 0;
+    }
+    library_dirty = 0;
+    return 1;
+}
+
+static int library_update(void (*on_rescan)(const char *system_name), int force) {
+    int folder_count = 0;
+    SystemFolder *folders = list_system_folders(&folder_count);
+    if (!folders && folder_count == 0 && library_data) {
+        // ROMs root unreadable - keep what we have
+        return 0;
+    }
+
+    LibraryBuilder builder;
+    memset(&builder, 0, sizeof(builder));
+
+    // The string table always starts with an empty string
+    builder_add_string(&builder, "");
+
+    int rescanned = 0;
+    for (int i = 0; i < folder_count && !builder.failed; i++) {
+        int old_id = force ? -1 : library_find_system(folders[i].name);
+
+        uint32_t name_offset = builder_add_string(&builder, folders[i].name);
+        LibrarySystem *system = builder_add_system(&builder);
+        if (builder.failed || !system) break;
+
+        int system_id = builder.system_count - 1;
+        system->name_offset = name_offset;
+        system->dir_mtime = folders[i].mtime;
+
+        if (old_id >= 0 && library_systems[old_id].dir_mtime == folders[i].mtime) {
+            builder_copy_system(&builder, system_id, old_id);
+        } else {
+            if (on_rescan) on_rescan(folders[i].name);
+            builder_scan_system(&builder, system_id, folders[i].name);
+            rescanned++;
+        }
+    }
+
+    int changed = rescanned > 0 || folder_count != library_get_system_count();
+    if (builder.failed) {
+        xlog("Library: out of memory while building catalog\n");
+    } else if (changed) {
+        builder_commit(&builder);
+        xlog("Library: rescanned %d of %d systems, %d roms\n",
+             rescanned, builder.system_count, builder.rom_count);
+    }
+
+    builder_free(&builder);
+    free(folders);
+    return rescanned;
+}
+
+int library_refresh(void (*on_rescan)(const char *system_name)) {
+    return library_update(on_rescan, 0);
+}
+
+void library_rebuild(void (*on_rescan)(const char *system_name)) {
+    library_update(on_rescan, 1);
+}
+
+int library_get_system_count(void) {
+    return library_header ? (int)library_header->system_count : 0;
+}
+
+const LibrarySystem* library_get_system(int system_id) {
+    if (system_id < 0 || system_id >= library_get_system_count()) return NULL;
+    return &library_systems[system_id];
+}
+
+const char* library_get_system_name(int system_id) {
+    const LibrarySystem *system = library_get_system(system_id);
+    return system ? library_strings + system->name_offset : NULL;
+}
+
+int library_find_system(const char *folder_name) {
+    if (!library_system_hash || !folder_name) return -1;
+
+    uint32_t slot = hash_string_nocase(folder_name) & library_system_hash_mask;
+    while (library_system_hash[slot]) {
+        int system_id = library_system_hash[slot] - 1;
+        if (strcasecmp(library_strings + library_systems[system_id].name_offset, folder_name) == 0) {
+            return system_id;
+        }
+        slot = (slot + 1) & library_system_hash_mask;
+    }
+    return -1;
+}
+
+uint32_t library_get_generation(void) {
+    return library_header ? library_header->generation : 0;
+}
+
+int library_get_rom_count(void) {
+    return library_header ? (int)library_header->rom_count : 0;
+}
+
+const LibraryRom* library_get_rom(int rom_index) {
+    if (rom_index < 0 || rom_index >= library_get_rom_count()) return NULL;
+    return &library_roms[rom_index];
+}
+
+const char* library_get_rom_name(int rom_index) {
+    const LibraryRom *rom = library_get_rom(rom_index);
+    return rom ? library_strings + rom->name_offset : NULL;
+}
+
+void library_get_rom_path(int rom_index, char *path, size_t path_size) {
+    const LibraryRom *rom = library_get_rom(rom_index);
+    if (!rom) {
+        if (path_size > 0) path[0] = '\0';
+        return;
+    }
+    snprintf(path, path_size, "%s/%s/%s", library_roms_path,
+             library_get_system_name(rom->system_id), library_strings + rom->name_offset);
+}
+
+// In-place edits
+
+// ROM index of rom_name in a system section, or -(insert position) - 1
+static int find_rom_in_system(const LibrarySystem *system, const char *rom_name) {
+    int lo = system->first_rom;
+    int hi = system->first_rom + system->rom_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        int cmp = collate_compare(library_strings + library_roms[mid].name_offset, rom_name);
+        if (cmp == 0) return mid;
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return -lo - 1;
+}
+
+// Copy the catalog with the ROM at remove_index taken out (-1 for none) and
+// add inserted before the old ROM at insert_index (add NULL for none), both in
+// one system, fix up the section stats and make the copy current. Nothing
+// changes if the copy cannot be made. Names of removed ROMs stay in the
+// string table until the next rescan.
+static int library_splice(int system_id, int remove_index, int insert_index,
+                          const LibraryRom *add, const char *add_name) {
+    const LibraryHeader *old = library_header;
+    uint32_t add_len = add ? strlen(add_name) + 1 : 0;
+    int delta = (add ? 1 : 0) - (remove_index >= 0 ? 1 : 0);
+
+    LibraryHeader header = *old;
+    header.rom_count = old->rom_count + delta;
+    header.strings_size = old->strings_size + add_len;
+    header.generation = old->generation + 1;
+
+    size_t size = library_layout_size(header.system_count, header.rom_count, header.strings_size);
+    uint8_t *data = (uint8_t*)malloc(size);
+    if (!data) return 0;
+
+    LibrarySystem *systems = (LibrarySystem*)(data + sizeof(LibraryHeader));
+    LibraryRom *roms = (LibraryRom*)(systems + header.system_count);
+    char *strings = (char*)(roms + header.rom_count);
+    memcpy(data, &header, sizeof(header));
+    memcpy(systems, library_systems, header.system_count * sizeof(LibrarySystem));
+    memcpy(strings, library_strings, old->strings_size);
+
+    // ROM records, with the edit made on the way
+    uint32_t count = 0;
+    for (uint32_t i = 0; i <= old->rom_count; i++) {
+        if (add && (int)i == insert_index) {
+            roms[count] = *add;
+            roms[count].name_offset = old->strings_size;
+            roms[count].system_id = (uint16_t)system_id;
+            memcpy(strings + old->strings_size, add_name, add_len);
+            count++;
+        }
+        if (i < old->rom_count && (int)i != remove_index) {
+            roms[count++] = library_roms[i];
+        }
+    }
+
+    for (uint32_t i = system_id + 1; i < header.system_count; i++) {
+        systems[i].first_rom += delta;
+    }
+
+    LibrarySystem *system = &systems[system_id];
+    system->rom_count += delta;
+    if (add) system->total_bytes += add->size;
+    if (remove_index >= 0) {
+        const LibraryRom *removed = &library_roms[remove_index];
+        system->total_bytes -= removed->size;
+        if (removed->mtime >= system->newest_mtime) {
+            system->newest_mtime = 0;
+            for (uint32_t i = 0; i < system->rom_count; i++) {
+                uint32_t mtime = roms[system->first_rom + i].mtime;
+                if (mtime > system->newest_mtime) system->newest_mtime = mtime;
+            }
+        }
+    }
+    if (add && add->mtime > system->newest_mtime) system->newest_mtime = add->mtime;
+
+    // The folder changed on disk - keep its section from being rescanned
+    char system_path[512];
+    struct stat st;
+    if (snprintf(system_path, sizeof(system_path), "%s/%s", library_roms_path,
+                 library_strings + system->name_offset) < (int)sizeof(system_path) &&
+        stat(system_path, &st) == 0) {
+        system->dir_mtime = (uint32_t)st.st_mtime;
+    }
+
+    if (!library_attach(data, size)) {
+        free(data);
+        return 0;
+    }
+    library_dirty = 1;
+    return 1;
+}
+
+int library_add_rom(const char *system_name, const char *rom_name, uint32_t size, uint32_t mtime) {
+    int system_id = library_find_system(system_name);
+    if (system_id < 0) return 0;
+
+    int rom_index = find_rom_in_system(&library_systems[system_id], rom_name);
+    if (rom_index >= 0) return 0;  // Already listed
+
+    LibraryRom rom;
+    memset(&rom, 0, sizeof(rom));
+    rom.size = size;
+    rom.mtime = mtime;
+    return library_splice(system_id, -1, -rom_index - 1, &rom, rom_name);
+}
+
+int library_remove_rom(const char *system_name, const char *rom_name) {
+    int system_id = library_find_system(system_name);
+    if (system_id < 0) return 0;
+
+    int rom_index = find_rom_in_system(&library_systems[system_id], rom_name);
+    if (rom_index < 0) return 0;
+    return library_splice(system_id, rom_index, -1, NULL, NULL);
+}
+
+int library_rename_rom(const char *system_name, const char *old_name, const char *new_name) {
+    int system_id = library_find_system(system_name);
+    if (system_id < 0) return 0;
+
+    int rom_index = find_rom_in_system(&library_systems[system_id], old_name);
+    if (rom_index < 0) return 0;
+
+    // The new name must be free (or collate the same as the old one)
+    int new_index = find_rom_in_system(&library_systems[system_id], new_name);
+    if (new_index >= 0 && new_index != rom_index) return 0;
+
+    // One copy with the old entry out and the new one in
+    LibraryRom rom = library_roms[rom_index];
+    return library_splice(system_id, rom_index, new_index >= 0 ? rom_index : -new_index - 1, &rom, new_name);
+}
+
+void library_save(void) {
+    if (!library_dirty || !library_header) return;
+
+    library_write_cache(library_data, library_layout_size(library_header->system_count,
+                                                          library_header->rom_count,
+                                                          library_header->strings_size));
+    library_dirty = 0;
+}
+
+int library_pick_random_rom(int per_system) {
+    int rom_count = library_get_rom_count();
+    if (rom_count == 0) return -1;
+
+    if (per_system && library_nonempty_count > 0) {
+        // Every non-empty system is equally likely, then any game within it
+        const LibrarySystem *system = &library_systems[library_nonempty_systems[rand() % library_nonempty_count]];
+        return system->first_rom + rand() % system->rom_count;
+    }
+
+    // Every game in the library is equally likely
+    return rand() % rom_count;
+}
@@ -0,0 +1,100 @@
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Whole-library catalog: every ROM in every system folder under the ROMs
+// root, kept in one cache file that is loaded with a single read.
+//
+// File layout (native little-endian, same on device and host):
+//   LibraryHeader
+//   LibrarySystem[system_count]   sorted by folder name
+//   LibraryRom[rom_count]         grouped by system, sorted by name
+//   char strings[strings_size]    NUL-terminated names
+#define LIBRARY_CACHE_FILE "/mnt/sda1/configs/frogui_library.cache"
+#define LIBRARY_MAGIC 0x42494C46  // "FLIB"
+#define LIBRARY_VERSION 3
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t system_count;
+    uint32_t rom_count;
+    uint32_t strings_size;
+    uint32_t generation;    // Bumped on every rewrite (also keeps records 8-byte aligned)
+} LibraryHeader;
+
+// System sections double as the per-folder stats cache (game counts, sizes)
+typedef struct {
+    uint32_t name_offset;   // Folder name in the string table
+    uint32_t dir_mtime;     // Folder mtime when the section was built
+    uint32_t first_rom;     // Index of the first ROM record
+    uint32_t rom_count;
+    uint32_t subdir_count;  // Visible subfolders (a folder of folders is not empty)
+    uint32_t newest_mtime;  // Most recent ROM mtime in the folder
+    uint64_t total_bytes;
+} LibrarySystem;
+
+typedef struct {
+    uint32_t name_offset;   // File name in the string table
+    uint32_t size;
+    uint32_t mtime;
+    uint16_t system_id;     // Index into the system table
+    uint16_t flags;
+} LibraryRom;
+
+// Set the ROMs root and cache file (call before load/refresh)
+void library_init(const char *roms_path, const char *cache_path);
+
+// Load the catalog cache with one read, returns 1 if a valid cache was loaded
+int library_load(void);
+
+// Bring the catalog up to date: systems whose folder mtime changed are
+// rescanned, unchanged ones are reused. on_rescan (optional) is called before
+// each folder scan. Returns the number of rescanned systems.
+int library_refresh(void (*on_rescan)(const char *system_name));
+
+// Drop all cached sections and rescan every system folder
+void library_rebuild(void (*on_rescan)(const char *system_name));
+
+// Free catalog memory
+void library_free(void);
+
+// System table access
+int library_get_system_count(void);
+const LibrarySystem* library_get_system(int system_id);
+const char* library_get_system_name(int system_id);
+
+// Find a system by folder name (hashed, case-insensitive), -1 if unknown
+int library_find_system(const char *folder_name);
+
+// Catalog generation, changes whenever the catalog is rewritten. Indexes
+// derived from the catalog store it to detect that they are stale.
+uint32_t library_get_generation(void);
+
+// ROM table access
+int library_get_rom_count(void);
+const LibraryRom* library_get_rom(int rom_index);
+const char* library_get_rom_name(int rom_index);
+
+// Pick a random ROM index in O(1): uniform over all games, or uniform over
+// non-empty systems first when per_system is set. Returns -1 if empty.
+int library_pick_random_rom(int per_system);
+
+// Build the full path of a ROM ("<roms_path>/<system>/<file>")
+void library_get_rom_path(int rom_index, char *path, size_t path_size);
+
+// Record a file operation already done in a system folder, without a rescan.
+// The section (stats and folder mtime included) is updated in memory and the
+// catalog generation bumped; library_save() writes it back. Return 1 if the
+// catalog changed.
+int library_add_rom(const char *system_name, const char *rom_name, uint32_t size, uint32_t mtime);
+int library_remove_rom(const char *system_name, const char *rom_name);
+int library_rename_rom(const char *system_name, const char *old_name, const char *new_name);
+
+// Write the catalog if it was edited in memory since the last write
+void library_save(void);
+
+#endif // LIBRARY_H
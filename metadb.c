@@ -0,0 +1,218 @@
+#include "metadb.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef SF2000
+#include "../../debug.h"
+#else
+#define xlog printf
+#endif
+
+// Loaded table - a single buffer laid out exactly like the file
+static uint8_t *metadb_data = NULL;
+static const MetaDbHeader *metadb_header = NULL;
+static const uint32_t *metadb_block_start = NULL;
+static const MetaDbRecord *metadb_records = NULL;
+static const MetaDbCrc *metadb_crcs = NULL;
+static const uint8_t *metadb_keys = NULL;
+static const char *metadb_strings = NULL;
+
+// System the table (or its absence) belongs to, so reopening costs nothing
+static char metadb_system[64] = "";
+static int metadb_checked = 0;
+
+int metadb_make_key(const char *file_name, char *key, size_t key_size) {
+    const char *end = strrchr(file_name, '.');
+    if (!end || end == file_name) end = file_name + strlen(file_name);
+
+    size_t len = end - file_name;
+    if (len > METADB_KEY_MAX || len >= key_size) return -1;
+
+    for (size_t i = 0; i < len; i++) {
+        char c = file_name[i];
+        key[i] = (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+    }
+    key[len] = '\0';
+    return (int)len;
+}
+
+void metadb_close(void) {
+    free(metadb_data);
+    metadb_data = NULL;
+    metadb_header = NULL;
+    metadb_system[0] = '\0';
+    metadb_checked = 0;
+}
+
+// Check the layout of a loaded file and point the tables into it
+static int metadb_attach(uint8_t *data, size_t size) {
+    if (size < sizeof(MetaDbHeader)) return 0;
+
+    const MetaDbHeader *header = (const MetaDbHeader*)data;
+    if (header->magic != METADB_MAGIC ||
+        header->version != METADB_VERSION ||
+        header->block_size != METADB_BLOCK_SIZE ||
+        header->block_count != (header->entry_count + METADB_BLOCK_SIZE - 1) / METADB_BLOCK_SIZE) {
+        return 0;
+    }
+
+    size_t expected = sizeof(MetaDbHeader) +
+                      (size_t)header->block_count * sizeof(uint32_t) +
+                      (size_t)header->entry_count * sizeof(MetaDbRecord) +
+                      (size_t)header->crc_count * sizeof(MetaDbCrc) +
+                      header->keys_size + header->strings_size;
+    if (size != expected || header->strings_size == 0 || data[size - 1] != '\0') {
+        return 0;
+    }
+
+    metadb_header = header;
+    metadb_block_start = (const uint32_t*)(data + sizeof(MetaDbHeader));
+    metadb_records = (const MetaDbRecord*)(metadb_block_start + header->block_count);
+    metadb_crcs = (const MetaDbCrc*)(metadb_records + header->entry_count);
+    metadb_keys = (const uint8_t*)(metadb_crcs + header->crc_count);
+    metadb_strings = (const char*)(metadb_keys + header->keys_size);
+
+    for (uint32_t b = 0; b < header->block_count; b++) {
+        if (metadb_block_start[b] >= header->keys_size ||
+            metadb_block_start[b] + 1 + metadb_keys[metadb_block_start[b]] > header->keys_size) {
+            return 0;
+        }
+    }
+    for (uint32_t i = 0; i < header->entry_count; i++) {
+        if (metadb_records[i].title_offset >= header->strings_size ||
+            metadb_records[i].region_offset >= header->strings_size) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int metadb_open(const char *system_name) {
+    if (metadb_checked && strcmp(metadb_system, system_name) == 0) {
+        return metadb_data != NULL;
+    }
+
+    metadb_close();
+    strncpy(metadb_system, system_name, sizeof(metadb_system) - 1);
+    metadb_system[sizeof(metadb_system) - 1] = '\0';
+    metadb_checked = 1;
+
+    char path[256];
+    snprintf(path, sizeof(path), METADB_PATTERN, system_name);
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return 0;
+
+    fseek(fp, 0, SEEK_END);
+    long file_size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    uint8_t *data = file_size > 0 ? (uint8_t*)malloc(file_size) : NULL;
+    if (!data) {
+        fclose(fp);
+        return 0;
+    }
+
+    // Whole table in one read
+    size_t read_bytes = fread(data, 1, file_size, fp);
+    fclose(fp);
+
+    if (read_bytes != (size_t)file_size || !metadb_attach(data, file_size)) {
+        metadb_header = NULL;
+        free(data);
+        return 0;
+    }
+
+    metadb_data = data;
+    xlog("MetaDb: loaded %u games for %s\n", (unsigned)metadb_header->entry_count, system_name);
+    return 1;
+}
+
+static void fill_info(uint32_t entry, GameInfo *info) {
+    const MetaDbRecord *record = &metadb_records[entry];
+    info->title = metadb_strings + record->title_offset;
+    info->region = metadb_strings + record->region_offset;
+    info->year = record->year;
+}
+
+// Compare the head key of a block with key
+static int compare_block_head(uint32_t block, const char *key, size_t key_len) {
+    const uint8_t *head = metadb_keys + metadb_block_start[block];
+    size_t head_len = head[0];
+    size_t n = head_len < key_len ? head_len : key_len;
+    int result = memcmp(head + 1, key, n);
+    if (result != 0) return result;
+    return (head_len > key_len) - (head_len < key_len);
+}
+
+int metadb_find_name(const char *file_name, GameInfo *info) {
+    if (!metadb_header || metadb_header->entry_count == 0) return 0;
+
+    char key[METADB_KEY_MAX + 1];
+    int key_len = metadb_make_key(file_name, key, sizeof(key));
+    if (key_len < 0) return 0;
+
+    // Last block whose head is not after the key
+    int lo = 0;
+    int hi = (int)metadb_header->block_count - 1;
+    if (compare_block_head(0, key, key_len) > 0) return 0;
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (compare_block_head(mid, key, key_len) <= 0) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    // Rebuild the keys of the block one by one
+    uint32_t first = (uint32_t)lo * METADB_BLOCK_SIZE;
+    uint32_t count = metadb_header->entry_count - first;
+    if (count > METADB_BLOCK_SIZE) count = METADB_BLOCK_SIZE;
+
+    const uint8_t *p = metadb_keys + metadb_block_start[lo];
+    const uint8_t *keys_end = metadb_keys + metadb_header->keys_size;
+    char current[METADB_KEY_MAX + 1];
+    size_t current_len = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        size_t prefix = 0;
+        if (i > 0) {
+            if (p >= keys_end) return 0;
+            prefix = *p++;
+        }
+        if (p >= keys_end) return 0;
+        size_t suffix = *p++;
+        if (prefix > current_len || prefix + suffix > METADB_KEY_MAX || p + suffix > keys_end) return 0;
+
+        memcpy(current + prefix, p, suffix);
+        p += suffix;
+        current_len = prefix + suffix;
+
+        if (current_len == (size_t)key_len && memcmp(current, key, key_len) == 0) {
+            fill_info(first + i, info);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int metadb_find_crc(uint32_t crc, GameInfo *info) {
+    if (!metadb_header) return 0;
+
+    int lo = 0;
+    int hi = (int)metadb_header->crc_count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (metadb_crcs[mid].crc == crc) {
+            if (metadb_crcs[mid].entry >= metadb_header->entry_count) return 0;
+            fill_info(metadb_crcs[mid].entry, info);
+            return 1;
+        }
+        if (metadb_crcs[mid].crc < crc) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+#ifndef METADB_H
+#define METADB_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Per-system game metadata (clean title, region, year), compiled on the host
+// from No-Intro / libretro DAT files by tools/metadb.c and loaded with one
+// read when a system folder is opened.
+//
+// Games are keyed by ROM file name: lowercase, extension dropped. Keys are
+// sorted and front-coded in blocks of METADB_BLOCK_SIZE (the first key of a
+// block whole, the others as prefix length + suffix), so a lookup is a
+// binary search over block heads plus a short scan. ROM CRCs have their own
+// sorted table.
+//
+// File layout (native little-endian):
+//   MetaDbHeader
+//   uint32_t block_start[block_count]    offset of each block in keys
+//   MetaDbRecord[entry_count]            in key order
+//   MetaDbCrc[crc_count]                 sorted by crc
+//   uint8_t keys[keys_size]              head: len, bytes; others: prefix, len, bytes
+//   char strings[strings_size]           titles and regions, shared
+#define METADB_PATTERN "/mnt/sda1/configs/frogui_meta_%s.db"
+#define METADB_MAGIC 0x444D4746  // "FGMD"
+#define METADB_VERSION 1
+#define METADB_BLOCK_SIZE 16
+#define METADB_KEY_MAX 255
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t block_size;
+    uint32_t entry_count;
+    uint32_t block_count;
+    uint32_t crc_count;
+    uint32_t keys_size;
+    uint32_t strings_size;
+    uint32_t reserved;
+} MetaDbHeader;
+
+typedef struct {
+    uint32_t title_offset;  // In strings
+    uint32_t region_offset; // In strings ("" if unknown)
+    uint16_t year;          // 0 if unknown
+    uint16_t reserved;
+} MetaDbRecord;
+
+typedef struct {
+    uint32_t crc;
+    uint32_t entry;         // Record index
+} MetaDbCrc;
+
+// Lookup result; strings stay valid until another system's table is opened
+typedef struct {
+    const char *title;
+    const char *region;
+    int year;
+} GameInfo;
+
+// Lookup key of a file name (lowercase, extension dropped). Returns its
+// length, -1 if it does not fit.
+int metadb_make_key(const char *file_name, char *key, size_t key_size);
+
+// Load the table of a system folder (kept if already loaded). Returns 1 if
+// the system has one.
+int metadb_open(const char *system_name);
+
+// Free the loaded table
+void metadb_close(void);
+
+// Metadata for a ROM file name or CRC, 1 if found
+int metadb_find_name(const char *file_name, GameInfo *info);
+int metadb_find_crc(uint32_t crc, GameInfo *info);
+
+#endif // METADB_H
@@ -6,6 +6,9 @@
 static RecentGame recent_games[MAX_RECENT_GAMES];
 static int recent_count = 0;
 
+// "Game (folder)", both cut short to fit display_name
+#define RECENT_DISPLAY_FORMAT "%.200s (%.50s)"
+
 void recent_games_init(void) {
     recent_count = 0;
     recent_games_load();
@@ -29,26 +32,29 @@ void recent_games_load(void) {
         char *separator1 = strchr(line, '|');
         if (separator1) {
             *separator1 = '\0';
+            SystemId system = systems_intern(line);
+            if (system == SYSTEM_ID_NONE) continue;
+
             char *separator2 = strchr(separator1 + 1, '|');
             if (separator2) {
                 *separator2 = '\0';
-                strncpy(recent_games[recent_count].core_name, line, sizeof(recent_games[recent_count].core_name) - 1);
+                recent_games[recent_count].system = system;
                 strncpy(recent_games[recent_count].game_name, separator1 + 1, sizeof(recent_games[recent_count].game_name) - 1);
                 strncpy(recent_games[recent_count].full_path, separator2 + 1, sizeof(recent_games[recent_count].full_path) - 1);
                 
                 // Create display name
                 snprintf(recent_games[recent_count].display_name, sizeof(recent_games[recent_count].display_name),
-                        "%s (%s)", recent_games[recent_count].game_name, recent_games[recent_count].core_name);
+                        RECENT_DISPLAY_FORMAT, separator1 + 1, line);
                 
                 recent_count++;
             } else {
                 // Old format fallback: "core_name|game_name" 
-                strncpy(recent_games[recent_count].core_name, line, sizeof(recent_games[recent_count].core_name) - 1);
+                recent_games[recent_count].system = system;
                 strncpy(recent_games[recent_count].game_name, separator1 + 1, sizeof(recent_games[recent_count].game_name) - 1);
                 recent_games[recent_count].full_path[0] = '\0'; // No path available
                 
                 snprintf(recent_games[recent_count].display_name, sizeof(recent_games[recent_count].display_name),
-                        "%s (%s)", recent_games[recent_count].game_name, recent_games[recent_count].core_name);
+                        RECENT_DISPLAY_FORMAT, separator1 + 1, line);
                 
                 recent_count++;
             }
@@ -63,17 +69,19 @@ void recent_games_save(void) {
     if (!fp) return;
     
     for (int i = 0; i < recent_count; i++) {
-        fprintf(fp, "%s|%s|%s\n", recent_games[i].core_name, recent_games[i].game_name, recent_games[i].full_path);
+        fprintf(fp, "%s|%s|%s\n", systems_folder(recent_games[i].system), recent_games[i].game_name, recent_games[i].full_path);
     }
     
     fclose(fp);
 }
 
-void recent_games_add(const char *core_name, const char *game_name, const char *full_path) {
+void recent_games_add(SystemId system, const char *game_name, const char *full_path) {
+    if (system == SYSTEM_ID_NONE) return;
+
     // Check if game already exists
     int existing_index = -1;
     for (int i = 0; i < recent_count; i++) {
-        if (strcmp(recent_games[i].core_name, core_name) == 0 && 
+        if (recent_games[i].system == system &&
             strcmp(recent_games[i].game_name, game_name) == 0) {
             existing_index = i;
             break;
@@ -99,16 +107,59 @@ void recent_games_add(const char *core_name, const char *game_name, const char *
         }
         
         // Add new game at top
-        strncpy(recent_games[0].core_name, core_name, sizeof(recent_games[0].core_name) - 1);
+        recent_games[0].system = system;
         strncpy(recent_games[0].game_name, game_name, sizeof(recent_games[0].game_name) - 1);
         strncpy(recent_games[0].full_path, full_path, sizeof(recent_games[0].full_path) - 1);
         snprintf(recent_games[0].display_name, sizeof(recent_games[0].display_name),
-                "%s (%s)", game_name, core_name);
+                RECENT_DISPLAY_FORMAT, game_name, systems_folder(system));
     }
     
     recent_games_save();
 }
 
+static int recent_games_find(SystemId system, const char *game_name) {
+    for (int i = 0; i < recent_count; i++) {
+        if (recent_games[i].system == system &&
+            strcmp(recent_games[i].game_name, game_name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void recent_games_remove(SystemId system, const char *game_name) {
+    int index = recent_games_find(system, game_name);
+    if (index < 0) return;
+
+    for (int i = index; i < recent_count - 1; i++) {
+        recent_games[i] = recent_games[i + 1];
+    }
+    recent_count--;
+    recent_games_save();
+}
+
+void recent_games_rename(SystemId system, const char *old_name, const char *new_name, const char *new_path) {
+    int index = recent_games_find(system, old_name);
+    if (index < 0) return;
+
+    // The new name may already be listed (a file that was deleted since)
+    int existing = recent_games_find(system, new_name);
+    if (existing >= 0) {
+        for (int i = existing; i < recent_count - 1; i++) {
+            recent_games[i] = recent_games[i + 1];
+        }
+        recent_count--;
+        if (existing < index) index--;
+    }
+
+    RecentGame *game = &recent_games[index];
+    snprintf(game->game_name, sizeof(game->game_name), "%.255s", new_name);
+    snprintf(game->full_path, sizeof(game->full_path), "%.511s", new_path);
+    snprintf(game->display_name, sizeof(game->display_name),
+             RECENT_DISPLAY_FORMAT, new_name, systems_folder(system));
+    recent_games_save();
+}
+
 const RecentGame* recent_games_get_list(void) {
     return recent_games;
 }
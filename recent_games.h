@@ -1,12 +1,14 @@
 #ifndef RECENT_GAMES_H
 #define RECENT_GAMES_H
 
+#include "systems.h"
+
 #define MAX_RECENT_GAMES 10
 #define HISTORY_FILE "/mnt/sda1/game_history.txt"
 
-// Recent games structure
+// Recent games structure; the history file keeps the system folder name
 typedef struct {
-    char core_name[256];
+    SystemId system;      // Folder the game was launched from
     char game_name[256];
     char display_name[256];
     char full_path[512];  // Full path for thumbnail lookup
@@ -22,7 +24,12 @@ void recent_games_load(void);
 void recent_games_save(void);
 
 // Add game to recent history (moves to top if already exists)
-void recent_games_add(const char *core_name, const char *game_name, const char *full_path);
+void recent_games_add(SystemId system, const char *game_name, const char *full_path);
+
+// The game's file was deleted or renamed from the menu: drop it from the
+// history, or rename it there (new_path is its new full path)
+void recent_games_remove(SystemId system, const char *game_name);
+void recent_games_rename(SystemId system, const char *old_name, const char *new_name, const char *new_path);
 
 // Get recent games list
 const RecentGame* recent_games_get_list(void);
@@ -1,12 +1,19 @@
 #include "render.h"
 #include "theme.h"
 #include "font.h"
+#include "hash.h"
+#include "thumbcodec.h"
+#include "thumbimage.h"
+#include "sysicons.h"
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
+#include <time.h>
 #include <unistd.h>
 #include <dirent.h>
+#include <sys/stat.h>
 
 #ifndef min
 #define min(a, b) ((a) < (b) ? (a) : (b))
@@ -139,12 +146,12 @@ void render_legend(uint16_t *framebuffer, int x_button_mode) {
     }
 }
 
-void render_menu_item(uint16_t *framebuffer, int index, const char *name, int is_dir,
-                     int is_selected, int scroll_offset, int is_favorited) {
-    if (!framebuffer || !name) return;
+int render_menu_item(uint16_t *framebuffer, int index, const char *name, int is_dir,
+                     int is_selected, int scroll_offset, int is_favorited, int icon) {
+    if (!framebuffer || !name) return 0;
 
     int visible_index = index - scroll_offset;
-    if (visible_index < 0 || visible_index >= VISIBLE_ENTRIES) return;
+    if (visible_index < 0 || visible_index >= VISIBLE_ENTRIES) return 0;
 
     int y = START_Y + (visible_index * ITEM_HEIGHT);
 
@@ -156,14 +163,41 @@ void render_menu_item(uint16_t *framebuffer, int index, const char *name, int is
         text_x = PADDING + 15; // Offset text to the right of the star
     }
 
+    // System icon column, clear of the selection pillbox
+    if (icon != SYSICON_NONE) {
+        if (icon >= 0) {
+            // Centred on the text line
+            sysicons_draw(framebuffer, icon, text_x, y + (FONT_CHAR_HEIGHT - sysicons_height()) / 2);
+        }
+        text_x += sysicons_width() + 8;
+    }
+
     if (is_selected) {
-        // Use unified pillbox rendering
+        // Use unified pillbox rendering (7 px of padding past the text)
         render_text_pillbox(framebuffer, text_x, y, name, COLOR_SELECT_BG, COLOR_SELECT_TEXT, 7);
-    } else {
-        // Draw normal text
-        uint16_t text_color = is_dir ? COLOR_FOLDER : COLOR_TEXT;
-        font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, text_x, y, name, text_color);
+        return text_x + font_measure_text(name) + 7;
     }
+
+    // Draw normal text
+    uint16_t text_color = is_dir ? COLOR_FOLDER : COLOR_TEXT;
+    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, text_x, y, name, text_color);
+    return text_x + font_measure_text(name);
+}
+
+void render_menu_item_detail(uint16_t *framebuffer, int index, int scroll_offset, const char *text,
+                             int item_right) {
+    if (!framebuffer) return;
+
+    int visible_index = index - scroll_offset;
+    if (visible_index < 0 || visible_index >= VISIBLE_ENTRIES) return;
+
+    int y = START_Y + (visible_index * ITEM_HEIGHT);
+
+    // Leave it out rather than draw over a long name or the selection pillbox
+    int text_width = font_measure_text(text);
+    int x = SCREEN_WIDTH - text_width - PADDING;
+    if (x < item_right + 8) return;
+    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, x, y, text, COLOR_DISABLED);
 }
 
 // Thumbnail implementation
@@ -221,69 +255,992 @@ int load_thumbnail(const char *rgb565_path, Thumbnail *thumb) {
     thumb->width = 0;
     thumb->height = 0;
     
-    // Just use the raw RGB565 loader - no parsing, no dynamic allocation
-    return load_raw_rgb565(rgb565_path, thumb);
+    // Raw RGB565 files through the cache - no parsing, no dynamic allocation
+    return thumbnail_cache_get(rgb565_path, thumb);
+}
+
+// Thumbnail cache - static slots, no malloc/free hell
+#define THUMB_CACHE_EMPTY 0
+#define THUMB_CACHE_LOADED 1
+#define THUMB_CACHE_MISSING 2   // No usable file at the path
+
+typedef struct {
+    int state;
+    uint32_t path_hash;
+    uint32_t last_used;         // LRU tick
+    char path[512];
+    Thumbnail thumb;
+} ThumbnailCacheSlot;
+
+static ThumbnailCacheSlot thumbnail_cache[THUMBNAIL_CACHE_SLOTS];
+static uint16_t thumbnail_cache_pixels[THUMBNAIL_CACHE_SLOTS][THUMBNAIL_MAX_PIXELS];
+static uint32_t thumbnail_cache_tick = 0;
+static int thumbnail_cache_shown = -1;  // Slot returned by the last get, never replaced by a prefetch
+
+static int thumbnail_names_may_exist(const char *path, int build, int *was_read);
+static void thumbnail_names_forget(const char *dir, size_t dir_len);
+static void thumbnail_names_written(const char *path, int exists);
+static void thumbnail_names_clear(void);
+static int thumbnail_source_start(const char *path, int take_over);
+
+static int thumbnail_cache_find(const char *path, uint32_t path_hash) {
+    for (int i = 0; i < THUMBNAIL_CACHE_SLOTS; i++) {
+        const ThumbnailCacheSlot *slot = &thumbnail_cache[i];
+        if (slot->state != THUMB_CACHE_EMPTY && slot->path_hash == path_hash && strcmp(slot->path, path) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Least recently used slot other than keep, -1 if there is none
+static int thumbnail_cache_victim(int keep) {
+    int index = -1;
+    for (int i = 0; i < THUMBNAIL_CACHE_SLOTS; i++) {
+        if (i == keep) continue;
+        if (index < 0 || thumbnail_cache[i].state == THUMB_CACHE_EMPTY ||
+            (thumbnail_cache[index].state != THUMB_CACHE_EMPTY &&
+             thumbnail_cache[i].last_used < thumbnail_cache[index].last_used)) {
+            index = i;
+        }
+    }
+    return index;
+}
+
+static void thumbnail_cache_set_path(ThumbnailCacheSlot *slot, const char *path, uint32_t path_hash) {
+    slot->path_hash = path_hash;
+    size_t len = strlen(path);
+    if (len >= sizeof(slot->path)) len = sizeof(slot->path) - 1;
+    memcpy(slot->path, path, len);
+    slot->path[len] = '\0';
+}
+
+// Find the path or read it into the least recently used slot (skipping keep).
+// A thumbnail still to be made from source art gets no slot; the first
+// caller with take_over set starts the decoder on it.
+static int thumbnail_cache_fill(const char *path, int keep, int take_over, int *was_read) {
+    uint32_t path_hash = hash_string(path);
+    int index = thumbnail_cache_find(path, path_hash);
+    *was_read = 0;
+
+    // Known missing from its folder's listing: no slot and no file access
+    if (index < 0 && !thumbnail_names_may_exist(path, 1, was_read)) {
+        return -1;
+    }
+
+    if (index < 0) {
+        index = thumbnail_cache_victim(keep);
+        if (index < 0) return -1;   // Single slot, and it is kept
+        *was_read = 1;
+
+        ThumbnailCacheSlot *slot = &thumbnail_cache[index];
+        if (load_thumbnail_file(path, &slot->thumb, thumbnail_cache_pixels[index], THUMBNAIL_MAX_PIXELS)) {
+            slot->state = THUMB_CACHE_LOADED;
+        } else if (thumbnail_source_start(path, take_over)) {
+            slot->state = THUMB_CACHE_EMPTY;
+            return -1;
+        } else {
+            slot->state = THUMB_CACHE_MISSING;
+        }
+        thumbnail_cache_set_path(slot, path, path_hash);
+    }
+
+    thumbnail_cache[index].last_used = ++thumbnail_cache_tick;
+    return index;
+}
+
+int thumbnail_cache_get(const char *path, Thumbnail *thumb) {
+    int was_read;
+    int index = thumbnail_cache_fill(path, -1, 1, &was_read);
+    thumbnail_cache_shown = index;
+    if (index < 0 || thumbnail_cache[index].state != THUMB_CACHE_LOADED) {
+        return 0;
+    }
+    *thumb = thumbnail_cache[index].thumb;
+    return 1;
+}
+
+int thumbnail_cache_prefetch(const char *path) {
+    int was_read;
+    thumbnail_cache_fill(path, thumbnail_cache_shown, 0, &was_read);
+    return was_read;
+}
+
+int thumbnail_cache_has(const char *path) {
+    int was_read;
+    return thumbnail_cache_find(path, hash_string(path)) >= 0 || !thumbnail_names_may_exist(path, 0, &was_read);
+}
+
+// Compressed thumbnails are read here and decoded into the cache slot
+static uint8_t thumbnail_read_buffer[THUMBCODEC_PAL8_MAX_SIZE(THUMBNAIL_MAX_PIXELS)];
+
+// Read size bytes of pixel data in format from fp and fill in thumb
+#ifdef THUMBNAIL_TIMING
+// Device-side load times (make THUMBNAIL_TIMING=1): read and decode time of
+// the thumbnails loaded, logged every THUMBNAIL_TIMING_LOADS loads. Timed
+// with the C library's clock(), so only as fine as the firmware's tick.
+#define xlog printf
+#define THUMBNAIL_TIMING_LOADS 32
+static clock_t timing_read;
+static clock_t timing_decode;
+static uint32_t timing_bytes;
+static int timing_loads;
+
+static void thumbnail_timing_add(clock_t start, clock_t read_done, uint32_t size) {
+    clock_t end = clock();
+    timing_read += read_done - start;
+    timing_decode += end - read_done;
+    timing_bytes += size;
+    if (++timing_loads == THUMBNAIL_TIMING_LOADS) {
+        xlog("Thumbnails: %d loads, %lu bytes, read %.1f ms, decode %.1f ms\n", timing_loads,
+             (unsigned long)timing_bytes, timing_read * 1000.0 / CLOCKS_PER_SEC,
+             timing_decode * 1000.0 / CLOCKS_PER_SEC);
+        timing_read = timing_decode = 0;
+        timing_bytes = 0;
+        timing_loads = 0;
+    }
+}
+#endif
+
+static int read_thumbnail_data(FILE *fp, int format, uint32_t size, int width, int height, int flags,
+                               Thumbnail *thumb, uint16_t *buffer, int buffer_pixels) {
+    int pixels = width * height;
+    if (pixels == 0 || pixels > buffer_pixels) return 0;
+
+#ifdef THUMBNAIL_TIMING
+    clock_t start = clock();
+#endif
+    if (format == THUMBNAIL_FORMAT_RGB565) {
+        // One read straight into the cache slot
+        if (size != (uint32_t)pixels * 2 || fread(buffer, 1, size, fp) != size) return 0;
+#ifdef THUMBNAIL_TIMING
+        thumbnail_timing_add(start, clock(), size);
+#endif
+    } else {
+        if (size > sizeof(thumbnail_read_buffer) ||
+            fread(thumbnail_read_buffer, 1, size, fp) != size) {
+            return 0;
+        }
+#ifdef THUMBNAIL_TIMING
+        clock_t read_done = clock();
+#endif
+        if (!thumbcodec_decode(format, thumbnail_read_buffer, size, buffer, pixels)) return 0;
+#ifdef THUMBNAIL_TIMING
+        thumbnail_timing_add(start, read_done, size);
+#endif
+    }
+
+    // Only trust the pre-scaled flag for art that fits the area
+    flags &= THUMBNAIL_FLAG_PRESCALED;
+    if (width > THUMBNAIL_MAX_WIDTH || height > THUMBNAIL_MAX_HEIGHT) {
+        flags = 0;
+    }
+    thumb->data = buffer;
+    thumb->width = width;
+    thumb->height = height;
+    thumb->flags = flags;
+    return 1;
+}
+
+void thumbnail_cache_clear(void) {
+    for (int i = 0; i < THUMBNAIL_CACHE_SLOTS; i++) {
+        thumbnail_cache[i].state = THUMB_CACHE_EMPTY;
+    }
+    thumbnail_cache_shown = -1;
+    thumbnail_pack_close();
+    thumbnail_names_clear();
+}
+
+// The menu added, removed or renamed this thumbnail file
+static void thumbnail_cache_file_changed(const char *path) {
+    int index = thumbnail_cache_find(path, hash_string(path));
+    if (index >= 0) {
+        thumbnail_cache[index].state = THUMB_CACHE_EMPTY;
+        if (index == thumbnail_cache_shown) thumbnail_cache_shown = -1;
+    }
+
+    // The menu's own change does not wait for a recheck
+    const char *slash = strrchr(path, '/');
+    if (slash) thumbnail_names_forget(path, slash - path);
+}
+
+// Pack of the last folder a thumbnail was loaded from, kept open
+static char pack_dir[512] = "";
+static int pack_checked = 0;            // pack_dir was looked at (pack_file NULL = no pack)
+static FILE *pack_file = NULL;
+static ThumbnailPackEntry *pack_slots = NULL;
+static uint32_t pack_slot_count = 0;
+static long pack_file_size = 0;
+
+
+void thumbnail_pack_close(void) {
+    if (pack_file) {
+        fclose(pack_file);
+        pack_file = NULL;
+    }
+    free(pack_slots);
+    pack_slots = NULL;
+    pack_slot_count = 0;
+    pack_dir[0] = '\0';
+    pack_checked = 0;
 }
 
-// Static buffer for thumbnail - no malloc/free hell
-static uint16_t thumbnail_buffer[250 * 200]; // Max size: 250x200
+// Open the pack of a .res folder and read its index (once per folder)
+static int thumbnail_pack_open(const char *dir, size_t dir_len) {
+    if (pack_checked && strlen(pack_dir) == dir_len && strncmp(pack_dir, dir, dir_len) == 0) {
+        return pack_file != NULL;
+    }
+
+    thumbnail_pack_close();
+    if (dir_len >= sizeof(pack_dir)) return 0;
+    memcpy(pack_dir, dir, dir_len);
+    pack_dir[dir_len] = '\0';
+    pack_checked = 1;
+
+    char pack_path[600];
+    snprintf(pack_path, sizeof(pack_path), "%s/" THUMBNAIL_PACK_NAME, pack_dir);
+    FILE *fp = fopen(pack_path, "rb");
+    if (!fp) return 0;
+
+    ThumbnailPackHeader header;
+    fseek(fp, 0, SEEK_END);
+    long file_size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (fread(&header, sizeof(header), 1, fp) != 1 ||
+        header.magic != THUMBNAIL_PACK_MAGIC || header.version != THUMBNAIL_PACK_VERSION ||
+        header.slot_count == 0 || header.slot_count > THUMBNAIL_PACK_MAX_SLOTS ||
+        (header.slot_count & (header.slot_count - 1)) != 0 ||
+        (long)(sizeof(header) + header.slot_count * sizeof(ThumbnailPackEntry)) > file_size) {
+        fclose(fp);
+        return 0;
+    }
+
+    // Whole index in one read
+    ThumbnailPackEntry *slots = (ThumbnailPackEntry*)malloc(header.slot_count * sizeof(ThumbnailPackEntry));
+    if (!slots || fread(slots, sizeof(ThumbnailPackEntry), header.slot_count, fp) != header.slot_count) {
+        free(slots);
+        fclose(fp);
+        return 0;
+    }
+
+    pack_file = fp;
+    pack_slots = slots;
+    pack_slot_count = header.slot_count;
+    pack_file_size = file_size;
+    return 1;
+}
+
+// Entry of a file name in the open pack, NULL if it is not packed
+static const ThumbnailPackEntry *thumbnail_pack_find(const char *name) {
+    uint32_t name_hash = hash_string(name);
+    uint32_t name_check = hash_string_seeded(name, THUMBNAIL_PACK_CHECK_SEED);
+    uint32_t mask = pack_slot_count - 1;
+    for (uint32_t probe = 0; probe < pack_slot_count; probe++) {
+        const ThumbnailPackEntry *entry = &pack_slots[(name_hash + probe) & mask];
+        if (entry->size == 0) return NULL;
+        if (entry->name_hash == name_hash && entry->name_check == name_check) return entry;
+    }
+    return NULL;
+}
+
+// 1 if loaded, 0 if the pack does not have the file, -1 if its data is bad
+static int thumbnail_pack_load(const char *name, Thumbnail *thumb, uint16_t *buffer, int buffer_pixels) {
+    const ThumbnailPackEntry *entry = thumbnail_pack_find(name);
+    if (!entry) return 0;
+
+    if (entry->offset > (uint32_t)pack_file_size || entry->size > (uint32_t)pack_file_size - entry->offset ||
+        fseek(pack_file, entry->offset, SEEK_SET) != 0) {
+        return -1;
+    }
+    return read_thumbnail_data(pack_file, entry->format, entry->size, entry->width, entry->height,
+                               entry->flags, thumb, buffer, buffer_pixels) ? 1 : -1;
+}
+
+// Last preview read - one is shown at a time
+static ThumbnailPreview thumbnail_preview;
+
+int thumbnail_cache_preview(const char *path, Thumbnail *thumb) {
+    const char *slash = strrchr(path, '/');
+    if (!slash || !thumbnail_pack_open(path, slash - path)) return 0;
+
+    const ThumbnailPackEntry *entry = thumbnail_pack_find(slash + 1);
+    if (!entry || !(entry->flags & THUMBNAIL_FLAG_HAS_PREVIEW) ||
+        entry->offset < sizeof(ThumbnailPreview) || entry->offset > (uint32_t)pack_file_size) {
+        return 0;
+    }
+
+    // One small read just before the full image
+    if (fseek(pack_file, entry->offset - sizeof(ThumbnailPreview), SEEK_SET) != 0 ||
+        fread(&thumbnail_preview, sizeof(ThumbnailPreview), 1, pack_file) != 1 ||
+        thumbnail_preview.width == 0 || thumbnail_preview.width > THUMBNAIL_PREVIEW_MAX_WIDTH ||
+        thumbnail_preview.height == 0 || thumbnail_preview.height > THUMBNAIL_PREVIEW_MAX_HEIGHT) {
+        return 0;
+    }
+    thumb->data = thumbnail_preview.pixels;
+    thumb->width = thumbnail_preview.width;
+    thumb->height = thumbnail_preview.height;
+    thumb->flags = THUMBNAIL_FLAG_PREVIEW;
+    return 1;
+}
+
+// Art a missing thumbnail can be made from on the device: .res/<name> with
+// one of these extensions
+#define THUMBNAIL_SOURCE_EXTENSIONS 3
+static const char *thumbnail_source_extensions[THUMBNAIL_SOURCE_EXTENSIONS] = {".png", ".jpg", ".jpeg"};
+
+static int thumbnail_source_extension(const char *ext) {
+    for (int i = 0; i < THUMBNAIL_SOURCE_EXTENSIONS; i++) {
+        if (strcasecmp(ext, thumbnail_source_extensions[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+// Thumbnail names of recently used .res folders, listed once (loose files,
+// source art and the pack index) so a game without a thumbnail is known
+// missing with no file access. A folder's mtime is compared again on its
+// first use after thumbnail_cache_recheck.
+#define THUMBNAIL_NAME_SETS 4
+
+typedef struct {
+    char dir[512];              // .res folder, "" if the set is unused
+    uint32_t mtime;             // Folder mtime the names match, 0 if there is no folder
+    int checked;                // mtime compared since the last recheck
+    uint32_t last_used;
+    uint32_t *hashes;           // Sorted: hash_string_nocase of loose names, hash_string of packed ones
+    int count;
+} ThumbnailNameSet;
+
+static ThumbnailNameSet thumbnail_names[THUMBNAIL_NAME_SETS];
+static uint32_t thumbnail_names_tick = 0;
+static int thumbnail_names_mixed = 0;   // Mixed-folder list: no new sets
+
+static void thumbnail_names_free(ThumbnailNameSet *set) {
+    free(set->hashes);
+    set->hashes = NULL;
+    set->count = 0;
+    set->dir[0] = '\0';
+}
+
+static void thumbnail_names_clear(void) {
+    for (int i = 0; i < THUMBNAIL_NAME_SETS; i++) {
+        thumbnail_names_free(&thumbnail_names[i]);
+    }
+}
+
+void thumbnail_cache_recheck(void) {
+    for (int i = 0; i < THUMBNAIL_NAME_SETS; i++) {
+        thumbnail_names[i].checked = 0;
+    }
+}
+
+void thumbnail_cache_mixed_folders(int mixed) {
+    thumbnail_names_mixed = mixed;
+}
+
+static ThumbnailNameSet *thumbnail_names_find(const char *dir, size_t dir_len) {
+    for (int i = 0; i < THUMBNAIL_NAME_SETS; i++) {
+        ThumbnailNameSet *set = &thumbnail_names[i];
+        if (set->dir[0] && strlen(set->dir) == dir_len && strncmp(set->dir, dir, dir_len) == 0) {
+            return set;
+        }
+    }
+    return NULL;
+}
+
+static void thumbnail_names_forget(const char *dir, size_t dir_len) {
+    ThumbnailNameSet *set = thumbnail_names_find(dir, dir_len);
+    if (set) thumbnail_names_free(set);
+}
+
+// The menu wrote (exists) or removed a loose thumbnail: add its name to its
+// folder's set and take the folder's new mtime, so the set stays in use
+static void thumbnail_names_written(const char *path, int exists) {
+    const char *slash = strrchr(path, '/');
+    if (!slash) return;
+    ThumbnailNameSet *set = thumbnail_names_find(path, slash - path);
+    if (!set) return;
+
+    struct stat st;
+    if (stat(set->dir, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        thumbnail_names_free(set);
+        return;
+    }
+    set->mtime = (uint32_t)st.st_mtime;
+    if (set->mtime == 0) set->mtime = 1;    // 0 stands for no folder
+    if (!exists) return;
+
+    // Sorted insert, unless the name is there already
+    uint32_t name_hash = hash_string_nocase(slash + 1);
+    int position = 0;
+    while (position < set->count && set->hashes[position] < name_hash) position++;
+    if (position < set->count && set->hashes[position] == name_hash) return;
+
+    uint32_t *hashes = (uint32_t*)realloc(set->hashes, (set->count + 1) * sizeof(uint32_t));
+    if (!hashes) {
+        thumbnail_names_free(set);
+        return;
+    }
+    memmove(hashes + position + 1, hashes + position, (set->count - position) * sizeof(uint32_t));
+    hashes[position] = name_hash;
+    set->hashes = hashes;
+    set->count++;
+}
+
+static int compare_hashes(const void *a, const void *b) {
+    uint32_t ha = *(const uint32_t*)a;
+    uint32_t hb = *(const uint32_t*)b;
+    return (ha > hb) - (ha < hb);
+}
+
+static int thumbnail_names_add(ThumbnailNameSet *set, int *capacity, uint32_t name_hash) {
+    if (set->count == *capacity) {
+        int new_capacity = *capacity ? *capacity * 2 : 64;
+        uint32_t *hashes = (uint32_t*)realloc(set->hashes, new_capacity * sizeof(uint32_t));
+        if (!hashes) return 0;
+        set->hashes = hashes;
+        *capacity = new_capacity;
+    }
+    set->hashes[set->count++] = name_hash;
+    return 1;
+}
+
+// List a .res folder into set. Returns 0 if the names could not be read.
+static int thumbnail_names_build(ThumbnailNameSet *set, const char *dir, size_t dir_len, uint32_t mtime) {
+    thumbnail_names_free(set);
+    memcpy(set->dir, dir, dir_len);
+    set->dir[dir_len] = '\0';
+    set->mtime = mtime;
+    set->checked = 1;
+
+    // No .res folder: nothing has a thumbnail
+    if (mtime == 0) return 1;
+
+    DIR *res_dir = opendir(set->dir);
+    if (!res_dir) {
+        set->dir[0] = '\0';
+        return 0;
+    }
+
+    int capacity = 0;
+    int has_pack = 0;
+    int ok = 1;
+    struct dirent *ent;
+    while (ok && (ent = readdir(res_dir)) != NULL) {
+        const char *ext = strrchr(ent->d_name, '.');
+        if (ext && (strcasecmp(ext, ".rgb565") == 0 || thumbnail_source_extension(ext))) {
+            ok = thumbnail_names_add(set, &capacity, hash_string_nocase(ent->d_name));
+        } else if (strcmp(ent->d_name, THUMBNAIL_PACK_NAME) == 0) {
+            has_pack = 1;
+        }
+    }
+    closedir(res_dir);
 
-int load_raw_rgb565(const char *path, Thumbnail *thumb) {
+    // The pack index has the hashes of its names
+    if (ok && has_pack && thumbnail_pack_open(dir, dir_len)) {
+        for (uint32_t i = 0; ok && i < pack_slot_count; i++) {
+            if (pack_slots[i].size != 0) {
+                ok = thumbnail_names_add(set, &capacity, pack_slots[i].name_hash);
+            }
+        }
+    }
+    if (!ok) {
+        thumbnail_names_free(set);
+        return 0;
+    }
+
+    qsort(set->hashes, set->count, sizeof(uint32_t), compare_hashes);
+    return 1;
+}
+
+static int thumbnail_names_contain(const ThumbnailNameSet *set, uint32_t name_hash) {
+    int lo = 0;
+    int hi = set->count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (set->hashes[mid] == name_hash) return 1;
+        if (set->hashes[mid] < name_hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return 0;
+}
+
+// 0 only if the folder listing says there is no such thumbnail. Without
+// build, a folder not listed (or due a recheck) counts as maybe; in a
+// mixed-folder list, a folder not listed is never listed.
+static int thumbnail_names_may_exist(const char *path, int build, int *was_read) {
+    const char *slash = strrchr(path, '/');
+    if (!slash || (size_t)(slash - path) >= sizeof(thumbnail_names[0].dir)) return 1;
+    size_t dir_len = slash - path;
+
+    ThumbnailNameSet *set = thumbnail_names_find(path, dir_len);
+    if (!set || !set->checked) {
+        if (!build || (!set && thumbnail_names_mixed)) return 1;
+
+        struct stat st;
+        char dir[sizeof(thumbnail_names[0].dir)];
+        memcpy(dir, path, dir_len);
+        dir[dir_len] = '\0';
+        *was_read = 1;
+        uint32_t mtime = 0;
+        if (stat(dir, &st) == 0 && S_ISDIR(st.st_mode)) {
+            mtime = (uint32_t)st.st_mtime;
+            if (mtime == 0) mtime = 1;  // 0 stands for no folder
+        }
+
+        if (set && set->mtime == mtime) {
+            set->checked = 1;
+        } else {
+            if (!set) {
+                // Reuse the least recently used set
+                set = &thumbnail_names[0];
+                for (int i = 1; i < THUMBNAIL_NAME_SETS; i++) {
+                    if (!thumbnail_names[i].dir[0] ||
+                        (set->dir[0] && thumbnail_names[i].last_used < set->last_used)) {
+                        set = &thumbnail_names[i];
+                    }
+                }
+            }
+            if (!thumbnail_names_build(set, path, dir_len, mtime)) return 1;
+        }
+    }
+
+    set->last_used = ++thumbnail_names_tick;
+    const char *name = slash + 1;
+    if (thumbnail_names_contain(set, hash_string_nocase(name)) ||
+        thumbnail_names_contain(set, hash_string(name))) {
+        return 1;
+    }
+
+    // Source art the thumbnail can be made from
+    const char *dot = strrchr(name, '.');
+    size_t base_len = dot ? (size_t)(dot - name) : strlen(name);
+    for (int i = 0; i < THUMBNAIL_SOURCE_EXTENSIONS; i++) {
+        char source[256];
+        if (base_len + strlen(thumbnail_source_extensions[i]) >= sizeof(source)) break;
+        memcpy(source, name, base_len);
+        strcpy(source + base_len, thumbnail_source_extensions[i]);
+        if (thumbnail_names_contain(set, hash_string_nocase(source))) return 1;
+    }
+    return 0;
+}
+
+// Legacy headerless files: raw RGB565 of one of these sizes
+static const int legacy_dimensions[][2] = {{64,64}, {128,128}, {160,160}, {200,200}, {250,200}, {200,250}};
+
+static int load_thumbnail_loose(const char *path, Thumbnail *thumb, uint16_t *buffer, int buffer_pixels) {
     // Check if file exists
     if (access(path, F_OK) != 0) {
         return 0;
     }
-    
+
     FILE *fp = fopen(path, "rb");
     if (!fp) {
         return 0;
     }
-    
+
     fseek(fp, 0, SEEK_END);
     long file_size = ftell(fp);
     fseek(fp, 0, SEEK_SET);
-    
-    
-    // Try common dimensions - including 160x160 for the resized images
-    int dimensions[][2] = {{64,64}, {128,128}, {160,160}, {200,200}, {250,200}, {200,250}};
-    int num_dims = sizeof(dimensions) / sizeof(dimensions[0]);
-    
+
+    int loaded = 0;
+    ThumbnailHeader header;
+    if (file_size >= (long)sizeof(header) && fread(&header, sizeof(header), 1, fp) == 1 &&
+        header.magic == THUMBNAIL_FILE_MAGIC && header.version == THUMBNAIL_FILE_VERSION &&
+        header.data_size == (uint32_t)(file_size - sizeof(header))) {
+        loaded = read_thumbnail_data(fp, header.format, header.data_size, header.width, header.height,
+                                     header.flags, thumb, buffer, buffer_pixels);
+        fclose(fp);
+        return loaded;
+    }
+
+    // No header - guess the dimensions from the file size
+    fseek(fp, 0, SEEK_SET);
+    int num_dims = sizeof(legacy_dimensions) / sizeof(legacy_dimensions[0]);
     for (int i = 0; i < num_dims; i++) {
-        int w = dimensions[i][0];
-        int h = dimensions[i][1];
+        int w = legacy_dimensions[i][0];
+        int h = legacy_dimensions[i][1];
         if (w * h * 2 == file_size) {
-            
-            // Check if it fits in our static buffer
-            if (w * h > sizeof(thumbnail_buffer) / 2) {
-                fclose(fp);
-                return 0;
-            }
-            
-            thumb->width = w;
-            thumb->height = h;
-            thumb->data = thumbnail_buffer; // Use static buffer
-            
-            size_t read_bytes = fread(thumb->data, 1, file_size, fp);
-            fclose(fp);
-            
-            if (read_bytes == file_size) {
-                return 1;
-            } else {
-                return 0;
-            }
+            loaded = read_thumbnail_data(fp, THUMBNAIL_FORMAT_RGB565, file_size, w, h, 0,
+                                         thumb, buffer, buffer_pixels);
+            break;
         }
     }
-    
+
     fclose(fp);
+    return loaded;
+}
+
+int load_thumbnail_file(const char *path, Thumbnail *thumb, uint16_t *buffer, int buffer_pixels) {
+    const char *slash = strrchr(path, '/');
+    if (slash && thumbnail_pack_open(path, slash - path)) {
+        int result = thumbnail_pack_load(slash + 1, thumb, buffer, buffer_pixels);
+        if (result != 0) return result > 0;
+    }
+
+    // Not packed - loose file
+    return load_thumbnail_loose(path, thumb, buffer, buffer_pixels);
+}
+
+// Thumbnail being made from source art, one bounded step per
+// thumbnail_cache_step: read the file in chunks, decode it, scale a band of
+// rows at a time, then write it back in chunks as a loose .rgb565
+#define THUMB_SOURCE_IDLE 0
+#define THUMB_SOURCE_READ 1
+#define THUMB_SOURCE_DECODE 2
+#define THUMB_SOURCE_SCALE 3
+#define THUMB_SOURCE_WRITE 4
+
+#define THUMB_SOURCE_CHUNK 32768    // Bytes read or written per step
+#define THUMB_SOURCE_ROWS 25        // Rows scaled per step
+
+typedef struct {
+    int state;
+    char path[512];             // Thumbnail being made ("<dir>/.res/<name>.rgb565")
+    FILE *fp;                   // Source while reading, thumbnail file while writing
+    uint8_t *data;              // Source file
+    long size;                  // Of the source, then of the thumbnail pixels
+    long done;                  // Bytes read or written so far
+    uint8_t *rgb;               // Decoded source
+    int source_width;
+    int source_height;
+    uint16_t *pixels;           // Scaled thumbnail
+    int width;
+    int height;
+    int row;                    // Rows scaled so far
+} ThumbnailSourceJob;
+
+static ThumbnailSourceJob thumbnail_source;
+
+static void thumbnail_source_stop(void) {
+    ThumbnailSourceJob *job = &thumbnail_source;
+    if (job->fp) {
+        fclose(job->fp);
+        job->fp = NULL;
+        if (job->state == THUMB_SOURCE_WRITE) {
+            // Never leave half a thumbnail behind
+            remove(job->path);
+            thumbnail_names_written(job->path, 0);
+        }
+    }
+    free(job->data);
+    job->data = NULL;
+    if (job->rgb) {
+        thumbimage_free(job->rgb);
+        job->rgb = NULL;
+    }
+    free(job->pixels);
+    job->pixels = NULL;
+    job->state = THUMB_SOURCE_IDLE;
+}
+
+// Put the job's result into the cache (pixels NULL = no thumbnail)
+static void thumbnail_source_store(const uint16_t *pixels) {
+    ThumbnailSourceJob *job = &thumbnail_source;
+    uint32_t path_hash = hash_string(job->path);
+    int index = thumbnail_cache_find(job->path, path_hash);
+    if (index < 0) index = thumbnail_cache_victim(thumbnail_cache_shown);
+    if (index < 0) return;
+    if (index == thumbnail_cache_shown) thumbnail_cache_shown = -1;
+
+    ThumbnailCacheSlot *slot = &thumbnail_cache[index];
+    slot->state = THUMB_CACHE_MISSING;
+    if (pixels) {
+        memcpy(thumbnail_cache_pixels[index], pixels, job->width * job->height * sizeof(uint16_t));
+        slot->thumb.data = thumbnail_cache_pixels[index];
+        slot->thumb.width = job->width;
+        slot->thumb.height = job->height;
+        slot->thumb.flags = THUMBNAIL_FLAG_PRESCALED;
+        slot->state = THUMB_CACHE_LOADED;
+    }
+    thumbnail_cache_set_path(slot, job->path, path_hash);
+    slot->last_used = ++thumbnail_cache_tick;
+}
+
+// Source art of a thumbnail path with the given extension
+static int thumbnail_source_path(const char *path, const char *extension, char *source, size_t source_size) {
+    const char *dot = strrchr(path, '.');
+    const char *slash = strrchr(path, '/');
+    size_t base_len = dot && dot > slash ? (size_t)(dot - path) : strlen(path);
+    if (base_len + strlen(extension) >= source_size) return 0;
+    memcpy(source, path, base_len);
+    strcpy(source + base_len, extension);
+    return 1;
+}
+
+// 1 if path's thumbnail is being made or has source art to be made from.
+// Only take_over (the game shown) starts it: a prefetch never spends frames
+// on a game that may not be shown.
+static int thumbnail_source_start(const char *path, int take_over) {
+    ThumbnailSourceJob *job = &thumbnail_source;
+    if (job->state != THUMB_SOURCE_IDLE && strcmp(job->path, path) == 0) return 1;
+
+    char source[512];
+    int found = 0;
+    for (int i = 0; i < THUMBNAIL_SOURCE_EXTENSIONS && !found; i++) {
+        int was_read;
+        if (!thumbnail_source_path(path, thumbnail_source_extensions[i], source, sizeof(source))) break;
+        found = thumbnail_names_may_exist(source, 0, &was_read) && access(source, F_OK) == 0;
+    }
+    if (!found) return 0;
+    if (!take_over) return 1;
+
+    thumbnail_source_stop();
+    FILE *fp = fopen(source, "rb");
+    if (!fp) return 0;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    uint8_t *data = size > 0 && size <= THUMBIMAGE_MAX_FILE_SIZE ? (uint8_t*)malloc(size) : NULL;
+    if (!data) {
+        fclose(fp);
+        return 0;
+    }
+
+    strncpy(job->path, path, sizeof(job->path) - 1);
+    job->path[sizeof(job->path) - 1] = '\0';
+    job->fp = fp;
+    job->data = data;
+    job->size = size;
+    job->done = 0;
+    job->state = THUMB_SOURCE_READ;
+    return 1;
+}
+
+int thumbnail_cache_busy(void) {
+    return thumbnail_source.state != THUMB_SOURCE_IDLE;
+}
+
+int thumbnail_cache_step(void) {
+    ThumbnailSourceJob *job = &thumbnail_source;
+
+    if (job->state == THUMB_SOURCE_READ) {
+        long chunk = min(job->size - job->done, THUMB_SOURCE_CHUNK);
+        if (fread(job->data + job->done, 1, chunk, job->fp) != (size_t)chunk) {
+            thumbnail_source_store(NULL);
+            thumbnail_source_stop();
+            return 1;
+        }
+        job->done += chunk;
+        if (job->done == job->size) {
+            fclose(job->fp);
+            job->fp = NULL;
+            job->state = THUMB_SOURCE_DECODE;
+        }
+        return 0;
+    }
+
+    if (job->state == THUMB_SOURCE_DECODE) {
+        // stb_image decodes in one call - bounded by THUMBIMAGE_MAX_PIXELS
+        job->rgb = thumbimage_decode(job->data, job->size, &job->source_width, &job->source_height);
+        free(job->data);
+        job->data = NULL;
+        if (job->rgb) {
+            thumbimage_fit(job->source_width, job->source_height, THUMBNAIL_MAX_WIDTH, THUMBNAIL_MAX_HEIGHT,
+                           &job->width, &job->height);
+            job->pixels = (uint16_t*)malloc(job->width * job->height * sizeof(uint16_t));
+        }
+        if (!job->pixels) {
+            thumbnail_source_store(NULL);
+            thumbnail_source_stop();
+            return 1;
+        }
+        job->row = 0;
+        job->state = THUMB_SOURCE_SCALE;
+        return 0;
+    }
+
+    if (job->state == THUMB_SOURCE_SCALE) {
+        thumbimage_scale_rows(job->rgb, job->source_width, job->source_height,
+                              job->pixels, job->width, job->height, job->row, THUMB_SOURCE_ROWS);
+        job->row += THUMB_SOURCE_ROWS;
+        if (job->row < job->height) return 0;
+
+        thumbimage_free(job->rgb);
+        job->rgb = NULL;
+        thumbnail_source_store(job->pixels);
+
+        // Written back so the next time is an ordinary load
+        ThumbnailHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = THUMBNAIL_FILE_MAGIC;
+        header.version = THUMBNAIL_FILE_VERSION;
+        header.format = THUMBNAIL_FORMAT_RGB565;
+        header.flags = THUMBNAIL_FLAG_PRESCALED;
+        header.width = job->width;
+        header.height = job->height;
+        header.data_size = job->width * job->height * sizeof(uint16_t);
+        job->fp = fopen(job->path, "wb");
+        job->state = THUMB_SOURCE_WRITE;
+        if (!job->fp || fwrite(&header, sizeof(header), 1, job->fp) != 1) {
+            thumbnail_source_stop();
+            return 1;
+        }
+        job->size = header.data_size;
+        job->done = 0;
+        return 1;
+    }
+
+    if (job->state == THUMB_SOURCE_WRITE) {
+        long chunk = min(job->size - job->done, THUMB_SOURCE_CHUNK);
+        if (fwrite((uint8_t*)job->pixels + job->done, 1, chunk, job->fp) != (size_t)chunk) {
+            thumbnail_source_stop();
+            return 0;
+        }
+        job->done += chunk;
+        if (job->done == job->size) {
+            int ok = fclose(job->fp) == 0;
+            job->fp = NULL;
+            if (!ok) remove(job->path);
+            thumbnail_names_written(job->path, ok);
+            thumbnail_source_stop();
+        }
+        return 0;
+    }
     return 0;
 }
 
+// Slot of a name in a pack index, or the empty slot ending its probe run;
+// -1 if the run wraps around a full index
+static int thumbnail_pack_probe(const ThumbnailPackEntry *slots, uint32_t slot_count,
+                                uint32_t name_hash, uint32_t name_check) {
+    uint32_t mask = slot_count - 1;
+    for (uint32_t probe = 0; probe < slot_count; probe++) {
+        uint32_t index = (name_hash + probe) & mask;
+        if (slots[index].size == 0 ||
+            (slots[index].name_hash == name_hash && slots[index].name_check == name_check)) {
+            return (int)index;
+        }
+    }
+    return -1;
+}
+
+// Rewrite the pack index of path's folder with path's entry removed, or moved
+// to new_name. The blob stays where it is; only the index is written, and the
+// open pack's index takes the change only once the file has it.
+static void thumbnail_pack_edit(const char *path, const char *new_name) {
+    const char *slash = strrchr(path, '/');
+    if (!slash) return;
+
+    char pack_path[600];
+    snprintf(pack_path, sizeof(pack_path), "%.*s/" THUMBNAIL_PACK_NAME, (int)(slash - path), path);
+    FILE *fp = fopen(pack_path, "r+b");
+    if (!fp) return;
+
+    ThumbnailPackHeader header;
+    ThumbnailPackEntry *slots = NULL;
+    if (fread(&header, sizeof(header), 1, fp) == 1 &&
+        header.magic == THUMBNAIL_PACK_MAGIC && header.version == THUMBNAIL_PACK_VERSION &&
+        header.slot_count != 0 && header.slot_count <= THUMBNAIL_PACK_MAX_SLOTS &&
+        (header.slot_count & (header.slot_count - 1)) == 0) {
+        slots = (ThumbnailPackEntry*)malloc(header.slot_count * sizeof(ThumbnailPackEntry));
+    }
+    if (!slots || fread(slots, sizeof(ThumbnailPackEntry), header.slot_count, fp) != header.slot_count) {
+        free(slots);
+        fclose(fp);
+        return;
+    }
+
+    uint32_t mask = header.slot_count - 1;
+    int index = thumbnail_pack_probe(slots, header.slot_count, hash_string(slash + 1),
+                                     hash_string_seeded(slash + 1, THUMBNAIL_PACK_CHECK_SEED));
+    if (index < 0 || slots[index].size == 0) {
+        free(slots);
+        fclose(fp);
+        return;
+    }
+    ThumbnailPackEntry moved = slots[index];
+
+    // Delete without a tombstone: pull later entries of the probe run back
+    // into the hole unless their own slot lies between it and them
+    uint32_t hole = (uint32_t)index;
+    uint32_t next = (hole + 1) & mask;
+    for (uint32_t step = 1; step < header.slot_count && slots[next].size != 0; step++) {
+        uint32_t home = slots[next].name_hash & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            slots[hole] = slots[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    memset(&slots[hole], 0, sizeof(slots[hole]));
+    header.entry_count--;
+
+    if (new_name) {
+        moved.name_hash = hash_string(new_name);
+        moved.name_check = hash_string_seeded(new_name, THUMBNAIL_PACK_CHECK_SEED);
+        // A slot was just freed, so the probe always ends
+        index = thumbnail_pack_probe(slots, header.slot_count, moved.name_hash, moved.name_check);
+        if (index >= 0) {
+            if (slots[index].size == 0) header.entry_count++;  // Else a stale entry of the new name
+            slots[index] = moved;
+        }
+    }
+
+    // Slots first: the header only carries the entry count
+    int ok = fseek(fp, sizeof(header), SEEK_SET) == 0 &&
+             fwrite(slots, sizeof(ThumbnailPackEntry), header.slot_count, fp) == header.slot_count &&
+             fseek(fp, 0, SEEK_SET) == 0 &&
+             fwrite(&header, sizeof(header), 1, fp) == 1;
+    if (fclose(fp) != 0) ok = 0;
+
+    // The open pack keeps its old index if the write failed: the blobs are
+    // unchanged, so it still reads what the card holds
+    if (ok && strlen(pack_dir) == (size_t)(slash - path) && strncmp(pack_dir, path, slash - path) == 0) {
+        if (pack_file && pack_slot_count == header.slot_count) {
+            memcpy(pack_slots, slots, header.slot_count * sizeof(ThumbnailPackEntry));
+        } else {
+            thumbnail_pack_close();
+        }
+    }
+    free(slots);
+}
+
+void thumbnail_files_remove(const char *path) {
+    if (thumbnail_source.state != THUMB_SOURCE_IDLE && strcmp(thumbnail_source.path, path) == 0) {
+        thumbnail_source_stop();
+    }
+
+    remove(path);
+    thumbnail_pack_edit(path, NULL);
+    for (int i = 0; i < THUMBNAIL_SOURCE_EXTENSIONS; i++) {
+        char source[512];
+        if (thumbnail_source_path(path, thumbnail_source_extensions[i], source, sizeof(source))) {
+            remove(source);
+        }
+    }
+    thumbnail_cache_file_changed(path);
+}
+
+void thumbnail_files_rename(const char *old_path, const char *new_path) {
+    if (thumbnail_source.state != THUMB_SOURCE_IDLE && strcmp(thumbnail_source.path, old_path) == 0) {
+        thumbnail_source_stop();
+    }
+
+    rename(old_path, new_path);
+    const char *new_slash = strrchr(new_path, '/');
+    if (new_slash) thumbnail_pack_edit(old_path, new_slash + 1);
+    for (int i = 0; i < THUMBNAIL_SOURCE_EXTENSIONS; i++) {
+        char old_source[512];
+        char new_source[512];
+        if (thumbnail_source_path(old_path, thumbnail_source_extensions[i], old_source, sizeof(old_source)) &&
+            thumbnail_source_path(new_path, thumbnail_source_extensions[i], new_source, sizeof(new_source))) {
+            rename(old_source, new_source);
+        }
+    }
+    thumbnail_cache_file_changed(old_path);
+    thumbnail_cache_file_changed(new_path);
+}
+
 void free_thumbnail(Thumbnail *thumb) {
     if (thumb) {
         // No need to free static buffer, just reset pointer
         thumb->data = NULL;
         thumb->width = 0;
         thumb->height = 0;
+        thumb->flags = 0;
     }
 }
 
@@ -296,15 +1253,25 @@ void render_thumbnail(uint16_t *framebuffer, const Thumbnail *thumb) {
     int display_width = thumb->width;
     int display_height = thumb->height;
     
-    // Scale down if too large
-    if (display_width > THUMBNAIL_MAX_WIDTH) {
-        display_height = (display_height * THUMBNAIL_MAX_WIDTH) / display_width;
+    if (thumb->flags & THUMBNAIL_FLAG_PREVIEW) {
+        // Blown up to fill the area, keeping the aspect ratio
         display_width = THUMBNAIL_MAX_WIDTH;
-    }
-    
-    if (display_height > THUMBNAIL_MAX_HEIGHT) {
-        display_width = (display_width * THUMBNAIL_MAX_HEIGHT) / display_height;
-        display_height = THUMBNAIL_MAX_HEIGHT;
+        display_height = (thumb->height * THUMBNAIL_MAX_WIDTH) / thumb->width;
+        if (display_height > THUMBNAIL_MAX_HEIGHT) {
+            display_width = (thumb->width * THUMBNAIL_MAX_HEIGHT) / thumb->height;
+            display_height = THUMBNAIL_MAX_HEIGHT;
+        }
+    } else if (!(thumb->flags & THUMBNAIL_FLAG_PRESCALED)) {
+        // Scale down if too large (pre-scaled art already fits)
+        if (display_width > THUMBNAIL_MAX_WIDTH) {
+            display_height = (display_height * THUMBNAIL_MAX_WIDTH) / display_width;
+            display_width = THUMBNAIL_MAX_WIDTH;
+        }
+
+        if (display_height > THUMBNAIL_MAX_HEIGHT) {
+            display_width = (display_width * THUMBNAIL_MAX_HEIGHT) / display_height;
+            display_height = THUMBNAIL_MAX_HEIGHT;
+        }
     }
     
     // Center in thumbnail area (vertically) and align to right edge
@@ -327,6 +1294,24 @@ void render_thumbnail(uint16_t *framebuffer, const Thumbnail *thumb) {
     // Draw inner background
     render_fill_rect(framebuffer, start_x, start_y, display_width, display_height, BG_COLOR);
     
+    // Shown at its own size: copy rows with no scaling step
+    if (display_width == thumb->width && display_height == thumb->height) {
+        for (int y = 0; y < display_height; y++) {
+            int screen_y = start_y + y;
+            if (screen_y < 0 || screen_y >= SCREEN_HEIGHT) continue;
+
+            const uint16_t *src = thumb->data + y * thumb->width;
+            uint16_t *dst = framebuffer + screen_y * SCREEN_WIDTH + start_x;
+            for (int x = 0; x < display_width; x++) {
+                // Only draw non-black pixels, let dark gray background show through
+                if (src[x] != 0x0000) {
+                    dst[x] = src[x];
+                }
+            }
+        }
+        return;
+    }
+
     // Draw scaled thumbnail (simple nearest neighbor for now)
     for (int y = 0; y < display_height; y++) {
         for (int x = 0; x < display_width; x++) {
@@ -33,6 +33,7 @@
 #define THUMBNAIL_AREA_Y 40     // Start from header
 #define THUMBNAIL_MAX_WIDTH 160 // Full width to screen edge (320-160=160) 
 #define THUMBNAIL_MAX_HEIGHT 200 // Support up to 200px height as requested
+#define THUMBNAIL_MAX_PIXELS (250 * 200) // Largest thumbnail file (250x200 or 200x250)
 
 // Text scrolling for filenames
 #define MAX_FILENAME_DISPLAY_LEN 20 // Max length for selected item (with scrolling)
@@ -67,22 +68,167 @@ void render_header(uint16_t *framebuffer, const char *title);
 // Draw menu legend at bottom
 void render_legend(uint16_t *framebuffer, int x_button_mode);
 
-// Draw a menu item (file or folder)
-void render_menu_item(uint16_t *framebuffer, int index, const char *name, int is_dir,
-                     int is_selected, int scroll_offset, int is_favorited);
+// Draw a menu item (file or folder). icon is a system icon (sysicons.h) drawn
+// before the name, or SYSICON_BLANK to keep its column, or SYSICON_NONE.
+// Returns the x just past what was drawn (the pillbox when selected).
+int render_menu_item(uint16_t *framebuffer, int index, const char *name, int is_dir,
+                     int is_selected, int scroll_offset, int is_favorited, int icon);
+
+// Draw right-aligned detail text on a menu row (game count, file size), left
+// out when it would reach item_right (what render_menu_item returned)
+void render_menu_item_detail(uint16_t *framebuffer, int index, int scroll_offset, const char *text,
+                             int item_right);
 
 // Thumbnail functions
 typedef struct {
     uint16_t *data;
     int width;
     int height;
+    int flags;                  // THUMBNAIL_FLAG_*
 } Thumbnail;
 
-// Load thumbnail from PNG file
+// Already sized for the thumbnail area (at most THUMBNAIL_MAX_WIDTH x
+// THUMBNAIL_MAX_HEIGHT): drawn 1:1 with no scaling step
+#define THUMBNAIL_FLAG_PRESCALED 0x0001
+// Pack entry: a ThumbnailPreview is stored just before the blob
+#define THUMBNAIL_FLAG_HAS_PREVIEW 0x0002
+// Low-resolution preview: drawn scaled up to fill the area
+#define THUMBNAIL_FLAG_PREVIEW 0x0004
+
+// Preview shown while the full thumbnail waits to be read (raw RGB565, the
+// image fitted into THUMBNAIL_PREVIEW_MAX_WIDTH x THUMBNAIL_PREVIEW_MAX_HEIGHT)
+#define THUMBNAIL_PREVIEW_MAX_WIDTH 20
+#define THUMBNAIL_PREVIEW_MAX_HEIGHT 25
+
+typedef struct {
+    uint8_t width;
+    uint8_t height;
+    uint16_t reserved;
+    uint16_t pixels[THUMBNAIL_PREVIEW_MAX_WIDTH * THUMBNAIL_PREVIEW_MAX_HEIGHT];
+} ThumbnailPreview;
+
+// Load thumbnail (through the thumbnail cache)
 int load_thumbnail(const char *png_path, Thumbnail *thumb);
 
-// Load raw RGB565 file (fallback)
-int load_raw_rgb565(const char *path, Thumbnail *thumb);
+// Loose thumbnail file (.res/<name>.rgb565): a ThumbnailHeader followed by
+// data_size bytes in its format (thumbcodec.h), any size up to
+// THUMBNAIL_MAX_PIXELS. Files without the header are legacy raw RGB565 whose
+// dimensions are guessed from the file size (64x64, 128x128, 160x160,
+// 200x200, 250x200 or 200x250).
+#define THUMBNAIL_FILE_MAGIC 0x48544746  // "FGTH"
+#define THUMBNAIL_FILE_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t format;             // THUMBNAIL_FORMAT_*
+    uint16_t flags;             // THUMBNAIL_FLAG_*
+    uint16_t width;
+    uint16_t height;
+    uint32_t data_size;
+} ThumbnailHeader;
+
+// Thumbnail pack: one file per .res folder holding every thumbnail of that
+// folder, written by tools/frogui_thumbconv --pack. The index is read
+// once per folder, then a thumbnail is one seek and one read; thumbnails not
+// in the pack are still loaded from loose .rgb565 files.
+//
+// File layout (little-endian):
+//   ThumbnailPackHeader
+//   ThumbnailPackEntry[slot_count]   open addressing on hash_string(file name)
+//                                    (e.g. "Tetris.rgb565"), linear probing,
+//                                    size 0 = empty slot
+//   blobs                            in the entry's format (thumbcodec.h)
+//
+// An entry matches a name only if a second, differently seeded hash of the
+// name agrees too, so two names sharing a slot hash are both packed.
+#define THUMBNAIL_PACK_NAME "thumbs.pack"
+#define THUMBNAIL_PACK_MAGIC 0x50544746  // "FGTP"
+#define THUMBNAIL_PACK_VERSION 3
+#define THUMBNAIL_PACK_MAX_SLOTS (1 << 16)
+#define THUMBNAIL_PACK_CHECK_SEED 1     // name_check = hash_string_seeded(name, seed)
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t entry_count;
+    uint32_t slot_count;        // Power of two
+} ThumbnailPackHeader;
+
+typedef struct {
+    uint32_t name_hash;
+    uint32_t name_check;
+    uint32_t offset;            // From the start of the file
+    uint32_t size;
+    uint16_t width;
+    uint16_t height;
+    uint16_t format;            // THUMBNAIL_FORMAT_*
+    uint16_t flags;             // THUMBNAIL_FLAG_*
+} ThumbnailPackEntry;
+
+// Load a thumbnail path ("<dir>/.res/<name>.rgb565") from its folder's pack,
+// or from the loose file when the pack does not have it
+int load_thumbnail_file(const char *path, Thumbnail *thumb, uint16_t *buffer, int buffer_pixels);
+
+// Close the open pack and free its index
+void thumbnail_pack_close(void);
+
+// Decoded thumbnails shared by every view: an LRU over a fixed number of
+// static slots of THUMBNAIL_MAX_PIXELS (100KB each), keyed by path hash.
+// Files that are missing are remembered too. Build with
+// -DTHUMBNAIL_CACHE_SLOTS=n to change the budget.
+#ifndef THUMBNAIL_CACHE_SLOTS
+#define THUMBNAIL_CACHE_SLOTS 8
+#endif
+
+// Thumbnail for a file, from the cache or read into the least recently used
+// slot. Returns 1 if there is one; thumb stays valid until the next call
+// (its slot is never the one a prefetch replaces).
+int thumbnail_cache_get(const char *path, Thumbnail *thumb);
+
+// Read a file into the cache without showing it. Returns 1 if the card was
+// read, 0 if its result was cached already or it is known missing.
+int thumbnail_cache_prefetch(const char *path);
+
+// Preview of a packed thumbnail: one small read from its folder's pack.
+// Returns 1 if there is one; thumb stays valid until the next call.
+int thumbnail_cache_preview(const char *path, Thumbnail *thumb);
+
+// 1 if the file's result is known without reading the card: cached, or
+// missing from its .res folder's listing
+int thumbnail_cache_has(const char *path);
+
+// Each .res folder is listed once into a set of thumbnail names, so games
+// without one cost no file access. Call on entering a folder or list: each
+// folder's mtime is compared again (one stat) on its next use.
+void thumbnail_cache_recheck(void);
+
+// Recent games, favorites and search results hold games of many folders,
+// more than there are name sets: while mixed is set, folders without a set
+// get none and their thumbnails are looked for file by file
+void thumbnail_cache_mixed_folders(int mixed);
+
+// The menu deleted or renamed a game: remove or rename its thumbnail (the
+// loose file, the pack entry and the source art) and update the cache.
+// Packed entries are edited in the pack index; their data stays in place.
+void thumbnail_files_remove(const char *path);
+void thumbnail_files_rename(const char *old_path, const char *new_path);
+
+// A game whose .res folder has <name>.png, .jpg or .jpeg but no thumbnail
+// gets one made on the device (thumbimage.h): thumbnail_cache_get starts it
+// for the game shown and returns 0 (a prefetch never starts one), then each
+// thumbnail_cache_step call does one piece of the work, each sized to fit a
+// frame. The result goes into the cache and is written back as
+// <name>.rgb565, so each image is decoded once. Returns 1 when a thumbnail
+// was finished or given up (get it again).
+int thumbnail_cache_step(void);
+
+// 1 while a thumbnail is being made
+int thumbnail_cache_busy(void);
+
+// Forget every cached thumbnail
+void thumbnail_cache_clear(void);
 
 // Free thumbnail memory
 void free_thumbnail(Thumbnail *thumb);
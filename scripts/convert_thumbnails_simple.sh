@@ -1,5 +1,6 @@
 #!/bin/bash
-# Simple thumbnail converter using Python/Pillow
+# Simple thumbnail converter using the native tools/frogui_thumbconv
+# (built by make tools, built here first if it is missing)
 # Usage: ./convert_thumbnails_simple.sh [roms_directory]
 
 ROMS_DIR="${1:-roms}"
@@ -10,29 +11,20 @@ if [ ! -d "$ROMS_DIR" ]; then
     exit 1
 fi
 
-# Check if Python is installed
-if ! command -v python3 &> /dev/null; then
-    echo "Error: Python 3 not found!"
-    echo "Please install Python 3"
-    exit 1
-fi
+# Get the directory where this script is located
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+CONVERTER="$SCRIPT_DIR/../tools/frogui_thumbconv"
 
-# Check if PIL/Pillow is installed
-if ! python3 -c "from PIL import Image" 2>/dev/null; then
-    echo "Error: Pillow (PIL) not found!"
-    echo "Installing Pillow..."
-    python3 -m pip install Pillow
-    if [ $? -ne 0 ]; then
-        echo "Failed to install Pillow"
+if [ ! -x "$CONVERTER" ]; then
+    echo "Building the thumbnail converter..."
+    if ! make -C "$SCRIPT_DIR/.." tools; then
+        echo "Failed to build tools/frogui_thumbconv"
+        echo "Please install a C compiler and make"
         exit 1
     fi
 fi
 
-# Get the directory where this script is located
-SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
-
-# Call the Python conversion script
-python3 "$SCRIPT_DIR/convert_to_rgb565.py" "$ROMS_DIR"
+"$CONVERTER" "$ROMS_DIR"
 
 if [ $? -ne 0 ]; then
     echo "Conversion failed!"
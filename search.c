@@ -0,0 +1,422 @@
+#include "search.h"
+#include "library.h"
+#include "recent_games.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef SF2000
+#include "../../debug.h"
+#else
+#define xlog printf
+#endif
+
+#define SEARCH_NAME_MAX 256
+
+// Score weights: trigram coverage is worth up to SEARCH_SCORE_TRIGRAMS, the
+// rest rewards where the query sits in the name and recent play
+#define SEARCH_SCORE_TRIGRAMS 1000
+#define SEARCH_SCORE_SUBSTRING 1000
+#define SEARCH_SCORE_WORD_START 500
+#define SEARCH_SCORE_NAME_START 500
+#define SEARCH_SCORE_RECENT 300
+
+static char search_index_path[512] = SEARCH_INDEX_FILE;
+
+// Current index - a single buffer laid out exactly like the index file
+static uint8_t *search_data = NULL;
+static const SearchHeader *search_header = NULL;
+static const uint32_t *search_list_start = NULL;
+static const uint8_t *search_postings = NULL;
+
+// Per-query scratch, sized to the catalog: trigram hits per ROM and the
+// ROMs that got at least one. A query has up to SEARCH_NAME_MAX +
+// SEARCH_SYMBOLS trigrams, more than a byte counts.
+static uint16_t *search_hits = NULL;
+static int *search_touched = NULL;
+static int search_scratch_count = 0;
+
+// Lowercase letters and digits with single spaces between words and one in
+// front, so word starts form their own trigrams. The file extension is
+// dropped from ROM names.
+static int normalize(const char *src, char *dst, int dst_size, int strip_extension) {
+    const char *end = src + strlen(src);
+    if (strip_extension) {
+        const char *dot = strrchr(src, '.');
+        if (dot && dot != src) end = dot;
+    }
+
+    int len = 0;
+    dst[len++] = ' ';
+    for (const char *p = src; p < end && len < dst_size - 1; p++) {
+        char c = *p;
+        if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+        if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) {
+            dst[len++] = c;
+        } else if (dst[len - 1] != ' ') {
+            dst[len++] = ' ';
+        }
+    }
+    if (len > 1 && dst[len - 1] == ' ') len--;
+    dst[len] = '\0';
+    return len;
+}
+
+static int symbol(char c) {
+    if (c >= 'a' && c <= 'z') return 1 + (c - 'a');
+    if (c >= '0' && c <= '9') return 27 + (c - '0');
+    return 0;
+}
+
+static int trigram_at(const char *s) {
+    return (symbol(s[0]) * SEARCH_SYMBOLS + symbol(s[1])) * SEARCH_SYMBOLS + symbol(s[2]);
+}
+
+static int varint_size(uint32_t value) {
+    int size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+static uint8_t *varint_write(uint8_t *p, uint32_t value) {
+    while (value >= 0x80) {
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+static size_t search_layout_size(uint32_t postings_size) {
+    return sizeof(SearchHeader) + (SEARCH_TRIGRAM_COUNT + 1) * sizeof(uint32_t) + postings_size;
+}
+
+static void search_detach(void) {
+    free(search_data);
+    free(search_hits);
+    free(search_touched);
+    search_data = NULL;
+    search_header = NULL;
+    search_list_start = NULL;
+    search_postings = NULL;
+    search_hits = NULL;
+    search_touched = NULL;
+    search_scratch_count = 0;
+}
+
+// Validate a loaded or built buffer against the current catalog and make it
+// the current index. Takes ownership of data on success.
+static int search_attach(uint8_t *data, size_t size) {
+    if (size < search_layout_size(0)) return 0;
+
+    const SearchHeader *header = (const SearchHeader*)data;
+    if (header->magic != SEARCH_MAGIC || header->version != SEARCH_VERSION) return 0;
+    if (header->library_generation != library_get_generation() ||
+        header->rom_count != (uint32_t)library_get_rom_count()) return 0;
+    if (size != search_layout_size(header->postings_size)) return 0;
+
+    const uint32_t *list_start = (const uint32_t*)(data + sizeof(SearchHeader));
+    if (list_start[SEARCH_TRIGRAM_COUNT] != header->postings_size) return 0;
+
+    int rom_count = header->rom_count;
+    uint16_t *hits = (uint16_t*)calloc(rom_count ? rom_count : 1, sizeof(uint16_t));
+    int *touched = (int*)malloc((rom_count ? rom_count : 1) * sizeof(int));
+    if (!hits || !touched) {
+        free(hits);
+        free(touched);
+        return 0;
+    }
+
+    search_detach();
+    search_data = data;
+    search_header = header;
+    search_list_start = list_start;
+    search_postings = (const uint8_t*)(list_start + SEARCH_TRIGRAM_COUNT + 1);
+    search_hits = hits;
+    search_touched = touched;
+    search_scratch_count = rom_count;
+    return 1;
+}
+
+static int search_load(void) {
+    FILE *fp = fopen(search_index_path, "rb");
+    if (!fp) {
+        return 0;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long file_size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    if (file_size <= 0) {
+        fclose(fp);
+        return 0;
+    }
+
+    uint8_t *data = (uint8_t*)malloc(file_size);
+    if (!data) {
+        fclose(fp);
+        return 0;
+    }
+
+    // Whole index in one read
+    size_t read_bytes = fread(data, 1, file_size, fp);
+    fclose(fp);
+
+    if (read_bytes != (size_t)file_size || !search_attach(data, file_size)) {
+        free(data);
+        return 0;
+    }
+    return 1;
+}
+
+// Build the index from the in-memory catalog in two passes: size every
+// posting list, then encode. Each ROM adds itself to a list at most once.
+static int search_build(void) {
+    int rom_count = library_get_rom_count();
+    int32_t *last_rom = (int32_t*)malloc(SEARCH_TRIGRAM_COUNT * sizeof(int32_t));
+    uint32_t *list_size = (uint32_t*)calloc(SEARCH_TRIGRAM_COUNT + 1, sizeof(uint32_t));
+    if (!last_rom || !list_size) {
+        free(last_rom);
+        free(list_size);
+        return 0;
+    }
+
+    char name[SEARCH_NAME_MAX];
+    memset(last_rom, 0xFF, SEARCH_TRIGRAM_COUNT * sizeof(int32_t));
+    for (int rom = 0; rom < rom_count; rom++) {
+        int len = normalize(library_get_rom_name(rom), name, sizeof(name), 1);
+        for (int i = 0; i + 3 <= len; i++) {
+            int t = trigram_at(name + i);
+            if (last_rom[t] == rom) continue;
+            list_size[t] += varint_size(rom - last_rom[t] - 1);
+            last_rom[t] = rom;
+        }
+    }
+
+    uint32_t postings_size = 0;
+    for (int t = 0; t < SEARCH_TRIGRAM_COUNT; t++) {
+        postings_size += list_size[t];
+    }
+
+    size_t size = search_layout_size(postings_size);
+    uint8_t *data = (uint8_t*)malloc(size);
+    if (!data) {
+        free(last_rom);
+        free(list_size);
+        return 0;
+    }
+
+    SearchHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SEARCH_MAGIC;
+    header.version = SEARCH_VERSION;
+    header.library_generation = library_get_generation();
+    header.rom_count = rom_count;
+    header.postings_size = postings_size;
+    memcpy(data, &header, sizeof(header));
+
+    // Each list_start entry serves as its list's write cursor, then is
+    // shifted back into place once every list is written
+    uint32_t *list_start = (uint32_t*)(data + sizeof(SearchHeader));
+    uint8_t *postings = (uint8_t*)(list_start + SEARCH_TRIGRAM_COUNT + 1);
+    uint32_t offset = 0;
+    for (int t = 0; t < SEARCH_TRIGRAM_COUNT; t++) {
+        list_start[t] = offset;
+        offset += list_size[t];
+    }
+
+    memset(last_rom, 0xFF, SEARCH_TRIGRAM_COUNT * sizeof(int32_t));
+    for (int rom = 0; rom < rom_count; rom++) {
+        int len = normalize(library_get_rom_name(rom), name, sizeof(name), 1);
+        for (int i = 0; i + 3 <= len; i++) {
+            int t = trigram_at(name + i);
+            if (last_rom[t] == rom) continue;
+            uint8_t *end = varint_write(postings + list_start[t], rom - last_rom[t] - 1);
+            list_start[t] = end - postings;
+            last_rom[t] = rom;
+        }
+    }
+    memmove(list_start + 1, list_start, SEARCH_TRIGRAM_COUNT * sizeof(uint32_t));
+    list_start[0] = 0;
+
+    free(last_rom);
+    free(list_size);
+
+    char temp_path[sizeof(search_index_path) + 4];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", search_index_path);
+    FILE *fp = fopen(temp_path, "wb");
+    if (fp) {
+        size_t written = fwrite(data, 1, size, fp);
+        fclose(fp);
+        if (written == size) {
+            remove(search_index_path);
+            rename(temp_path, search_index_path);
+        } else {
+            remove(temp_path);
+        }
+    }
+
+    if (!search_attach(data, size)) {
+        free(data);
+        return 0;
+    }
+    xlog("Search: indexed %d roms, %u bytes of postings\n", rom_count, (unsigned)postings_size);
+    return 1;
+}
+
+static int search_is_current(void) {
+    return search_header &&
+           search_header->library_generation == library_get_generation() &&
+           search_header->rom_count == (uint32_t)library_get_rom_count();
+}
+
+void search_init(const char *index_path) {
+    strncpy(search_index_path, index_path, sizeof(search_index_path) - 1);
+    search_index_path[sizeof(search_index_path) - 1] = '\0';
+}
+
+int search_open(void) {
+    if (search_is_current()) return 1;
+    if (search_load()) return 1;
+    return search_build();
+}
+
+void search_free(void) {
+    search_detach();
+}
+
+static int is_recent(int rom_index) {
+    const LibraryRom *rom = library_get_rom(rom_index);
+    SystemId system = systems_lookup(library_get_system_name(rom->system_id));
+    const char *rom_name = library_get_rom_name(rom_index);
+    const RecentGame *recents = recent_games_get_list();
+    int recent_count = recent_games_get_count();
+
+    for (int i = 0; i < recent_count; i++) {
+        if (recents[i].system == system &&
+            strcmp(recents[i].game_name, rom_name) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Position bonuses for a normalized query (leading space included) in a
+// normalized name
+static int position_score(const char *name, const char *query) {
+    const char *match = strstr(name, query + 1);
+    if (!match) return 0;
+
+    // Both strings start with a space, so match[-1] is always in bounds
+    int score = SEARCH_SCORE_SUBSTRING;
+    if (match[-1] == ' ') {
+        score += SEARCH_SCORE_WORD_START;
+        if (match == name + 1) score += SEARCH_SCORE_NAME_START;
+    }
+    return score;
+}
+
+// Keep results sorted best first: higher score, then newer file
+static int ranks_before(const SearchResult *a, const SearchResult *b) {
+    if (a->score != b->score) return a->score > b->score;
+    uint32_t a_mtime = library_get_rom(a->rom_index)->mtime;
+    uint32_t b_mtime = library_get_rom(b->rom_index)->mtime;
+    if (a_mtime != b_mtime) return a_mtime > b_mtime;
+    return a->rom_index < b->rom_index;
+}
+
+static void insert_result(SearchResult *results, int *count, int max_results, int rom_index, int score) {
+    SearchResult candidate = {rom_index, score};
+    int pos = *count;
+    if (pos == max_results) {
+        if (!ranks_before(&candidate, &results[max_results - 1])) return;
+        pos--;
+    } else {
+        (*count)++;
+    }
+    while (pos > 0 && ranks_before(&candidate, &results[pos - 1])) {
+        results[pos] = results[pos - 1];
+        pos--;
+    }
+    results[pos] = candidate;
+}
+
+static int score_candidate(int rom_index, const char *query, int base_score) {
+    char name[SEARCH_NAME_MAX];
+    normalize(library_get_rom_name(rom_index), name, sizeof(name), 1);
+
+    int score = base_score + position_score(name, query);
+    if (is_recent(rom_index)) score += SEARCH_SCORE_RECENT;
+    return score;
+}
+
+int search_query(const char *query, SearchResult *results, int max_results) {
+    if (!search_header || max_results <= 0) return 0;
+
+    char normalized[SEARCH_NAME_MAX];
+    int len = normalize(query, normalized, sizeof(normalized), 0);
+    if (len <= 1) return 0;
+
+    // Distinct query trigrams
+    int trigrams[SEARCH_NAME_MAX + SEARCH_SYMBOLS];
+    int trigram_count = 0;
+    for (int i = 0; i + 3 <= len; i++) {
+        int t = trigram_at(normalized + i);
+        int seen = 0;
+        for (int j = 0; j < trigram_count && !seen; j++) {
+            seen = trigrams[j] == t;
+        }
+        if (!seen) trigrams[trigram_count++] = t;
+    }
+
+    // A single character has no trigram of its own: take the words starting
+    // with it, which are the trigrams of a space, the character and any symbol
+    int single_character = trigram_count == 0;
+    if (single_character) {
+        int first = (symbol(' ') * SEARCH_SYMBOLS + symbol(normalized[1])) * SEARCH_SYMBOLS;
+        for (int i = 0; i < SEARCH_SYMBOLS; i++) {
+            trigrams[trigram_count++] = first + i;
+        }
+    }
+
+    // Count trigram hits per ROM by walking each posting list
+    int rom_count = search_scratch_count;
+    int touched_count = 0;
+    for (int i = 0; i < trigram_count; i++) {
+        const uint8_t *p = search_postings + search_list_start[trigrams[i]];
+        const uint8_t *end = search_postings + search_list_start[trigrams[i] + 1];
+        int rom = -1;
+        while (p < end) {
+            uint32_t delta = 0;
+            int shift = 0;
+            uint8_t byte;
+            do {
+                byte = *p++;
+                delta |= (uint32_t)(byte & 0x7F) << shift;
+                shift += 7;
+            } while ((byte & 0x80) && p < end);
+            rom += delta + 1;
+            if (rom >= rom_count) break;
+            if (search_hits[rom]++ == 0) search_touched[touched_count++] = rom;
+        }
+    }
+
+    // Fuzzy threshold: at least 60% of the query trigrams must be present
+    int threshold = single_character ? 1 : (trigram_count * 3 + 4) / 5;
+    int count = 0;
+    for (int i = 0; i < touched_count; i++) {
+        int rom = search_touched[i];
+        int hits = search_hits[rom];
+        search_hits[rom] = 0;
+        if (hits < threshold) continue;
+
+        int base_score = single_character ? 0 : hits * SEARCH_SCORE_TRIGRAMS / trigram_count;
+        int score = score_candidate(rom, normalized, base_score);
+        insert_result(results, &count, max_results, rom, score);
+    }
+    return count;
+}
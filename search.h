@@ -0,0 +1,58 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stdint.h>
+
+// Library-wide game search over the catalog (see library.h), backed by a
+// trigram index so queries never touch the ROM folders.
+//
+// Names are normalized to lowercase letters, digits and single spaces, with
+// the extension dropped and a leading space so word starts form trigrams.
+// Each trigram keeps a posting list of catalog ROM indices, stored as
+// ascending deltas in LEB128 varints.
+//
+// File layout (native little-endian):
+//   SearchHeader
+//   uint32_t list_start[SEARCH_TRIGRAM_COUNT + 1]   byte offset of each list
+//   uint8_t postings[postings_size]
+#define SEARCH_INDEX_FILE "/mnt/sda1/configs/frogui_search.idx"
+#define SEARCH_MAGIC 0x52534746  // "FGSR"
+#define SEARCH_VERSION 1
+
+// 37 symbols (space, a-z, 0-9) cubed
+#define SEARCH_SYMBOLS 37
+#define SEARCH_TRIGRAM_COUNT (SEARCH_SYMBOLS * SEARCH_SYMBOLS * SEARCH_SYMBOLS)
+
+#define SEARCH_MAX_RESULTS 50
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t library_generation;  // Catalog this index was built from
+    uint32_t rom_count;
+    uint32_t postings_size;
+    uint32_t reserved2;
+} SearchHeader;
+
+typedef struct {
+    int rom_index;      // Catalog ROM index
+    int score;
+} SearchResult;
+
+// Use another index file than SEARCH_INDEX_FILE (host tools)
+void search_init(const char *index_path);
+
+// Make the index match the current catalog (call whenever the search screen
+// opens): keep it, load it with one read, or build and save it if missing or
+// stale. Returns 1 when the index is usable.
+int search_open(void);
+
+// Free the index
+void search_free(void);
+
+// Best matches for query, ranked by match quality then recency (recently
+// played, newest file). Returns the number of results written.
+int search_query(const char *query, SearchResult *results, int max_results);
+
+#endif // SEARCH_H
@@ -0,0 +1,157 @@
+#include "sysicons.h"
+#include "hash.h"
+#include "render.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The whole file, with pointers into it
+static uint8_t *atlas_data = NULL;
+static const SystemIconsHeader *atlas_header = NULL;
+static const uint16_t *atlas_palette = NULL;
+static const SystemIconEntry *atlas_entries = NULL;
+static const uint8_t *atlas_icons = NULL;
+
+// 1 if the runs decode to exactly pixels indices, all in the palette, so
+// drawing needs no checks
+static int check_runs(const uint8_t *src, uint32_t size, int pixels, int palette_count) {
+    const uint8_t *end = src + size;
+    int done = 0;
+    while (src < end) {
+        uint8_t control = *src++;
+        if (control < 0x80) {
+            int count = control + 1;
+            if (done + count > pixels || end - src < count) return 0;
+            for (int i = 0; i < count; i++) {
+                if (src[i] >= palette_count) return 0;
+            }
+            src += count;
+            done += count;
+        } else {
+            int count = control - 0x80 + 2;
+            if (done + count > pixels || src >= end || *src >= palette_count) return 0;
+            src++;
+            done += count;
+        }
+    }
+    return done == pixels;
+}
+
+int sysicons_load(const char *path) {
+    sysicons_free();
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return 0;
+    fseek(fp, 0, SEEK_END);
+    long file_size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    uint8_t *data = NULL;
+    if (file_size >= (long)sizeof(SystemIconsHeader) && file_size <= SYSICONS_MAX_FILE_SIZE) {
+        data = (uint8_t*)malloc(file_size);
+    }
+    if (!data || fread(data, 1, file_size, fp) != (size_t)file_size) {
+        free(data);
+        fclose(fp);
+        return 0;
+    }
+    fclose(fp);
+
+    const SystemIconsHeader *header = (const SystemIconsHeader*)data;
+    size_t tables_size = sizeof(SystemIconsHeader) +
+                         SYSICONS_PALETTE_SLOTS(header->palette_count) * sizeof(uint16_t) +
+                         header->icon_count * sizeof(SystemIconEntry);
+    if (header->magic != SYSICONS_MAGIC || header->version != SYSICONS_VERSION ||
+        header->icon_width == 0 || header->icon_width > SYSICONS_MAX_SIZE ||
+        header->icon_height == 0 || header->icon_height > SYSICONS_MAX_SIZE ||
+        header->palette_count == 0 || header->palette_count > 256 ||
+        tables_size > (size_t)file_size) {
+        free(data);
+        return 0;
+    }
+
+    const uint16_t *palette = (const uint16_t*)(data + sizeof(SystemIconsHeader));
+    const SystemIconEntry *entries = (const SystemIconEntry*)(palette + SYSICONS_PALETTE_SLOTS(header->palette_count));
+    const uint8_t *icons = data + tables_size;
+    uint32_t icons_size = (uint32_t)(file_size - tables_size);
+    int pixels = header->icon_width * header->icon_height;
+    for (int i = 0; i < header->icon_count; i++) {
+        const SystemIconEntry *entry = &entries[i];
+        if (entry->offset > icons_size || entry->size > icons_size - entry->offset ||
+            (i > 0 && entry->folder_hash <= entries[i - 1].folder_hash) ||
+            !check_runs(icons + entry->offset, entry->size, pixels, header->palette_count)) {
+            free(data);
+            return 0;
+        }
+    }
+
+    atlas_data = data;
+    atlas_header = header;
+    atlas_palette = palette;
+    atlas_entries = entries;
+    atlas_icons = icons;
+    return 1;
+}
+
+void sysicons_free(void) {
+    free(atlas_data);
+    atlas_data = NULL;
+    atlas_header = NULL;
+    atlas_palette = NULL;
+    atlas_entries = NULL;
+    atlas_icons = NULL;
+}
+
+int sysicons_width(void) {
+    return atlas_header ? atlas_header->icon_width : 0;
+}
+
+int sysicons_height(void) {
+    return atlas_header ? atlas_header->icon_height : 0;
+}
+
+int sysicons_find(const char *folder) {
+    if (!atlas_header || !folder) return SYSICON_NONE;
+
+    uint32_t folder_hash = hash_string_nocase(folder);
+    int lo = 0;
+    int hi = atlas_header->icon_count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (atlas_entries[mid].folder_hash == folder_hash) return mid;
+        if (atlas_entries[mid].folder_hash < folder_hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return SYSICON_NONE;
+}
+
+void sysicons_draw(uint16_t *framebuffer, int icon, int x, int y) {
+    if (!framebuffer || !atlas_header || icon < 0 || icon >= atlas_header->icon_count) return;
+
+    const SystemIconEntry *entry = &atlas_entries[icon];
+    const uint8_t *src = atlas_icons + entry->offset;
+    const uint8_t *end = src + entry->size;
+    int width = atlas_header->icon_width;
+    int pixel = 0;
+
+    // Walk the runs, plotting every index but 0 that lands on the screen
+    while (src < end) {
+        uint8_t control = *src++;
+        int literal = control < 0x80;
+        int count = literal ? control + 1 : control - 0x80 + 2;
+        uint8_t index = literal ? 0 : *src++;
+        for (int i = 0; i < count; i++, pixel++) {
+            if (literal) index = *src++;
+            if (index == 0) continue;
+
+            int screen_x = x + pixel % width;
+            int screen_y = y + pixel / width;
+            if (screen_x >= 0 && screen_x < SCREEN_WIDTH && screen_y >= 0 && screen_y < SCREEN_HEIGHT) {
+                framebuffer[screen_y * SCREEN_WIDTH + screen_x] = atlas_palette[index];
+            }
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef SYSICONS_H
+#define SYSICONS_H
+
+#include <stdint.h>
+
+// System icons for the root list: one atlas file of small icons keyed by
+// system folder name, read in one go at boot and kept in its on-disk form (a
+// shared palette and run-length coded indices), drawn straight from the runs.
+// The special rows are keyed by their list path (RECENT_GAMES, FAVORITES,
+// RANDOM_GAME, SEARCH, TOOLS). Written by tools/frogui_sysicons.
+//
+// File layout (little-endian):
+//   SystemIconsHeader
+//   uint16_t palette[palette_count]     RGB565, index 0 is transparent;
+//                                       padded to an even count so the
+//                                       entries stay 4-byte aligned
+//   SystemIconEntry[icon_count]         sorted by folder_hash
+//   icon data                           icon_width * icon_height palette
+//                                       indices each, row by row, in the
+//                                       runs of THUMBNAIL_FORMAT_PAL8_RLE
+//                                       (thumbcodec.h)
+#define SYSICONS_FILE "/mnt/sda1/frogui/system_icons.atlas"
+#define SYSICONS_MAGIC 0x49534746  // "FGSI"
+#define SYSICONS_VERSION 1
+#define SYSICONS_MAX_SIZE 24            // Icon width / height limit (one row)
+#define SYSICONS_MAX_FILE_SIZE (256 * 1024)
+#define SYSICONS_PALETTE_SLOTS(count) (((count) + 1) & ~1)
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t icon_count;
+    uint16_t icon_width;
+    uint16_t icon_height;
+    uint16_t palette_count;
+    uint16_t reserved;
+} SystemIconsHeader;
+
+typedef struct {
+    uint32_t folder_hash;       // hash_string_nocase of the folder name
+    uint32_t offset;            // From the start of the icon data
+    uint32_t size;
+} SystemIconEntry;
+
+// Icon arguments for render_menu_item: no icon column, or the column left empty
+#define SYSICON_NONE -1
+#define SYSICON_BLANK -2
+
+// Read the atlas (one file read). Returns 1 if there is one; without it the
+// root list stays text only.
+int sysicons_load(const char *path);
+
+// Free the atlas
+void sysicons_free(void);
+
+// Icon size, 0 without an atlas
+int sysicons_width(void);
+int sysicons_height(void);
+
+// Icon of a folder name (binary search), SYSICON_NONE if the atlas has none
+int sysicons_find(const char *folder);
+
+// Draw an icon with its top left corner at x, y
+void sysicons_draw(uint16_t *framebuffer, int icon, int x, int y);
+
+#endif // SYSICONS_H
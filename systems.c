@@ -0,0 +1,130 @@
+#include "systems.h"
+#include "hash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define xlog printf
+
+// Zipped ROMs are accepted for every system that has an extension list
+#define SYSTEMS_ARCHIVE_EXTENSION "zip"
+
+#include "systems_table.h"
+
+// Folders outside the registry that were given an ID (recent games and
+// favorites of custom folders), ID = SYSTEMS_TABLE_COUNT + index
+#define SYSTEMS_MAX_INTERNED (SYSTEM_ID_NONE - SYSTEMS_TABLE_COUNT)
+static char *interned_folders[SYSTEMS_MAX_INTERNED];
+static int interned_count = 0;
+
+SystemId systems_find(const char *folder) {
+    uint32_t seed = system_displace[hash_string_seeded(folder, 0) % SYSTEMS_TABLE_COUNT];
+    uint32_t slot = hash_string_seeded(folder, seed) % SYSTEMS_TABLE_COUNT;
+    return strcmp(system_table[slot].folder, folder) == 0 ? (SystemId)slot : SYSTEM_ID_NONE;
+}
+
+SystemId systems_lookup(const char *folder) {
+    SystemId id = systems_find(folder);
+    if (id != SYSTEM_ID_NONE) return id;
+
+    for (int i = 0; i < interned_count; i++) {
+        if (strcmp(interned_folders[i], folder) == 0) return (SystemId)(SYSTEMS_TABLE_COUNT + i);
+    }
+    return SYSTEM_ID_NONE;
+}
+
+SystemId systems_intern(const char *folder) {
+    SystemId id = systems_lookup(folder);
+    if (id != SYSTEM_ID_NONE || !folder[0]) return id;
+    if (interned_count >= SYSTEMS_MAX_INTERNED) {
+        // Recent games and favorites of this folder are left out
+        xlog("Systems: no ID left for %s\n", folder);
+        return SYSTEM_ID_NONE;
+    }
+
+    size_t len = strlen(folder);
+    char *copy = (char*)malloc(len + 1);
+    if (!copy) return SYSTEM_ID_NONE;
+    memcpy(copy, folder, len + 1);
+
+    interned_folders[interned_count] = copy;
+    return (SystemId)(SYSTEMS_TABLE_COUNT + interned_count++);
+}
+
+const char* systems_folder(SystemId id) {
+    if (id < SYSTEMS_TABLE_COUNT) return system_table[id].folder;
+    if (id != SYSTEM_ID_NONE && id - SYSTEMS_TABLE_COUNT < interned_count) {
+        return interned_folders[id - SYSTEMS_TABLE_COUNT];
+    }
+    return "";
+}
+
+const SystemInfo* systems_get(SystemId id) {
+    return id < SYSTEMS_TABLE_COUNT ? &system_table[id] : NULL;
+}
+
+static const SystemInfo* find_mapping(const char *console_name) {
+    return systems_get(systems_find(console_name));
+}
+
+const char* systems_get_core_name(const char *console_name) {
+    const SystemInfo *mapping = find_mapping(console_name);
+    return mapping ? mapping->core_name : NULL;
+}
+
+static void add_extension(ExtensionFilter *filter, const char *ext, int len) {
+    char buf[16];
+    if (len <= 0 || len >= (int)sizeof(buf) || filter->count >= SYSTEMS_MAX_EXTENSIONS) return;
+
+    memcpy(buf, ext, len);
+    buf[len] = '\0';
+    uint32_t hash = hash_string_nocase(buf);
+
+    for (int i = 0; i < filter->count; i++) {
+        if (filter->hashes[i] == hash) return; // Already listed
+    }
+    filter->hashes[filter->count++] = hash;
+}
+
+int systems_loads_archives(const char *console_name) {
+    const SystemInfo *mapping = find_mapping(console_name);
+    if (!mapping || !mapping->extensions) return 1;
+
+    const char *p = mapping->extensions;
+    while (*p) {
+        const char *start = p;
+        while (*p && *p != ' ') p++;
+        if (p - start == 3 && strncmp(start, SYSTEMS_ARCHIVE_EXTENSION, 3) == 0) return 1;
+        while (*p == ' ') p++;
+    }
+    return 0;
+}
+
+void systems_get_extension_filter(const char *console_name, ExtensionFilter *filter) {
+    filter->count = 0;
+
+    const SystemInfo *mapping = console_name ? find_mapping(console_name) : NULL;
+    if (!mapping || !mapping->extensions) return;
+
+    const char *p = mapping->extensions;
+    while (*p) {
+        const char *start = p;
+        while (*p && *p != ' ') p++;
+        add_extension(filter, start, p - start);
+        while (*p == ' ') p++;
+    }
+    add_extension(filter, SYSTEMS_ARCHIVE_EXTENSION, strlen(SYSTEMS_ARCHIVE_EXTENSION));
+}
+
+int systems_extension_allowed(const ExtensionFilter *filter, const char *file_name) {
+    if (filter->count == 0) return 1;
+
+    const char *dot = strrchr(file_name, '.');
+    if (!dot || dot == file_name) return 0;
+
+    uint32_t hash = hash_string_nocase(dot + 1);
+    for (int i = 0; i < filter->count; i++) {
+        if (filter->hashes[i] == hash) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+#ifndef SYSTEMS_H
+#define SYSTEMS_H
+
+#include <stdint.h>
+
+// System registry: console folder -> core (systems.list) with the file
+// extensions each core loads and a display name. extensions is space
+// separated, lowercase, without dots; NULL means the core takes any file
+// (ports, game data folders). A display name several folders share carries
+// the folder name too ("Game Boy (gbb)").
+//
+// The table is generated at build time (tools/gensystems.c -> systems_table.h)
+// with a minimal perfect hash, so a folder name is resolved in O(1) to a small
+// SystemId. Recent games and favorites keep that ID instead of the folder
+// name; folders outside the registry are interned at runtime and get IDs
+// after the generated ones.
+typedef struct {
+    const char *folder;
+    const char *core_name;
+    const char *extensions;
+    const char *display_name;
+} SystemInfo;
+
+typedef uint8_t SystemId;
+#define SYSTEM_ID_NONE 0xFF
+
+// Registry system of a console folder, SYSTEM_ID_NONE if unknown
+SystemId systems_find(const char *folder);
+
+// ID of any folder name: its registry ID, or one interned for it.
+// systems_lookup only returns IDs already handed out; systems_intern adds one
+// (SYSTEM_ID_NONE, logged, once the ID space is used up: recent games and
+// favorites of that folder are then dropped).
+SystemId systems_lookup(const char *folder);
+SystemId systems_intern(const char *folder);
+
+// Folder name of an ID ("" for SYSTEM_ID_NONE)
+const char* systems_folder(SystemId id);
+
+// Registry entry of an ID, NULL for interned folders
+const SystemInfo* systems_get(SystemId id);
+
+// Get core name for a console folder, NULL if unknown
+const char* systems_get_core_name(const char *console_name);
+
+// Precomputed extension hashes for one system, built once per scan
+#define SYSTEMS_MAX_EXTENSIONS 8
+
+typedef struct {
+    int count;                                  // 0 = accept every file
+    uint32_t hashes[SYSTEMS_MAX_EXTENSIONS];    // hash_string_nocase() of each extension
+} ExtensionFilter;
+
+// Fill the filter for a console folder. Unknown folders and cores without
+// an extension list get an empty filter that accepts everything.
+void systems_get_extension_filter(const char *console_name, ExtensionFilter *filter);
+
+// 1 if the core loads .zip files as its own ROM format (arcade sets), or takes
+// any file; archives for these systems are launched, never opened as folders
+int systems_loads_archives(const char *console_name);
+
+// Test a file name against the filter without copying it
+int systems_extension_allowed(const ExtensionFilter *filter, const char *file_name);
+
+#endif // SYSTEMS_H
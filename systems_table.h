@@ -0,0 +1,88 @@
+// Generated by tools/gensystems.c from systems.list - do not edit.
+// Included by systems.c only.
+
+#define SYSTEMS_TABLE_COUNT 70
+
+// In slot order: the index is the SystemId
+static const SystemInfo system_table[SYSTEMS_TABLE_COUNT] = {
+    {"arduboy", "Arduous", "hex", "Arduboy"},
+    {"amstradb", "CAP32", "dsk sna", "Amstrad CPC (amstradb)"},
+    {"mgba", "mGBA", "gba", "Game Boy Advance (mgba)"},
+    {"a78", "ProSystem", "a78 bin", "Atari 7800"},
+    {"c64sc", "VICE-x64sc", "d64 t64 prg", "Commodore 64 (c64sc)"},
+    {"outrun", "Cannonball", NULL, "OutRun"},
+    {"vec", "VecX", "vec bin", "Vectrex"},
+    {"o2em", "O2EM", "bin", "Odyssey 2"},
+    {"ngpc", "RACE", "ngp ngc", "Neo Geo Pocket"},
+    {"gbav", "VBA-Next", "gba", "Game Boy Advance (gbav)"},
+    {"cavestory", "NXEngine", NULL, "Cave Story"},
+    {"m2k", "MAME2000", "zip", "Arcade"},
+    {"pokem", "PokeMini", "min", "Pokemon Mini"},
+    {"gba", "gpSP", "gba", "Game Boy Advance (gba)"},
+    {"pcfx", "Beetle-PCFX", "cue ccd", "PC-FX"},
+    {"nesq", "QuickNES", "nes", "NES (nesq)"},
+    {"fake08", "FAKE-08", "p8 png", "PICO-8 (fake08)"},
+    {"gong", "Gong", NULL, "Gong"},
+    {"pce", "Beetle-PCE-Fast", "pce cue", "PC Engine"},
+    {"amstrad", "CrocoDS", "dsk sna", "Amstrad CPC (amstrad)"},
+    {"wsv", "Potator", "sv", "Supervision"},
+    {"a26", "Stella2014", "a26 bin", "Atari 2600"},
+    {"gbaf", "gpSP", "gba", "Game Boy Advance (gbaf)"},
+    {"zx81", "EightyOne", "p 81", "ZX81"},
+    {"fcf", "FreeChaF", "bin chf", "Channel F"},
+    {"c64", "VICE-x64", "d64 t64 prg", "Commodore 64 (c64)"},
+    {"wswan", "Beetle-WonderSwan", "ws wsc", "WonderSwan"},
+    {"gme", "Game-Music-Emu", "nsf spc vgm gbs", "Game Music"},
+    {"xmil", "X-Millennium", "2d 2hd", "Sharp X1"},
+    {"spec", "Fuse", "tzx tap z80", "ZX Spectrum"},
+    {"c64fc", "Frodo", NULL, "Commodore 64 (c64fc)"},
+    {"nes", "FCEUmm", "nes fds", "NES (nes)"},
+    {"lnx", "Handy", "lnx", "Atari Lynx (lnx)"},
+    {"gbaff", "gpSP", "gba", "Game Boy Advance (gbaff)"},
+    {"vapor", "VaporSpec", "vaporbin", "VaporSpec"},
+    {"pcesgx", "Beetle-SuperGrafx", "pce sgx", "SuperGrafx"},
+    {"sega", "PicoDrive", "md gen smd", "Mega Drive (sega)"},
+    {"a800", "Atari800", "atr xex", "Atari 800"},
+    {"col", "Gearcoleco", "col", "ColecoVision"},
+    {"a5200", "Atari5200", "a52 bin", "Atari 5200"},
+    {"chip8", "JAXE", "ch8", "CHIP-8"},
+    {"vic20", "VICE-xvic", "d64 prg", "VIC-20"},
+    {"gb", "Gambatte", "gb gbc", "Game Boy (gb)"},
+    {"lowres-nx", "LowRes-NX", "nx", "LowRes NX"},
+    {"js2000", "js2000", NULL, "JavaScript"},
+    {"gg", "Gearsystem", "gg sms", "Game Gear"},
+    {"gw", "Game-and-Watch", "mgw", "Game & Watch"},
+    {"int", "FreeIntv", "int bin", "Intellivision"},
+    {"dblcherrygb", "DoubleCherry-GB", "gb gbc", "Game Boy (dblcherrygb)"},
+    {"gbgb", "Gearboy", "gb gbc", "Game Boy (gbgb)"},
+    {"jnb", "Jump-n-Bump", NULL, "Jump 'n Bump"},
+    {"quake", "TyrQuake", "pak", "Quake"},
+    {"msx", "BlueMSX", "rom dsk", "MSX"},
+    {"snes02", "Snes9x2002", "sfc smc", "Super Nintendo (snes02)"},
+    {"cdg", "PocketCDG", "cdg", "Karaoke CD+G"},
+    {"pc8800", "QUASI88", "d88", "PC-8801"},
+    {"gpgx", "Genesis-Plus-GX", "md gen", "Mega Drive (gpgx)"},
+    {"gbb", "TGBDual", "gb gbc", "Game Boy (gbb)"},
+    {"bk", "BK-Emulator", NULL, "Elektronika BK"},
+    {"thom", "Theodore", "fd k7", "Thomson MO/TO"},
+    {"nest", "Nestopia", "nes fds", "NES (nest)"},
+    {"prboom", "PrBoom", "wad", "Doom"},
+    {"flashback", "REminiscence", NULL, "Flashback"},
+    {"xrick", "XRick", NULL, "Rick Dangerous"},
+    {"retro8", "Retro8", "p8 png", "PICO-8 (retro8)"},
+    {"lnxb", "Beetle-Lynx", "lnx", "Atari Lynx (lnxb)"},
+    {"vb", "Beetle-VB", "vb vboy", "Virtual Boy"},
+    {"snes", "Snes9x2005", "sfc smc", "Super Nintendo (snes)"},
+    {"wolf3d", "ECWolf", "wl6", "Wolfenstein 3D"},
+    {"c64f", "Frodo", NULL, "Commodore 64 (c64f)"}
+};
+
+// Seed for each bucket (hash_string_seeded(folder, 0) % SYSTEMS_TABLE_COUNT)
+static const uint16_t system_displace[SYSTEMS_TABLE_COUNT] = {
+    1, 0, 1, 0, 0, 1, 0, 1, 0, 2, 1, 1,
+    4, 1, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0,
+    3, 2, 1, 3, 2, 0, 0, 0, 4, 0, 2, 0,
+    0, 1, 9, 4, 17, 0, 0, 1, 0, 0, 0, 3,
+    10, 1, 0, 7, 0, 18, 0, 0, 0, 0, 0, 3,
+    15, 7, 17, 6, 7, 0, 0, 21, 0, 0
+};
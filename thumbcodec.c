@@ -0,0 +1,47 @@
+#include "thumbcodec.h"
+#include <string.h>
+
+static int decode_pal8_rle(const uint8_t *src, uint32_t src_size, uint16_t *dst, int pixels) {
+    if (src_size < 2) return 0;
+    uint32_t palette_count = src[0] | (src[1] << 8);
+    if (palette_count == 0 || palette_count > 256 || src_size < 2 + palette_count * 2) return 0;
+
+    // Unused entries stay 0, so a bad index gives black instead of garbage
+    uint16_t palette[256];
+    memset(palette, 0, sizeof(palette));
+    const uint8_t *p = src + 2;
+    for (uint32_t i = 0; i < palette_count; i++, p += 2) {
+        palette[i] = p[0] | (p[1] << 8);
+    }
+
+    const uint8_t *end = src + src_size;
+    uint16_t *out = dst;
+    uint16_t *out_end = dst + pixels;
+    while (out < out_end) {
+        if (p >= end) return 0;
+        uint8_t control = *p++;
+        if (control < 0x80) {
+            int count = control + 1;
+            if (count > out_end - out || count > end - p) return 0;
+            while (count--) *out++ = palette[*p++];
+        } else {
+            int count = control - 0x80 + 2;
+            if (count > out_end - out || p >= end) return 0;
+            uint16_t color = palette[*p++];
+            while (count--) *out++ = color;
+        }
+    }
+    return p == end;
+}
+
+int thumbcodec_decode(int format, const uint8_t *src, uint32_t src_size, uint16_t *dst, int pixels) {
+    if (format == THUMBNAIL_FORMAT_RGB565) {
+        if (src_size != (uint32_t)pixels * 2) return 0;
+        memcpy(dst, src, src_size);
+        return 1;
+    }
+    if (format == THUMBNAIL_FORMAT_PAL8_RLE) {
+        return decode_pal8_rle(src, src_size, dst, pixels);
+    }
+    return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef THUMBCODEC_H
+#define THUMBCODEC_H
+
+#include <stdint.h>
+
+// Thumbnail pixel formats. Compressed thumbnails trade SD reads (the slow
+// part of showing one) for a decode that writes straight into the caller's
+// RGB565 buffer.
+//
+// THUMBNAIL_FORMAT_PAL8_RLE (little-endian):
+//   uint16_t palette_count            1..256
+//   uint16_t palette[palette_count]   RGB565
+//   runs until every pixel is written, each starting with a control byte:
+//     0x00-0x7F  (c + 1) literal indices follow
+//     0x80-0xFF  one index follows, repeated (c - 0x80 + 2) times
+#define THUMBNAIL_FORMAT_RGB565 0       // Raw RGB565, width * height * 2 bytes
+#define THUMBNAIL_FORMAT_PAL8_RLE 1
+
+// Largest PAL8_RLE stream for a number of pixels (all literals, full palette)
+#define THUMBCODEC_PAL8_MAX_SIZE(pixels) (2 + 256 * 2 + (pixels) + ((pixels) + 127) / 128)
+
+// Decode src into exactly pixels RGB565 pixels. Returns 1 on success, 0 if
+// the format is unknown or the data is truncated, overruns or is left over.
+int thumbcodec_decode(int format, const uint8_t *src, uint32_t src_size, uint16_t *dst, int pixels);
+
+#endif // THUMBCODEC_H
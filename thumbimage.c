@@ -0,0 +1,74 @@
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#define STBI_NO_STDIO
+#define STBI_NO_LINEAR
+#define STBI_NO_THREAD_LOCALS
+#define STBI_MAX_DIMENSIONS 8192
+#include "stb_image.h"
+
+#include "thumbimage.h"
+
+int thumbimage_info(const uint8_t *data, int size, int *width, int *height) {
+    int channels;
+    if (!stbi_info_from_memory(data, size, width, height, &channels)) return 0;
+    return *width > 0 && *height > 0 && (long)*width * *height <= THUMBIMAGE_MAX_PIXELS;
+}
+
+uint8_t *thumbimage_decode(const uint8_t *data, int size, int *width, int *height) {
+    int channels;
+    if (!thumbimage_info(data, size, width, height)) return NULL;
+    return stbi_load_from_memory(data, size, width, height, &channels, 3);
+}
+
+void thumbimage_free(uint8_t *rgb) {
+    stbi_image_free(rgb);
+}
+
+void thumbimage_fit(int width, int height, int max_width, int max_height, int *out_width, int *out_height) {
+    *out_width = width;
+    *out_height = height;
+    if (width <= max_width && height <= max_height) return;
+
+    // Scale by the tighter of the two limits, in integers
+    if ((long)width * max_height > (long)height * max_width) {
+        *out_width = max_width;
+        *out_height = (int)(((long)height * max_width + width / 2) / width);
+    } else {
+        *out_height = max_height;
+        *out_width = (int)(((long)width * max_height + height / 2) / height);
+    }
+    if (*out_width < 1) *out_width = 1;
+    if (*out_height < 1) *out_height = 1;
+}
+
+void thumbimage_scale_rows(const uint8_t *rgb, int src_width, int src_height,
+                           uint16_t *dst, int dst_width, int dst_height, int first_row, int rows) {
+    for (int y = first_row; y < first_row + rows && y < dst_height; y++) {
+        // Source rows and columns under this pixel (at least one)
+        int y0 = (int)((long)y * src_height / dst_height);
+        int y1 = (int)((long)(y + 1) * src_height / dst_height);
+        if (y1 <= y0) y1 = y0 + 1;
+
+        for (int x = 0; x < dst_width; x++) {
+            int x0 = (int)((long)x * src_width / dst_width);
+            int x1 = (int)((long)(x + 1) * src_width / dst_width);
+            if (x1 <= x0) x1 = x0 + 1;
+
+            uint32_t r = 0, g = 0, b = 0;
+            for (int sy = y0; sy < y1; sy++) {
+                const uint8_t *p = rgb + ((long)sy * src_width + x0) * 3;
+                for (int sx = x0; sx < x1; sx++, p += 3) {
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                }
+            }
+            uint32_t count = (uint32_t)(y1 - y0) * (x1 - x0);
+            r /= count;
+            g /= count;
+            b /= count;
+            dst[y * dst_width + x] = (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+        }
+    }
+}
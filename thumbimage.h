@@ -0,0 +1,40 @@
+#ifndef THUMBIMAGE_H
+#define THUMBIMAGE_H
+
+#include <stdint.h>
+
+// PNG / JPEG art decoded on the device (stb_image), for games whose .res
+// folder has a picture but no .rgb565 thumbnail yet. The images are decoded
+// from memory to 8-bit RGB and scaled a band of rows at a time, so the
+// caller can spread the work over frames.
+
+// Largest source accepted: the file is read whole and decoded to 3 bytes a
+// pixel, so these bound the memory a decode takes. The decode is one call,
+// so the pixel limit also bounds the frame it runs in: 512x512 is about
+// 10M cycles of JPEG / PNG decoding, under one 60fps frame on the device.
+#ifndef THUMBIMAGE_MAX_FILE_SIZE
+#define THUMBIMAGE_MAX_FILE_SIZE (1024 * 1024)
+#endif
+#ifndef THUMBIMAGE_MAX_PIXELS
+#define THUMBIMAGE_MAX_PIXELS (512 * 512)
+#endif
+
+// Dimensions of an encoded image without decoding it. Returns 0 if it is not
+// a PNG / JPEG or is larger than THUMBIMAGE_MAX_PIXELS.
+int thumbimage_info(const uint8_t *data, int size, int *width, int *height);
+
+// Decode to RGB (3 bytes a pixel). Returns NULL on failure; free with
+// thumbimage_free.
+uint8_t *thumbimage_decode(const uint8_t *data, int size, int *width, int *height);
+void thumbimage_free(uint8_t *rgb);
+
+// Size that fits max_width x max_height keeping the aspect ratio; never enlarges
+void thumbimage_fit(int width, int height, int max_width, int max_height, int *out_width, int *out_height);
+
+// Rows [first_row, first_row + rows) of the RGB image scaled to
+// dst_width x dst_height as RGB565 (each pixel the average of the source
+// pixels it covers)
+void thumbimage_scale_rows(const uint8_t *rgb, int src_width, int src_height,
+                           uint16_t *dst, int dst_width, int dst_height, int first_row, int rows);
+
+#endif // THUMBIMAGE_H
@@ -0,0 +1,238 @@
+// FrogUI system registry generator: turns systems.list into systems_table.h,
+// the system table plus a minimal perfect hash from folder name to system ID.
+//
+// Usage: gensystems <systems.list> <systems_table.h>
+//
+// Hash and displace: each folder name goes to a bucket by its unseeded hash;
+// buckets are placed largest first, each with the first seed that sends all
+// its names to free slots. A lookup is then two hashes and one strcmp, and
+// the table is stored in slot order so the slot is the system ID.
+#include "hash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SYSTEMS 250     // IDs are uint8_t, with room left for interned folders
+#define MAX_SEED 65535
+
+typedef struct {
+    char folder[64];
+    char core_name[64];
+    char extensions[128];
+    char display_name[64];
+} SystemLine;
+
+static SystemLine systems[MAX_SYSTEMS];
+static int system_count = 0;
+
+// Split off the next '|' separated field
+static char *next_field(char **cursor) {
+    char *field = *cursor;
+    if (!field) return NULL;
+    char *bar = strchr(field, '|');
+    if (bar) {
+        *bar = '\0';
+        *cursor = bar + 1;
+    } else {
+        *cursor = NULL;
+    }
+    return field;
+}
+
+static int copy_field(char *dest, size_t dest_size, const char *field) {
+    if (!field || strlen(field) >= dest_size) return 0;
+    strcpy(dest, field);
+    return 1;
+}
+
+static int read_list(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 0;
+    }
+
+    char line[512];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        line_number++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') continue;
+
+        if (system_count >= MAX_SYSTEMS) {
+            fprintf(stderr, "%s:%d: too many systems\n", path, line_number);
+            fclose(fp);
+            return 0;
+        }
+
+        SystemLine *system = &systems[system_count];
+        char *cursor = line;
+        if (!copy_field(system->folder, sizeof(system->folder), next_field(&cursor)) ||
+            !copy_field(system->core_name, sizeof(system->core_name), next_field(&cursor)) ||
+            !copy_field(system->extensions, sizeof(system->extensions), next_field(&cursor)) ||
+            !copy_field(system->display_name, sizeof(system->display_name), next_field(&cursor)) ||
+            cursor != NULL || system->folder[0] == '\0') {
+            fprintf(stderr, "%s:%d: expected folder|core|extensions|display name\n", path, line_number);
+            fclose(fp);
+            return 0;
+        }
+
+        for (int i = 0; i < system_count; i++) {
+            if (strcmp(systems[i].folder, system->folder) == 0) {
+                fprintf(stderr, "%s:%d: %s listed twice\n", path, line_number, system->folder);
+                fclose(fp);
+                return 0;
+            }
+        }
+        system_count++;
+    }
+    fclose(fp);
+    return system_count > 0;
+}
+
+// A display name several folders share (gb, gbb, gbgb all "Game Boy") does
+// not tell them apart: those systems get their folder name added
+// ("Game Boy (gbb)"), or only the folder name when that does not fit
+static void qualify_shared_display_names(void) {
+    int shared[MAX_SYSTEMS] = {0};
+    for (int i = 0; i < system_count; i++) {
+        for (int j = i + 1; j < system_count; j++) {
+            if (systems[i].display_name[0] && strcmp(systems[i].display_name, systems[j].display_name) == 0) {
+                shared[i] = shared[j] = 1;
+            }
+        }
+    }
+    for (int i = 0; i < system_count; i++) {
+        if (!shared[i]) continue;
+        SystemLine *system = &systems[i];
+        char qualified[sizeof(system->display_name) + sizeof(system->folder) + 4];
+        snprintf(qualified, sizeof(qualified), "%s (%s)", system->display_name, system->folder);
+        if (!copy_field(system->display_name, sizeof(system->display_name), qualified)) {
+            system->display_name[0] = '\0';
+        }
+    }
+}
+
+static int bucket_of[MAX_SYSTEMS];
+static int bucket_size[MAX_SYSTEMS];
+static int bucket_order[MAX_SYSTEMS];
+static unsigned displace[MAX_SYSTEMS];
+static int slot_system[MAX_SYSTEMS];    // Line placed in each slot, -1 if free
+
+static int compare_buckets(const void *a, const void *b) {
+    int ba = *(const int*)a;
+    int bb = *(const int*)b;
+    if (bucket_size[ba] != bucket_size[bb]) return bucket_size[bb] - bucket_size[ba];
+    return ba - bb;
+}
+
+static int build_hash(void) {
+    int n = system_count;
+    for (int i = 0; i < n; i++) {
+        bucket_size[i] = 0;
+        bucket_order[i] = i;
+        slot_system[i] = -1;
+    }
+    for (int i = 0; i < n; i++) {
+        bucket_of[i] = hash_string_seeded(systems[i].folder, 0) % n;
+        bucket_size[bucket_of[i]]++;
+    }
+    qsort(bucket_order, n, sizeof(int), compare_buckets);
+
+    for (int b = 0; b < n; b++) {
+        int bucket = bucket_order[b];
+        if (bucket_size[bucket] == 0) break;
+
+        int members[MAX_SYSTEMS];
+        int member_count = 0;
+        for (int i = 0; i < n; i++) {
+            if (bucket_of[i] == bucket) members[member_count++] = i;
+        }
+
+        unsigned seed;
+        for (seed = 0; seed <= MAX_SEED; seed++) {
+            int slots[MAX_SYSTEMS];
+            int fits = 1;
+            for (int m = 0; m < member_count && fits; m++) {
+                slots[m] = hash_string_seeded(systems[members[m]].folder, seed) % n;
+                if (slot_system[slots[m]] >= 0) fits = 0;
+                for (int k = 0; k < m && fits; k++) {
+                    if (slots[k] == slots[m]) fits = 0;
+                }
+            }
+            if (fits) {
+                for (int m = 0; m < member_count; m++) slot_system[slots[m]] = members[m];
+                break;
+            }
+        }
+        if (seed > MAX_SEED) {
+            fprintf(stderr, "No seed places bucket %d\n", bucket);
+            return 0;
+        }
+        displace[bucket] = seed;
+    }
+    return 1;
+}
+
+static void write_string(FILE *fp, const char *str) {
+    if (!str[0]) {
+        fputs("NULL", fp);
+        return;
+    }
+    fputc('"', fp);
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\') fputc('\\', fp);
+        fputc(*str, fp);
+    }
+    fputc('"', fp);
+}
+
+static int write_table(const char *path) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return 0;
+    }
+
+    fprintf(fp, "// Generated by tools/gensystems.c from systems.list - do not edit.\n");
+    fprintf(fp, "// Included by systems.c only.\n\n");
+    fprintf(fp, "#define SYSTEMS_TABLE_COUNT %d\n\n", system_count);
+
+    fprintf(fp, "// In slot order: the index is the SystemId\n");
+    fprintf(fp, "static const SystemInfo system_table[SYSTEMS_TABLE_COUNT] = {\n");
+    for (int i = 0; i < system_count; i++) {
+        const SystemLine *system = &systems[slot_system[i]];
+        fputs("    {", fp);
+        write_string(fp, system->folder);
+        fputs(", ", fp);
+        write_string(fp, system->core_name);
+        fputs(", ", fp);
+        write_string(fp, system->extensions);
+        fputs(", ", fp);
+        write_string(fp, system->display_name);
+        fputs(i + 1 < system_count ? "},\n" : "}\n", fp);
+    }
+    fprintf(fp, "};\n\n");
+
+    fprintf(fp, "// Seed for each bucket (hash_string_seeded(folder, 0) %% SYSTEMS_TABLE_COUNT)\n");
+    fprintf(fp, "static const uint16_t system_displace[SYSTEMS_TABLE_COUNT] = {");
+    for (int i = 0; i < system_count; i++) {
+        fprintf(fp, "%s%u", i % 12 == 0 ? "\n    " : " ", displace[i]);
+        if (i + 1 < system_count) fputc(',', fp);
+    }
+    fprintf(fp, "\n};\n");
+
+    int ok = !ferror(fp);
+    if (fclose(fp) != 0) ok = 0;
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: gensystems <systems.list> <systems_table.h>\n");
+        return 1;
+    }
+    if (!read_list(argv[1]) || !build_hash()) return 1;
+    qualify_shared_display_names();
+    return write_table(argv[2]) ? 0 : 1;
+}
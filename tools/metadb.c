@@ -0,0 +1,431 @@
+// FrogUI metadata compiler: turns No-Intro / libretro DAT files (clrmamepro
+// format) into the per-system metadata table the menu loads (see metadb.h).
+//
+// Usage: frogui_metadb <output.db> <input.dat>...
+//
+// Copy the output to /mnt/sda1/configs/frogui_meta_<system folder>.db. Each
+// game gives a clean title (its description without the "(USA) (Rev 1)" tags),
+// a region and a release year, keyed by every ROM file name and CRC it lists.
+#include "hash.h"
+#include "metadb.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TOKEN_MAX 1024
+#define TOKEN_EOF 0
+#define TOKEN_OPEN 1
+#define TOKEN_CLOSE 2
+#define TOKEN_WORD 3     // Bare word or quoted string
+
+typedef struct {
+    char key[METADB_KEY_MAX + 1];
+    uint32_t title_offset;
+    uint32_t region_offset;
+    uint16_t year;
+    uint32_t crc;
+    int has_crc;
+    int order;          // Input order, so the first game wins a duplicate key
+} GameEntry;
+
+static GameEntry *games = NULL;
+static int game_count = 0;
+static int game_capacity = 0;
+
+// Shared string table, deduplicated through an open-addressing hash
+static char *strings = NULL;
+static uint32_t strings_size = 0;
+static uint32_t strings_capacity = 0;
+static uint32_t *string_slots = NULL;   // Offset + 1, 0 if empty
+static uint32_t string_slot_mask = 0;
+static uint32_t string_count = 0;
+
+static void *checked_realloc(void *ptr, size_t size) {
+    void *new_ptr = realloc(ptr, size);
+    if (!new_ptr) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    return new_ptr;
+}
+
+static void grow_string_slots(void) {
+    uint32_t new_mask = string_slot_mask ? string_slot_mask * 2 + 1 : 1023;
+    uint32_t *new_slots = (uint32_t*)calloc(new_mask + 1, sizeof(uint32_t));
+    if (!new_slots) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    for (uint32_t i = 0; string_slot_mask && i <= string_slot_mask; i++) {
+        if (!string_slots[i]) continue;
+        uint32_t slot = hash_string(strings + string_slots[i] - 1) & new_mask;
+        while (new_slots[slot]) slot = (slot + 1) & new_mask;
+        new_slots[slot] = string_slots[i];
+    }
+    free(string_slots);
+    string_slots = new_slots;
+    string_slot_mask = new_mask;
+}
+
+static uint32_t add_string(const char *str) {
+    if ((string_count + 1) * 2 > string_slot_mask) grow_string_slots();
+
+    uint32_t slot = hash_string(str) & string_slot_mask;
+    while (string_slots[slot]) {
+        if (strcmp(strings + string_slots[slot] - 1, str) == 0) return string_slots[slot] - 1;
+        slot = (slot + 1) & string_slot_mask;
+    }
+
+    uint32_t len = strlen(str);
+    if (strings_size + len + 1 > strings_capacity) {
+        strings_capacity = strings_capacity ? strings_capacity * 2 : 65536;
+        while (strings_capacity < strings_size + len + 1) strings_capacity *= 2;
+        strings = (char*)checked_realloc(strings, strings_capacity);
+    }
+
+    uint32_t offset = strings_size;
+    memcpy(strings + offset, str, len + 1);
+    strings_size += len + 1;
+    string_slots[slot] = offset + 1;
+    string_count++;
+    return offset;
+}
+
+static int next_token(const char **cursor, char *token) {
+    const char *p = *cursor;
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+
+    int type;
+    if (*p == '\0') {
+        type = TOKEN_EOF;
+    } else if (*p == '(') {
+        type = TOKEN_OPEN;
+        p++;
+    } else if (*p == ')') {
+        type = TOKEN_CLOSE;
+        p++;
+    } else {
+        type = TOKEN_WORD;
+        int len = 0;
+        if (*p == '"') {
+            p++;
+            while (*p && *p != '"') {
+                if (len < TOKEN_MAX - 1) token[len++] = *p;
+                p++;
+            }
+            if (*p == '"') p++;
+        } else {
+            while (*p && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n' && *p != '(' && *p != ')') {
+                if (len < TOKEN_MAX - 1) token[len++] = *p;
+                p++;
+            }
+        }
+        token[len] = '\0';
+    }
+    *cursor = p;
+    return type;
+}
+
+// Skip to the end of a block whose "(" was just read
+static void skip_block(const char **cursor) {
+    char token[TOKEN_MAX];
+    int depth = 1;
+    while (depth > 0) {
+        int type = next_token(cursor, token);
+        if (type == TOKEN_EOF) return;
+        if (type == TOKEN_OPEN) depth++;
+        if (type == TOKEN_CLOSE) depth--;
+    }
+}
+
+// Title without the trailing "(...)" and "[...]" tags
+static void clean_title(const char *name, char *title, size_t title_size) {
+    size_t len = strcspn(name, "([");
+    while (len > 0 && name[len - 1] == ' ') len--;
+    if (len == 0) len = strlen(name);  // Name is all tags - keep it whole
+    if (len >= title_size) len = title_size - 1;
+    memcpy(title, name, len);
+    title[len] = '\0';
+}
+
+// First "(...)" tag of a No-Intro name, which is its region
+static void region_from_name(const char *name, char *region, size_t region_size) {
+    region[0] = '\0';
+    const char *open = strchr(name, '(');
+    if (!open) return;
+    const char *close = strchr(open, ')');
+    if (!close) return;
+
+    size_t len = close - open - 1;
+    if (len >= region_size) len = region_size - 1;
+    memcpy(region, open + 1, len);
+    region[len] = '\0';
+}
+
+static void add_game_key(const char *file_name, uint32_t title, uint32_t region, uint16_t year,
+                         uint32_t crc, int has_crc) {
+    char key[METADB_KEY_MAX + 1];
+    if (metadb_make_key(file_name, key, sizeof(key)) <= 0) return;
+
+    if (game_count >= game_capacity) {
+        game_capacity = game_capacity ? game_capacity * 2 : 4096;
+        games = (GameEntry*)checked_realloc(games, game_capacity * sizeof(GameEntry));
+    }
+
+    GameEntry *game = &games[game_count];
+    strcpy(game->key, key);
+    game->title_offset = title;
+    game->region_offset = region;
+    game->year = year;
+    game->crc = crc;
+    game->has_crc = has_crc;
+    game->order = game_count;
+    game_count++;
+}
+
+#define GAME_MAX_ROMS 64
+
+// Read one game block (after "game (") and add a key for each of its ROMs
+static void parse_game(const char **cursor) {
+    char token[TOKEN_MAX];
+    char name[TOKEN_MAX] = "";
+    char description[TOKEN_MAX] = "";
+    char region[TOKEN_MAX] = "";
+    int year = 0;
+
+    char rom_names[GAME_MAX_ROMS][TOKEN_MAX / 4];
+    uint32_t rom_crcs[GAME_MAX_ROMS];
+    int rom_has_crc[GAME_MAX_ROMS];
+    int rom_count = 0;
+
+    for (;;) {
+        int type = next_token(cursor, token);
+        if (type == TOKEN_EOF || type == TOKEN_CLOSE) break;
+        if (type == TOKEN_OPEN) {
+            skip_block(cursor);
+            continue;
+        }
+
+        char field[TOKEN_MAX];
+        strcpy(field, token);
+
+        if (strcmp(field, "rom") == 0) {
+            if (next_token(cursor, token) != TOKEN_OPEN) continue;
+            char rom_name[TOKEN_MAX] = "";
+            uint32_t crc = 0;
+            int has_crc = 0;
+            for (;;) {
+                type = next_token(cursor, token);
+                if (type == TOKEN_EOF || type == TOKEN_CLOSE) break;
+                if (type == TOKEN_OPEN) {
+                    skip_block(cursor);
+                    continue;
+                }
+                if (strcmp(token, "name") == 0) {
+                    next_token(cursor, rom_name);
+                } else if (strcmp(token, "crc") == 0) {
+                    next_token(cursor, token);
+                    crc = (uint32_t)strtoul(token, NULL, 16);
+                    has_crc = 1;
+                }
+            }
+            if (rom_name[0] && rom_count < GAME_MAX_ROMS) {
+                snprintf(rom_names[rom_count], sizeof(rom_names[0]), "%s", rom_name);
+                rom_crcs[rom_count] = crc;
+                rom_has_crc[rom_count] = has_crc;
+                rom_count++;
+            }
+            continue;
+        }
+
+        type = next_token(cursor, token);
+        if (type == TOKEN_OPEN) {
+            skip_block(cursor);
+            continue;
+        }
+        if (type != TOKEN_WORD) break;
+
+        if (strcmp(field, "name") == 0) {
+            snprintf(name, sizeof(name), "%s", token);
+        } else if (strcmp(field, "description") == 0) {
+            snprintf(description, sizeof(description), "%s", token);
+        } else if (strcmp(field, "region") == 0) {
+            snprintf(region, sizeof(region), "%s", token);
+        } else if (strcmp(field, "releaseyear") == 0 || strcmp(field, "year") == 0) {
+            year = atoi(token);
+        }
+    }
+
+    if (!name[0]) return;
+
+    char title[TOKEN_MAX];
+    clean_title(description[0] ? description : name, title, sizeof(title));
+    if (!region[0]) region_from_name(name, region, sizeof(region));
+    if (year < 0 || year > 65535) year = 0;
+
+    uint32_t title_offset = add_string(title);
+    uint32_t region_offset = add_string(region);
+
+    // The game name covers zipped sets named after the game
+    add_game_key(name, title_offset, region_offset, (uint16_t)year, 0, 0);
+    for (int i = 0; i < rom_count; i++) {
+        add_game_key(rom_names[i], title_offset, region_offset, (uint16_t)year, rom_crcs[i], rom_has_crc[i]);
+    }
+}
+
+static int parse_dat(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 0;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char *text = (char*)checked_realloc(NULL, size + 1);
+    size_t read_bytes = fread(text, 1, size, fp);
+    fclose(fp);
+    text[read_bytes] = '\0';
+
+    const char *cursor = text;
+    char token[TOKEN_MAX];
+    int type;
+    while ((type = next_token(&cursor, token)) != TOKEN_EOF) {
+        if (type != TOKEN_WORD) continue;
+
+        int is_game = strcmp(token, "game") == 0 || strcmp(token, "machine") == 0;
+        const char *after = cursor;
+        if (next_token(&after, token) != TOKEN_OPEN) continue;
+        cursor = after;
+        if (is_game) {
+            parse_game(&cursor);
+        } else {
+            skip_block(&cursor);  // clrmamepro header and the like
+        }
+    }
+
+    free(text);
+    return 1;
+}
+
+static int compare_games(const void *a, const void *b) {
+    const GameEntry *ga = (const GameEntry*)a;
+    const GameEntry *gb = (const GameEntry*)b;
+    int result = strcmp(ga->key, gb->key);
+    return result ? result : ga->order - gb->order;
+}
+
+static int compare_crcs(const void *a, const void *b) {
+    const MetaDbCrc *ca = (const MetaDbCrc*)a;
+    const MetaDbCrc *cb = (const MetaDbCrc*)b;
+    if (ca->crc != cb->crc) return ca->crc < cb->crc ? -1 : 1;
+    return (ca->entry > cb->entry) - (ca->entry < cb->entry);
+}
+
+static int write_db(const char *path) {
+    qsort(games, game_count, sizeof(GameEntry), compare_games);
+
+    // Drop duplicate keys (the first game listed wins), keep their CRCs
+    MetaDbCrc *crcs = (MetaDbCrc*)checked_realloc(NULL, (game_count ? game_count : 1) * sizeof(MetaDbCrc));
+    uint32_t crc_count = 0;
+    int entry_count = 0;
+    for (int i = 0; i < game_count; i++) {
+        if (entry_count == 0 || strcmp(games[entry_count - 1].key, games[i].key) != 0) {
+            games[entry_count++] = games[i];
+        }
+        if (games[i].has_crc) {
+            crcs[crc_count].crc = games[i].crc;
+            crcs[crc_count].entry = entry_count - 1;
+            crc_count++;
+        }
+    }
+
+    qsort(crcs, crc_count, sizeof(MetaDbCrc), compare_crcs);
+    uint32_t unique_crcs = 0;
+    for (uint32_t i = 0; i < crc_count; i++) {
+        if (unique_crcs == 0 || crcs[unique_crcs - 1].crc != crcs[i].crc) {
+            crcs[unique_crcs++] = crcs[i];
+        }
+    }
+
+    uint32_t block_count = (entry_count + METADB_BLOCK_SIZE - 1) / METADB_BLOCK_SIZE;
+    uint32_t *block_start = (uint32_t*)checked_realloc(NULL, (block_count ? block_count : 1) * sizeof(uint32_t));
+    MetaDbRecord *records = (MetaDbRecord*)checked_realloc(NULL, (entry_count ? entry_count : 1) * sizeof(MetaDbRecord));
+    uint8_t *keys = (uint8_t*)checked_realloc(NULL, (size_t)entry_count * (METADB_KEY_MAX + 2) + 1);
+    uint32_t keys_size = 0;
+
+    for (int i = 0; i < entry_count; i++) {
+        const char *key = games[i].key;
+        size_t len = strlen(key);
+        if (i % METADB_BLOCK_SIZE == 0) {
+            block_start[i / METADB_BLOCK_SIZE] = keys_size;
+            keys[keys_size++] = (uint8_t)len;
+            memcpy(keys + keys_size, key, len);
+            keys_size += len;
+        } else {
+            const char *prev = games[i - 1].key;
+            size_t prefix = 0;
+            while (prefix < len && prev[prefix] == key[prefix]) prefix++;
+            keys[keys_size++] = (uint8_t)prefix;
+            keys[keys_size++] = (uint8_t)(len - prefix);
+            memcpy(keys + keys_size, key + prefix, len - prefix);
+            keys_size += len - prefix;
+        }
+
+        records[i].title_offset = games[i].title_offset;
+        records[i].region_offset = games[i].region_offset;
+        records[i].year = games[i].year;
+        records[i].reserved = 0;
+    }
+
+    if (strings_size == 0) add_string("");
+
+    MetaDbHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = METADB_MAGIC;
+    header.version = METADB_VERSION;
+    header.block_size = METADB_BLOCK_SIZE;
+    header.entry_count = entry_count;
+    header.block_count = block_count;
+    header.crc_count = unique_crcs;
+    header.keys_size = keys_size;
+    header.strings_size = strings_size;
+
+    int ok = 0;
+    FILE *fp = fopen(path, "wb");
+    if (fp) {
+        ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+             fwrite(block_start, sizeof(uint32_t), block_count, fp) == block_count &&
+             fwrite(records, sizeof(MetaDbRecord), entry_count, fp) == (size_t)entry_count &&
+             fwrite(crcs, sizeof(MetaDbCrc), unique_crcs, fp) == unique_crcs &&
+             fwrite(keys, 1, keys_size, fp) == keys_size &&
+             fwrite(strings, 1, strings_size, fp) == strings_size;
+        fclose(fp);
+    }
+
+    if (ok) {
+        printf("%d keys (%u blocks, %u bytes of keys), %u CRCs, %u bytes of titles\n",
+               entry_count, (unsigned)block_count, (unsigned)keys_size, (unsigned)unique_crcs, (unsigned)strings_size);
+    } else {
+        fprintf(stderr, "Cannot write %s\n", path);
+    }
+
+    free(crcs);
+    free(block_start);
+    free(records);
+    free(keys);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: frogui_metadb <output.db> <input.dat>...\n");
+        return 1;
+    }
+
+    for (int i = 2; i < argc; i++) {
+        if (!parse_dat(argv[i])) return 1;
+    }
+    return write_db(argv[1]) ? 0 : 1;
+}
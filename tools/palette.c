@@ -0,0 +1,154 @@
+#include "palette.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    int first;
+    int count;      // Colours in colors[first..]
+} ColorBox;
+
+static int channel_of(uint16_t color, int channel) {
+    if (channel == 0) return (color >> 11) & 0x1F;
+    if (channel == 1) return (color >> 5) & 0x3F;
+    return color & 0x1F;
+}
+
+// Stable counting sort of colors by one channel (scratch holds count colours)
+static void sort_by_channel(uint16_t *colors, int count, int channel, uint16_t *scratch) {
+    int start[65];
+    memset(start, 0, sizeof(start));
+    for (int i = 0; i < count; i++) start[channel_of(colors[i], channel) + 1]++;
+    for (int v = 0; v < 64; v++) start[v + 1] += start[v];
+    for (int i = 0; i < count; i++) scratch[start[channel_of(colors[i], channel)]++] = colors[i];
+    memcpy(colors, scratch, count * sizeof(uint16_t));
+}
+
+// Widest channel of a box (scaled to 6 bits), its extent in *extent
+static int widest_channel(const uint16_t *colors, const ColorBox *box, int *extent) {
+    int best = 0;
+    *extent = -1;
+    for (int channel = 0; channel < 3; channel++) {
+        int lo = 255, hi = -1;
+        for (int i = 0; i < box->count; i++) {
+            int v = channel_of(colors[box->first + i], channel);
+            if (v < lo) lo = v;
+            if (v > hi) hi = v;
+        }
+        int range = (hi - lo) * (channel == 1 ? 1 : 2);
+        if (range > *extent) {
+            *extent = range;
+            best = channel;
+        }
+    }
+    return best;
+}
+
+int palette_median_cut(const uint32_t *histogram, int max_colors, uint16_t *palette, uint8_t *index_of) {
+    uint16_t *colors = (uint16_t*)malloc(65536 * sizeof(uint16_t));
+    uint16_t *scratch = (uint16_t*)malloc(65536 * sizeof(uint16_t));
+    if (!colors || !scratch) {
+        free(colors);
+        free(scratch);
+        return 0;
+    }
+    int color_count = 0;
+    for (int c = 0; c < 65536; c++) {
+        if (histogram[c]) colors[color_count++] = (uint16_t)c;
+    }
+    if (max_colors > 256) max_colors = 256;
+
+    ColorBox boxes[256];
+    int box_count = 1;
+    boxes[0].first = 0;
+    boxes[0].count = color_count;
+
+    while (box_count < max_colors) {
+        // Split the box with the widest channel at its median pixel
+        int split = -1, split_channel = 0, split_extent = 0;
+        for (int b = 0; b < box_count; b++) {
+            if (boxes[b].count < 2) continue;
+            int extent;
+            int channel = widest_channel(colors, &boxes[b], &extent);
+            if (extent > split_extent) {
+                split = b;
+                split_channel = channel;
+                split_extent = extent;
+            }
+        }
+        if (split < 0) break;
+
+        ColorBox *box = &boxes[split];
+        sort_by_channel(colors + box->first, box->count, split_channel, scratch);
+
+        uint64_t total = 0;
+        for (int i = 0; i < box->count; i++) total += histogram[colors[box->first + i]];
+        uint64_t running = 0;
+        int cut = 1;
+        for (int i = 0; i < box->count - 1; i++) {
+            running += histogram[colors[box->first + i]];
+            cut = i + 1;
+            if (running * 2 >= total) break;
+        }
+
+        boxes[box_count].first = box->first + cut;
+        boxes[box_count].count = box->count - cut;
+        box->count = cut;
+        box_count++;
+    }
+
+    // Palette: pixel-weighted mean of each box
+    for (int b = 0; b < box_count; b++) {
+        uint64_t sum[3] = {0, 0, 0}, weight = 0;
+        for (int i = 0; i < boxes[b].count; i++) {
+            uint16_t color = colors[boxes[b].first + i];
+            uint32_t n = histogram[color];
+            sum[0] += (uint64_t)((color >> 11) & 0x1F) * n;
+            sum[1] += (uint64_t)((color >> 5) & 0x3F) * n;
+            sum[2] += (uint64_t)(color & 0x1F) * n;
+            weight += n;
+            index_of[color] = (uint8_t)b;
+        }
+        palette[b] = 0;
+        if (weight) {
+            palette[b] = (uint16_t)((((sum[0] + weight / 2) / weight) << 11) |
+                                    (((sum[1] + weight / 2) / weight) << 5) |
+                                    ((sum[2] + weight / 2) / weight));
+        }
+    }
+
+    free(colors);
+    free(scratch);
+    return color_count ? box_count : 0;
+}
+
+uint32_t palette_encode_runs(const uint8_t *indices, int count, uint8_t *out) {
+    // Runs of 2..129 equal indices, literals of 1..128
+    uint8_t *p = out;
+    int i = 0;
+    int literal_start = -1;
+    while (i < count) {
+        int run = 1;
+        while (i + run < count && run < 129 && indices[i + run] == indices[i]) run++;
+
+        if (literal_start >= 0 && (run >= 2 || i - literal_start == 128)) {
+            *p++ = (uint8_t)(i - literal_start - 1);
+            memcpy(p, indices + literal_start, i - literal_start);
+            p += i - literal_start;
+            literal_start = -1;
+        }
+        if (run >= 2) {
+            *p++ = (uint8_t)(0x80 + run - 2);
+            *p++ = indices[i];
+            i += run;
+        } else {
+            if (literal_start < 0) literal_start = i;
+            i++;
+        }
+    }
+    if (literal_start >= 0) {
+        *p++ = (uint8_t)(i - literal_start - 1);
+        memcpy(p, indices + literal_start, i - literal_start);
+        p += i - literal_start;
+    }
+    return (uint32_t)(p - out);
+}
@@ -0,0 +1,20 @@
+#ifndef TOOLS_PALETTE_H
+#define TOOLS_PALETTE_H
+
+#include <stdint.h>
+
+// Palette helpers shared by the host image tools (thumbconv.c, sysicons.c)
+
+// Median cut over RGB565 colours: histogram[color] holds the pixel count of
+// each colour. Writes up to max_colors (at most 256) pixel-weighted box
+// means to palette and the palette index of every counted colour to
+// index_of[65536]. Colour counts of max_colors or fewer stay exact. Returns
+// the palette size.
+int palette_median_cut(const uint32_t *histogram, int max_colors, uint16_t *palette, uint8_t *index_of);
+
+// Run-length code count palette indices the way THUMBNAIL_FORMAT_PAL8_RLE
+// does (thumbcodec.h); out needs count + count / 128 + 1 bytes. Returns the
+// bytes written.
+uint32_t palette_encode_runs(const uint8_t *indices, int count, uint8_t *out);
+
+#endif // TOOLS_PALETTE_H
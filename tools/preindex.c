@@ -0,0 +1,282 @@
+// FrogUI pre-indexer: builds every FrogUI cache file for an SD card mounted
+// on a PC, so the first boot on the device finds them all current.
+//
+// It is built from the same sources as the menu (make tools), so the files
+// are written in exactly the on-device format:
+//   configs/frogui_library.cache   catalog and folder stats
+//   configs/frogui_search.idx      search index
+//   configs/frogui_dir_*.idx       every ROM folder and multi-ROM zip archive
+//   configs/frogui_tree_*.idx      every flattened system
+//
+// Usage: frogui_preindex [-j threads] <card root>
+//
+// Folders are indexed in parallel, one job per folder. Indexes are named and
+// stamped with the paths the device sees (/mnt/sda1/...), and the device
+// checks them against folder mtimes, so mount the card without a timezone
+// shift on file times (on Linux, vfat's tz=UTC option).
+#include "dirindex.h"
+#include "hash.h"
+#include "library.h"
+#include "search.h"
+#include "systems.h"
+#include "zip.h"
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEVICE_ROOT "/mnt/sda1"
+#define FLATTEN_FILE "/mnt/sda1/configs/frogui_flatten.txt"
+#define MAX_THREADS 64
+
+#define JOB_CATALOG 0   // Library catalog, then the search index built from it
+#define JOB_TREES 1     // Tree indexes (they share the open index state, so one job)
+#define JOB_FOLDER 2
+#define JOB_ARCHIVE 3
+
+typedef struct {
+    int type;
+    char path[512];     // On the card
+    char system[256];   // System folder the path belongs to
+} Job;
+
+static char card_root[512];
+static Job *jobs = NULL;
+static int job_count = 0;
+static int job_capacity = 0;
+
+static pthread_mutex_t job_lock = PTHREAD_MUTEX_INITIALIZER;
+static int next_job = 0;
+static int written_count = 0;
+static int failed_count = 0;
+
+// Path on the card for a device path ("/mnt/sda1/ROMS" -> "<card>/ROMS")
+static void card_path(const char *device_path, char *path, size_t path_size) {
+    snprintf(path, path_size, "%s%s", card_root, device_path + strlen(DEVICE_ROOT));
+}
+
+// Device path for a path on the card
+static void device_path(const char *path, char *device, size_t device_size) {
+    snprintf(device, device_size, DEVICE_ROOT "%s", path + strlen(card_root));
+}
+
+// Card path of the index file the device uses for a folder
+static void index_file_path(const char *pattern, const char *device_dir, char *path, size_t path_size) {
+    char device_index[512];
+    snprintf(device_index, sizeof(device_index), pattern, (unsigned)hash_string(device_dir));
+    card_path(device_index, path, path_size);
+}
+
+static void add_job(int type, const char *path, const char *system) {
+    if (job_count >= job_capacity) {
+        int new_capacity = job_capacity ? job_capacity * 2 : 256;
+        Job *new_jobs = (Job*)realloc(jobs, new_capacity * sizeof(Job));
+        if (!new_jobs) return;
+        jobs = new_jobs;
+        job_capacity = new_capacity;
+    }
+
+    Job *job = &jobs[job_count++];
+    job->type = type;
+    snprintf(job->path, sizeof(job->path), "%s", path);
+    snprintf(job->system, sizeof(job->system), "%s", system);
+}
+
+// Skipped the same way the menu skips them
+static int is_hidden_name(const char *name) {
+    return name[0] == '.' || strcasecmp(name, "frogui") == 0 ||
+           strcasecmp(name, "saves") == 0 || strcasecmp(name, "save") == 0;
+}
+
+// Queue a folder, its subfolders and its zip archives
+static void queue_folder(const char *path, const char *system) {
+    add_job(JOB_FOLDER, path, system);
+
+    DIR *dir = opendir(path);
+    if (!dir) return;
+
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (is_hidden_name(ent->d_name)) continue;
+
+        char child[512];
+        snprintf(child, sizeof(child), "%s/%s", path, ent->d_name);
+        struct stat st;
+        if (stat(child, &st) != 0) continue;
+
+        if (S_ISDIR(st.st_mode)) {
+            queue_folder(child, system);
+        } else if (zip_is_archive_name(ent->d_name)) {
+            add_job(JOB_ARCHIVE, child, system);
+        }
+    }
+    closedir(dir);
+}
+
+static int run_catalog_job(void) {
+    char roms_path[512];
+    char cache_path[512];
+    char search_path[512];
+    card_path(DEVICE_ROOT "/ROMS", roms_path, sizeof(roms_path));
+    card_path(LIBRARY_CACHE_FILE, cache_path, sizeof(cache_path));
+    card_path(SEARCH_INDEX_FILE, search_path, sizeof(search_path));
+
+    library_init(roms_path, cache_path);
+    library_load();
+    library_refresh(NULL);
+    search_init(search_path);
+    return library_get_system_count() > 0 && search_open();
+}
+
+static int run_trees_job(void) {
+    char flatten_path[512];
+    card_path(FLATTEN_FILE, flatten_path, sizeof(flatten_path));
+    FILE *fp = fopen(flatten_path, "r");
+    if (!fp) return 1;  // No flattened systems
+
+    int ok = 1;
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (!line[0]) continue;
+
+        char device_dir[512];
+        char path[512];
+        char index_path[512];
+        snprintf(device_dir, sizeof(device_dir), DEVICE_ROOT "/ROMS/%s", line);
+        card_path(device_dir, path, sizeof(path));
+        index_file_path(DIRINDEX_TREE_PATTERN, device_dir, index_path, sizeof(index_path));
+
+        ExtensionFilter filter;
+        systems_get_extension_filter(line, &filter);
+        ok &= dirindex_write_tree(path, device_dir, &filter, index_path);
+    }
+    fclose(fp);
+    return ok;
+}
+
+// 1 if written, 0 if failed, -1 if the job needs no file
+static int run_job(const Job *job) {
+    if (job->type == JOB_CATALOG) return run_catalog_job();
+    if (job->type == JOB_TREES) return run_trees_job();
+
+    ExtensionFilter filter;
+    systems_get_extension_filter(job->system, &filter);
+
+    // Only multi-ROM zips in systems whose core cannot load them are browsed
+    if (job->type == JOB_ARCHIVE &&
+        (systems_loads_archives(job->system) || dirindex_archive_count(job->path, &filter) <= 1)) {
+        return -1;
+    }
+
+    char device_dir[512];
+    char index_path[512];
+    device_path(job->path, device_dir, sizeof(device_dir));
+    index_file_path(DIRINDEX_CACHE_PATTERN, device_dir, index_path, sizeof(index_path));
+    return dirindex_write(job->path, device_dir, &filter, index_path);
+}
+
+static void *worker(void *arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&job_lock);
+        if (next_job >= job_count) {
+            pthread_mutex_unlock(&job_lock);
+            return NULL;
+        }
+        const Job *job = &jobs[next_job++];
+        pthread_mutex_unlock(&job_lock);
+
+        int result = run_job(job);
+
+        pthread_mutex_lock(&job_lock);
+        if (result > 0) written_count++;
+        else if (result == 0) failed_count++;
+        pthread_mutex_unlock(&job_lock);
+    }
+}
+
+static void usage(void) {
+    fprintf(stderr, "Usage: frogui_preindex [-j threads] <card root>\n");
+}
+
+int main(int argc, char **argv) {
+    int thread_count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char *root = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            thread_count = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && !root) {
+            root = argv[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (!root) {
+        usage();
+        return 1;
+    }
+    if (thread_count < 1) thread_count = 1;
+    if (thread_count > MAX_THREADS) thread_count = MAX_THREADS;
+
+    snprintf(card_root, sizeof(card_root), "%s", root);
+    size_t root_len = strlen(card_root);
+    while (root_len > 1 && card_root[root_len - 1] == '/') {
+        card_root[--root_len] = '\0';
+    }
+
+    char roms_path[512];
+    char configs_path[512];
+    card_path(DEVICE_ROOT "/ROMS", roms_path, sizeof(roms_path));
+    card_path(DEVICE_ROOT "/configs", configs_path, sizeof(configs_path));
+    mkdir(configs_path, 0755);
+
+    DIR *dir = opendir(roms_path);
+    if (!dir) {
+        fprintf(stderr, "No ROMS folder in %s\n", card_root);
+        return 1;
+    }
+
+    // The two long single jobs go first so they overlap the folder jobs
+    add_job(JOB_CATALOG, roms_path, "");
+    add_job(JOB_TREES, roms_path, "");
+
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (is_hidden_name(ent->d_name)) continue;
+
+        char path[512];
+        if (snprintf(path, sizeof(path), "%s/%s", roms_path, ent->d_name) >= (int)sizeof(path)) continue;
+        struct stat st;
+        if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+            queue_folder(path, ent->d_name);
+        }
+    }
+    closedir(dir);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pthread_t threads[MAX_THREADS];
+    for (int i = 0; i < thread_count; i++) {
+        pthread_create(&threads[i], NULL, worker, NULL);
+    }
+    for (int i = 0; i < thread_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    printf("%d jobs, %d indexes written, %d failed, %d threads, %.0f ms\n",
+           job_count, written_count, failed_count, thread_count, elapsed_ms);
+
+    free(jobs);
+    return failed_count ? 1 : 0;
+}
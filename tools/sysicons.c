@@ -0,0 +1,234 @@
+// FrogUI system icon atlas builder: packs one small image per system into the
+// atlas the root list draws its icons from (layout in sysicons.h).
+//
+// Usage: frogui_sysicons [-s size] <atlas> <icons directory>
+//
+// Every .png / .jpg / .jpeg / .bmp in the directory becomes the icon of the
+// folder named like the file (gba.png -> gba; RECENT_GAMES.png and the other
+// special row names work too). Images are scaled to fit size x size (default
+// 16, at most SYSICONS_MAX_SIZE) by area averaging and centred; pixels less
+// than half opaque are transparent. All icons share one palette of up to 255
+// colours from a median cut.
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#define STBI_ONLY_BMP
+#include "stb_image.h"
+
+#include "hash.h"
+#include "palette.h"
+#include "sysicons.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define MAX_ICONS 1024
+
+typedef struct {
+    char name[256];             // Folder name
+    uint32_t folder_hash;
+    uint16_t pixels[SYSICONS_MAX_SIZE * SYSICONS_MAX_SIZE];
+    uint8_t opaque[SYSICONS_MAX_SIZE * SYSICONS_MAX_SIZE];
+    uint8_t runs[SYSICONS_MAX_SIZE * SYSICONS_MAX_SIZE * 2];
+    uint32_t size;
+} Icon;
+
+static Icon icons[MAX_ICONS];
+static int icon_count = 0;
+
+static int is_image_name(const char *name) {
+    const char *ext = strrchr(name, '.');
+    return ext && (strcasecmp(ext, ".png") == 0 || strcasecmp(ext, ".jpg") == 0 ||
+                   strcasecmp(ext, ".jpeg") == 0 || strcasecmp(ext, ".bmp") == 0);
+}
+
+// Scale an RGBA image into the icon's size x size cell, centred
+static void scale_icon(Icon *icon, const uint8_t *rgba, int width, int height, int size) {
+    int icon_width = size, icon_height = size;
+    if (width > height) {
+        icon_height = (height * size + width / 2) / width;
+    } else {
+        icon_width = (width * size + height / 2) / height;
+    }
+    if (icon_width < 1) icon_width = 1;
+    if (icon_height < 1) icon_height = 1;
+    int left = (size - icon_width) / 2;
+    int top = (size - icon_height) / 2;
+
+    memset(icon->opaque, 0, sizeof(icon->opaque));
+    for (int y = 0; y < icon_height; y++) {
+        int y0 = y * height / icon_height;
+        int y1 = (y + 1) * height / icon_height;
+        if (y1 <= y0) y1 = y0 + 1;
+
+        for (int x = 0; x < icon_width; x++) {
+            int x0 = x * width / icon_width;
+            int x1 = (x + 1) * width / icon_width;
+            if (x1 <= x0) x1 = x0 + 1;
+
+            // Alpha-weighted average of the pixels under this one
+            uint64_t r = 0, g = 0, b = 0, alpha = 0;
+            for (int sy = y0; sy < y1; sy++) {
+                for (int sx = x0; sx < x1; sx++) {
+                    const uint8_t *p = rgba + ((size_t)sy * width + sx) * 4;
+                    r += p[0] * p[3];
+                    g += p[1] * p[3];
+                    b += p[2] * p[3];
+                    alpha += p[3];
+                }
+            }
+            int count = (y1 - y0) * (x1 - x0);
+            if (alpha * 2 < (uint64_t)count * 255) continue;
+
+            int cell = (top + y) * size + left + x;
+            icon->opaque[cell] = 1;
+            icon->pixels[cell] = (uint16_t)((((r / alpha) >> 3) << 11) | (((g / alpha) >> 2) << 5) | ((b / alpha) >> 3));
+        }
+    }
+}
+
+static int compare_icons(const void *a, const void *b) {
+    uint32_t ha = ((const Icon*)a)->folder_hash;
+    uint32_t hb = ((const Icon*)b)->folder_hash;
+    return (ha > hb) - (ha < hb);
+}
+
+static int write_atlas(const char *path, int size, const uint16_t *palette, int palette_count) {
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return 0;
+    }
+
+    SystemIconsHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SYSICONS_MAGIC;
+    header.version = SYSICONS_VERSION;
+    header.icon_count = (uint16_t)icon_count;
+    header.icon_width = (uint16_t)size;
+    header.icon_height = (uint16_t)size;
+    header.palette_count = (uint16_t)palette_count;
+
+    uint16_t padded[SYSICONS_PALETTE_SLOTS(256)];
+    memset(padded, 0, sizeof(padded));
+    memcpy(padded, palette, palette_count * sizeof(uint16_t));
+
+    int ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    ok &= fwrite(padded, sizeof(uint16_t), SYSICONS_PALETTE_SLOTS(palette_count), fp) ==
+          (size_t)SYSICONS_PALETTE_SLOTS(palette_count);
+
+    uint32_t offset = 0;
+    for (int i = 0; i < icon_count; i++) {
+        SystemIconEntry entry;
+        entry.folder_hash = icons[i].folder_hash;
+        entry.offset = offset;
+        entry.size = icons[i].size;
+        ok &= fwrite(&entry, sizeof(entry), 1, fp) == 1;
+        offset += icons[i].size;
+    }
+    for (int i = 0; i < icon_count; i++) {
+        ok &= fwrite(icons[i].runs, 1, icons[i].size, fp) == icons[i].size;
+    }
+
+    long file_size = ftell(fp);
+    if (fclose(fp) != 0) ok = 0;
+    if (!ok) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return 0;
+    }
+    if (file_size > SYSICONS_MAX_FILE_SIZE) {
+        fprintf(stderr, "%s: %ld bytes, more than FrogUI reads (%d)\n", path, file_size, SYSICONS_MAX_FILE_SIZE);
+        return 0;
+    }
+    printf("%d icons, %dx%d, %d colours, %ld bytes\n", icon_count, size, size, palette_count, file_size);
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    int size = 16;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "-s") == 0) {
+        size = atoi(argv[2]);
+        first = 3;
+    }
+    if (argc - first != 2 || size < 1 || size > SYSICONS_MAX_SIZE) {
+        fprintf(stderr, "Usage: frogui_sysicons [-s size] <atlas> <icons directory>\n");
+        return 1;
+    }
+    const char *atlas_path = argv[first];
+    const char *icons_dir = argv[first + 1];
+
+    DIR *dir = opendir(icons_dir);
+    if (!dir) {
+        fprintf(stderr, "Cannot open %s\n", icons_dir);
+        return 1;
+    }
+
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (!is_image_name(ent->d_name)) continue;
+        if (icon_count >= MAX_ICONS || strlen(ent->d_name) >= sizeof(icons[0].name)) {
+            fprintf(stderr, "Skipping %s\n", ent->d_name);
+            continue;
+        }
+
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", icons_dir, ent->d_name);
+        int width, height, channels;
+        uint8_t *rgba = stbi_load(path, &width, &height, &channels, 4);
+        if (!rgba) {
+            fprintf(stderr, "Cannot read %s\n", path);
+            continue;
+        }
+
+        Icon *icon = &icons[icon_count++];
+        strcpy(icon->name, ent->d_name);
+        *strrchr(icon->name, '.') = '\0';
+        icon->folder_hash = hash_string_nocase(icon->name);
+        scale_icon(icon, rgba, width, height, size);
+        stbi_image_free(rgba);
+    }
+    closedir(dir);
+
+    if (icon_count == 0) {
+        fprintf(stderr, "No icons in %s\n", icons_dir);
+        return 1;
+    }
+
+    // Looked up by hash: two names with one hash cannot both be found
+    qsort(icons, icon_count, sizeof(Icon), compare_icons);
+    for (int i = 1; i < icon_count; i++) {
+        if (icons[i].folder_hash == icons[i - 1].folder_hash) {
+            fprintf(stderr, "%s and %s share a hash (same folder twice?)\n", icons[i - 1].name, icons[i].name);
+            return 1;
+        }
+    }
+
+    // One palette for every icon, index 0 left for transparency
+    uint32_t *histogram = (uint32_t*)calloc(65536, sizeof(uint32_t));
+    uint8_t *index_of = (uint8_t*)malloc(65536);
+    if (!histogram || !index_of) return 1;
+    int pixels = size * size;
+    for (int i = 0; i < icon_count; i++) {
+        for (int p = 0; p < pixels; p++) {
+            if (icons[i].opaque[p]) histogram[icons[i].pixels[p]]++;
+        }
+    }
+    uint16_t palette[256];
+    palette[0] = 0;
+    int palette_count = 1 + palette_median_cut(histogram, 255, palette + 1, index_of);
+
+    for (int i = 0; i < icon_count; i++) {
+        uint8_t indices[SYSICONS_MAX_SIZE * SYSICONS_MAX_SIZE];
+        for (int p = 0; p < pixels; p++) {
+            indices[p] = icons[i].opaque[p] ? (uint8_t)(index_of[icons[i].pixels[p]] + 1) : 0;
+        }
+        icons[i].size = palette_encode_runs(indices, pixels, icons[i].runs);
+    }
+    free(histogram);
+    free(index_of);
+
+    return write_atlas(atlas_path, size, palette, palette_count) ? 0 : 1;
+}
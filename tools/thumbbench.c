@@ -0,0 +1,143 @@
+// FrogUI thumbnail benchmark: measures what loading every thumbnail of a pack
+// costs against the same thumbnails stored raw.
+//
+// Usage: frogui_thumbbench <thumbs.pack>...
+//
+// Run it on the pack on the SD card itself (card in a reader). Each thumbnail
+// is read with its own seek and read, in index slot order (scattered through
+// the file, as browsing an alphabetical list reads them), after
+// the pack's pages are dropped from the page cache, so the read time is the
+// card's. Raw loads are the raw bytes at the read rate measured for the pack.
+//
+// The decode time is measured on this machine's CPU, not the device's: it
+// only compares the formats with each other. The device is many times slower;
+// for its own figures build the menu with THUMBNAIL_TIMING=1 (see render.c).
+#include "render.h"
+#include "thumbcodec.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DECODE_PASSES 5
+
+static uint16_t pixels[THUMBNAIL_MAX_PIXELS];
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static int bench_pack(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 0;
+    }
+    fseek(fp, 0, SEEK_END);
+    long file_size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    // Nothing of the pack may come from memory (pages still to be written
+    // back would stay cached, so those are written first)
+    fsync(fileno(fp));
+    int dropped = posix_fadvise(fileno(fp), 0, 0, POSIX_FADV_DONTNEED) == 0;
+
+    // The index is read once when a folder is opened, as on the device
+    ThumbnailPackHeader header;
+    uint8_t *data = file_size > 0 ? (uint8_t*)malloc(file_size) : NULL;
+    if (!data || fread(&header, sizeof(header), 1, fp) != 1 ||
+        header.magic != THUMBNAIL_PACK_MAGIC || header.version != THUMBNAIL_PACK_VERSION ||
+        sizeof(header) + (size_t)header.slot_count * sizeof(ThumbnailPackEntry) > (size_t)file_size ||
+        fread(data + sizeof(header), sizeof(ThumbnailPackEntry), header.slot_count, fp) != header.slot_count) {
+        fprintf(stderr, "%s: not a version %d thumbnail pack\n", path, THUMBNAIL_PACK_VERSION);
+        free(data);
+        fclose(fp);
+        return 0;
+    }
+    const ThumbnailPackEntry *slots = (const ThumbnailPackEntry*)(data + sizeof(header));
+
+    uint32_t count = 0;
+    uint32_t compressed = 0;
+    uint64_t packed_bytes = 0;
+    uint64_t raw_bytes = 0;
+    double read_ms = 0;
+
+    for (uint32_t i = 0; i < header.slot_count; i++) {
+        const ThumbnailPackEntry *entry = &slots[i];
+        if (entry->size == 0) continue;
+
+        int entry_pixels = entry->width * entry->height;
+        if (entry_pixels > THUMBNAIL_MAX_PIXELS || entry->offset > (uint32_t)file_size ||
+            entry->size > (uint32_t)file_size - entry->offset) {
+            fprintf(stderr, "%s: bad entry in slot %u\n", path, (unsigned)i);
+            free(data);
+            fclose(fp);
+            return 0;
+        }
+
+        double start = now_ms();
+        int ok = fseek(fp, entry->offset, SEEK_SET) == 0 &&
+                 fread(data + entry->offset, 1, entry->size, fp) == entry->size;
+        read_ms += now_ms() - start;
+        if (!ok) {
+            fprintf(stderr, "%s: cannot read slot %u\n", path, (unsigned)i);
+            free(data);
+            fclose(fp);
+            return 0;
+        }
+
+        count++;
+        if (entry->format != THUMBNAIL_FORMAT_RGB565) compressed++;
+        packed_bytes += entry->size;
+        raw_bytes += (uint64_t)entry_pixels * 2;
+    }
+    fclose(fp);
+
+    // Decoded from memory, so only the CPU is timed
+    double best_decode = 0;
+    for (int pass = 0; pass < DECODE_PASSES; pass++) {
+        double start = now_ms();
+        for (uint32_t i = 0; i < header.slot_count; i++) {
+            const ThumbnailPackEntry *entry = &slots[i];
+            if (entry->size == 0) continue;
+            if (!thumbcodec_decode(entry->format, data + entry->offset, entry->size,
+                                   pixels, entry->width * entry->height)) {
+                fprintf(stderr, "%s: bad entry in slot %u\n", path, (unsigned)i);
+                free(data);
+                return 0;
+            }
+        }
+        double elapsed = now_ms() - start;
+        if (pass == 0 || elapsed < best_decode) best_decode = elapsed;
+    }
+    free(data);
+
+    double rate_kb = read_ms > 0 ? packed_bytes / read_ms : 0;
+    double raw_ms = rate_kb > 0 ? raw_bytes / rate_kb : 0;
+    printf("%s: %u thumbnails (%u compressed)\n", path, (unsigned)count, (unsigned)compressed);
+    printf("  bytes read   %10llu  raw %10llu  (%.1f%%)\n",
+           (unsigned long long)packed_bytes, (unsigned long long)raw_bytes,
+           raw_bytes ? 100.0 * packed_bytes / raw_bytes : 0.0);
+    printf("  read time    %10.1f ms  raw %10.1f ms  at the measured %.0f KB/s%s\n",
+           read_ms, raw_ms, rate_kb, dropped ? "" : " (page cache not dropped - may be too fast)");
+    printf("  host decode  %10.2f ms total, %.3f ms per thumbnail (this CPU, not the device)\n",
+           best_decode, count ? best_decode / count : 0.0);
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: frogui_thumbbench <thumbs.pack>...\n");
+        return 1;
+    }
+
+    int ok = 1;
+    for (int i = 1; i < argc; i++) {
+        if (!bench_pack(argv[i])) ok = 0;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,586 @@
+// FrogUI thumbnail converter: turns the PNG / JPEG art in every .res folder
+// under a ROMs directory into FrogUI thumbnails, one image per job across all
+// CPU cores. scripts/convert_to_rgb565.py and the convert_thumbnails_simple
+// scripts only call it.
+//
+// Usage: frogui_thumbconv [-j threads] [--pack] [--raw] [--prescale] [--dither] <roms directory>
+//
+//   .res/<name>.png -> .res/<name>.rgb565   ThumbnailHeader + pixels (render.h)
+//   --pack       one .res/thumbs.pack per folder instead, with previews
+//   --raw        raw RGB565 instead of a 256 colour palette + run-length
+//   --prescale   fit the 160x200 thumbnail area and flag it (drawn 1:1)
+//   --dither     Floyd-Steinberg dither down to RGB565 (raw output)
+//
+// Images are resized with a Lanczos-3 filter: wide art to fit 250x200, the
+// rest 200x200. Palettes come from a median cut over the image's RGB565
+// colours, so art with up to 256 colours stays exact.
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#define STBI_ONLY_BMP
+#include "stb_image.h"
+
+#include "hash.h"
+#include "palette.h"
+#include "render.h"
+#include "thumbcodec.h"
+#include <dirent.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_THREADS 64
+#define WIDE_MAX_WIDTH 250
+#define WIDE_MAX_HEIGHT 200
+#define SQUARE_MAX 200
+#define LANCZOS_SUPPORT 3.0
+
+typedef struct {
+    char path[512];         // Source image
+    char res_dir[512];      // Folder it is in
+    char name[256];         // Output file name (<name>.rgb565)
+
+    // Result, kept for the pack writer
+    int ok;
+    uint8_t *data;
+    uint32_t size;
+    int width;
+    int height;
+    int format;
+    int flags;
+    ThumbnailPreview preview;
+} Job;
+
+static Job *jobs = NULL;
+static int job_count = 0;
+static int job_capacity = 0;
+
+static pthread_mutex_t job_lock = PTHREAD_MUTEX_INITIALIZER;
+static int next_job = 0;
+
+static int option_pack = 0;
+static int option_raw = 0;
+static int option_prescale = 0;
+static int option_dither = 0;
+
+static int is_image_name(const char *name) {
+    const char *ext = strrchr(name, '.');
+    return ext && (strcasecmp(ext, ".png") == 0 || strcasecmp(ext, ".jpg") == 0 ||
+                   strcasecmp(ext, ".jpeg") == 0 || strcasecmp(ext, ".bmp") == 0);
+}
+
+static void add_job(const char *res_dir, const char *file_name) {
+    if (job_count >= job_capacity) {
+        int new_capacity = job_capacity ? job_capacity * 2 : 256;
+        Job *new_jobs = (Job*)realloc(jobs, new_capacity * sizeof(Job));
+        if (!new_jobs) return;
+        jobs = new_jobs;
+        job_capacity = new_capacity;
+    }
+
+    Job *job = &jobs[job_count++];
+    memset(job, 0, sizeof(*job));
+    snprintf(job->path, sizeof(job->path), "%s/%s", res_dir, file_name);
+    snprintf(job->res_dir, sizeof(job->res_dir), "%s", res_dir);
+
+    // Last extension replaced, like Path.with_suffix
+    snprintf(job->name, sizeof(job->name), "%s", file_name);
+    char *dot = strrchr(job->name, '.');
+    if (dot) *dot = '\0';
+    strncat(job->name, ".rgb565", sizeof(job->name) - strlen(job->name) - 1);
+}
+
+// Queue the images of every .res folder under path
+static void queue_folder(const char *path, int in_res) {
+    DIR *dir = opendir(path);
+    if (!dir) return;
+
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) continue;
+
+        char child[512];
+        snprintf(child, sizeof(child), "%s/%s", path, ent->d_name);
+        struct stat st;
+        if (stat(child, &st) != 0) continue;
+
+        if (S_ISDIR(st.st_mode)) {
+            queue_folder(child, in_res || strcmp(ent->d_name, ".res") == 0);
+        } else if (in_res && is_image_name(ent->d_name)) {
+            add_job(path, ent->d_name);
+        }
+    }
+    closedir(dir);
+}
+
+// Size that fits max_width x max_height keeping the aspect ratio; never enlarges
+static void fit_size(int width, int height, int max_width, int max_height, int *out_width, int *out_height) {
+    *out_width = width;
+    *out_height = height;
+    if (width <= max_width && height <= max_height) return;
+
+    double scale = fmin((double)max_width / width, (double)max_height / height);
+    *out_width = (int)(width * scale + 0.5);
+    *out_height = (int)(height * scale + 0.5);
+    if (*out_width < 1) *out_width = 1;
+    if (*out_height < 1) *out_height = 1;
+    if (*out_width > max_width) *out_width = max_width;
+    if (*out_height > max_height) *out_height = max_height;
+}
+
+static double lanczos(double x) {
+    if (x == 0.0) return 1.0;
+    if (x <= -LANCZOS_SUPPORT || x >= LANCZOS_SUPPORT) return 0.0;
+    double px = M_PI * x;
+    return LANCZOS_SUPPORT * sin(px) * sin(px / LANCZOS_SUPPORT) / (px * px);
+}
+
+// Resample one axis: out[i] = sum of in[first + k] * weight[k], for each of
+// count lines spaced line_stride apart (elements step apart within a line)
+static void resample_axis(const float *in, int in_len, float *out, int out_len,
+                          int count, int in_line_stride, int out_line_stride, int step) {
+    double scale = (double)in_len / out_len;
+    double filter_scale = scale > 1.0 ? scale : 1.0;
+    double support = LANCZOS_SUPPORT * filter_scale;
+    int max_taps = (int)ceil(support) * 2 + 1;
+    double *weights = (double*)malloc(max_taps * sizeof(double));
+
+    for (int i = 0; i < out_len; i++) {
+        double center = (i + 0.5) * scale;
+        int first = (int)floor(center - support);
+        int last = (int)ceil(center + support);
+        if (first < 0) first = 0;
+        if (last > in_len) last = in_len;
+
+        double total = 0;
+        int taps = 0;
+        for (int j = first; j < last && taps < max_taps; j++, taps++) {
+            weights[taps] = lanczos((j + 0.5 - center) / filter_scale);
+            total += weights[taps];
+        }
+        if (total == 0) total = 1;
+
+        for (int line = 0; line < count; line++) {
+            for (int c = 0; c < 3; c++) {
+                const float *src = in + (size_t)line * in_line_stride + c;
+                double sum = 0;
+                for (int k = 0; k < taps; k++) {
+                    sum += src[(size_t)(first + k) * step] * weights[k];
+                }
+                out[(size_t)line * out_line_stride + (size_t)i * step + c] = (float)(sum / total);
+            }
+        }
+    }
+    free(weights);
+}
+
+// Resize an RGB float image (Lanczos-3, horizontal then vertical)
+static float *resize_rgb(const float *src, int src_width, int src_height, int width, int height) {
+    float *horizontal = (float*)malloc((size_t)width * src_height * 3 * sizeof(float));
+    float *result = (float*)malloc((size_t)width * height * 3 * sizeof(float));
+    if (!horizontal || !result) {
+        free(horizontal);
+        free(result);
+        return NULL;
+    }
+
+    // Rows: src_height lines of src_width pixels
+    resample_axis(src, src_width, horizontal, width, src_height, src_width * 3, width * 3, 3);
+    // Columns: width lines of src_height pixels, one row apart
+    resample_axis(horizontal, src_height, result, height, width, 3, 3, width * 3);
+    free(horizontal);
+    return result;
+}
+
+static int clamp_channel(float value) {
+    int v = (int)(value + 0.5f);
+    return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+static uint16_t to_rgb565(int r, int g, int b) {
+    return (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+// RGB565 pixels of a float image, Floyd-Steinberg dithered if asked
+static void to_rgb565_pixels(float *rgb, int width, int height, int dither, uint16_t *out) {
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            float *p = rgb + ((size_t)y * width + x) * 3;
+            int r = clamp_channel(p[0]);
+            int g = clamp_channel(p[1]);
+            int b = clamp_channel(p[2]);
+            uint16_t pixel = to_rgb565(r, g, b);
+            out[y * width + x] = pixel;
+            if (!dither) continue;
+
+            // Spread what the 5/6/5 bit channels lost over the neighbours
+            int back[3] = {((pixel >> 11) & 0x1F) * 255 / 31, ((pixel >> 5) & 0x3F) * 255 / 63, (pixel & 0x1F) * 255 / 31};
+            int value[3] = {r, g, b};
+            for (int c = 0; c < 3; c++) {
+                float error = (float)(value[c] - back[c]);
+                if (x + 1 < width) p[3 + c] += error * 7 / 16;
+                if (y + 1 < height) {
+                    float *below = p + (size_t)width * 3;
+                    if (x > 0) below[-3 + c] += error * 3 / 16;
+                    below[c] += error * 5 / 16;
+                    if (x + 1 < width) below[3 + c] += error * 1 / 16;
+                }
+            }
+        }
+    }
+}
+
+// THUMBNAIL_FORMAT_PAL8_RLE stream of pixels into out (THUMBCODEC_PAL8_MAX_SIZE)
+static uint32_t encode_pal8_rle(const uint16_t *pixels, int pixel_count, uint8_t *out) {
+    uint32_t *histogram = (uint32_t*)calloc(65536, sizeof(uint32_t));
+    uint8_t *index_of = (uint8_t*)malloc(65536);
+    uint8_t *indices = (uint8_t*)malloc(pixel_count);
+    uint32_t size = 0;
+    if (histogram && index_of && indices) {
+        for (int i = 0; i < pixel_count; i++) histogram[pixels[i]]++;
+
+        uint16_t palette[256];
+        int palette_count = palette_median_cut(histogram, 256, palette, index_of);
+        uint8_t *p = out;
+        *p++ = palette_count & 0xFF;
+        *p++ = palette_count >> 8;
+        for (int i = 0; i < palette_count; i++) {
+            *p++ = palette[i] & 0xFF;
+            *p++ = palette[i] >> 8;
+        }
+
+        for (int i = 0; i < pixel_count; i++) indices[i] = index_of[pixels[i]];
+        p += palette_encode_runs(indices, pixel_count, p);
+        size = (uint32_t)(p - out);
+    }
+
+    free(histogram);
+    free(index_of);
+    free(indices);
+    return size;
+}
+
+static int convert_job(Job *job) {
+    int src_width, src_height, channels;
+    uint8_t *image = stbi_load(job->path, &src_width, &src_height, &channels, 3);
+    if (!image) return 0;
+
+    size_t src_pixels = (size_t)src_width * src_height;
+    float *src = (float*)malloc(src_pixels * 3 * sizeof(float));
+    if (!src) {
+        stbi_image_free(image);
+        return 0;
+    }
+    for (size_t i = 0; i < src_pixels * 3; i++) src[i] = image[i];
+    stbi_image_free(image);
+
+    int max_width = SQUARE_MAX, max_height = SQUARE_MAX;
+    if (option_prescale) {
+        max_width = THUMBNAIL_MAX_WIDTH;
+        max_height = THUMBNAIL_MAX_HEIGHT;
+        job->flags = THUMBNAIL_FLAG_PRESCALED;
+    } else if (src_width > src_height) {
+        max_width = WIDE_MAX_WIDTH;
+        max_height = WIDE_MAX_HEIGHT;
+    }
+    fit_size(src_width, src_height, max_width, max_height, &job->width, &job->height);
+
+    float *rgb = src;
+    if (job->width != src_width || job->height != src_height) {
+        rgb = resize_rgb(src, src_width, src_height, job->width, job->height);
+        free(src);
+        if (!rgb) return 0;
+    }
+
+    // Preview from the resized image
+    int preview_width, preview_height;
+    fit_size(job->width, job->height, THUMBNAIL_PREVIEW_MAX_WIDTH, THUMBNAIL_PREVIEW_MAX_HEIGHT,
+             &preview_width, &preview_height);
+    float *preview = resize_rgb(rgb, job->width, job->height, preview_width, preview_height);
+    if (preview) {
+        job->preview.width = (uint8_t)preview_width;
+        job->preview.height = (uint8_t)preview_height;
+        to_rgb565_pixels(preview, preview_width, preview_height, 0, job->preview.pixels);
+        free(preview);
+    }
+
+    int pixel_count = job->width * job->height;
+    uint16_t *pixels = (uint16_t*)malloc(pixel_count * sizeof(uint16_t));
+    uint8_t *data = (uint8_t*)malloc(THUMBCODEC_PAL8_MAX_SIZE(pixel_count) > (size_t)pixel_count * 2 ?
+                                     THUMBCODEC_PAL8_MAX_SIZE(pixel_count) : (size_t)pixel_count * 2);
+    if (!pixels || !data) {
+        free(rgb);
+        free(pixels);
+        free(data);
+        return 0;
+    }
+    to_rgb565_pixels(rgb, job->width, job->height, option_dither, pixels);
+    free(rgb);
+
+    // Palette + run-length when that is smaller, raw otherwise
+    job->format = THUMBNAIL_FORMAT_RGB565;
+    job->size = pixel_count * 2;
+    if (!option_raw) {
+        uint32_t size = encode_pal8_rle(pixels, pixel_count, data);
+        if (size > 0 && size < job->size) {
+            job->format = THUMBNAIL_FORMAT_PAL8_RLE;
+            job->size = size;
+        }
+    }
+    if (job->format == THUMBNAIL_FORMAT_RGB565) {
+        memcpy(data, pixels, job->size);
+    }
+    free(pixels);
+    job->data = data;
+    return 1;
+}
+
+static int write_thumbnail_file(const char *path, const Job *job) {
+    FILE *fp = fopen(path, "wb");
+    if (!fp) return 0;
+
+    ThumbnailHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = THUMBNAIL_FILE_MAGIC;
+    header.version = THUMBNAIL_FILE_VERSION;
+    header.format = (uint8_t)job->format;
+    header.flags = (uint16_t)job->flags;
+    header.width = (uint16_t)job->width;
+    header.height = (uint16_t)job->height;
+    header.data_size = job->size;
+
+    int ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+             fwrite(job->data, 1, job->size, fp) == job->size;
+    if (fclose(fp) != 0) ok = 0;
+    return ok;
+}
+
+static void *worker(void *arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&job_lock);
+        if (next_job >= job_count) {
+            pthread_mutex_unlock(&job_lock);
+            return NULL;
+        }
+        Job *job = &jobs[next_job++];
+        pthread_mutex_unlock(&job_lock);
+
+        job->ok = convert_job(job);
+        if (!job->ok) {
+            fprintf(stderr, "Cannot convert %s\n", job->path);
+        } else if (!option_pack) {
+            char path[800];
+            snprintf(path, sizeof(path), "%s/%s", job->res_dir, job->name);
+            job->ok = write_thumbnail_file(path, job);
+            free(job->data);
+            job->data = NULL;
+        }
+    }
+}
+
+static int compare_jobs_by_folder(const void *a, const void *b) {
+    const Job *ja = (const Job*)a;
+    const Job *jb = (const Job*)b;
+    int result = strcmp(ja->res_dir, jb->res_dir);
+    return result ? result : strcmp(ja->name, jb->name);
+}
+
+// Write the loose files of jobs[first..first + count) instead of a pack,
+// returns the number written
+static int write_folder_loose(Job *folder_jobs, int count) {
+    int written = 0;
+    for (int i = 0; i < count; i++) {
+        Job *job = &folder_jobs[i];
+        if (!job->ok) continue;
+        char path[800];
+        snprintf(path, sizeof(path), "%s/%s", job->res_dir, job->name);
+        written += write_thumbnail_file(path, job);
+    }
+    return written;
+}
+
+// Write the pack of jobs[first..first + count), all in one folder. Returns 1
+// if written, 0 on failure, -1 if two names share both hashes (which the
+// pack cannot tell apart).
+static int write_pack(Job *folder_jobs, int count, int *packed) {
+    uint32_t slot_count = 1;
+    while (slot_count < (uint32_t)count * 2) slot_count *= 2;
+    if (slot_count > THUMBNAIL_PACK_MAX_SLOTS) {
+        fprintf(stderr, "%s: too many thumbnails for one pack\n", folder_jobs[0].res_dir);
+        return 0;
+    }
+
+    ThumbnailPackEntry *slots = (ThumbnailPackEntry*)calloc(slot_count, sizeof(ThumbnailPackEntry));
+    if (!slots) return 0;
+
+    // Place every entry, then lay the blobs out in job order
+    uint32_t offset = sizeof(ThumbnailPackHeader) + slot_count * sizeof(ThumbnailPackEntry);
+    int ok = 1;
+    *packed = 0;
+    for (int i = 0; i < count; i++) {
+        Job *job = &folder_jobs[i];
+        if (!job->ok) continue;
+
+        uint32_t name_hash = hash_string(job->name);
+        uint32_t name_check = hash_string_seeded(job->name, THUMBNAIL_PACK_CHECK_SEED);
+        uint32_t index = name_hash & (slot_count - 1);
+        while (slots[index].size != 0) {
+            if (slots[index].name_hash == name_hash && slots[index].name_check == name_check) {
+                free(slots);
+                *packed = 0;
+                return -1;
+            }
+            index = (index + 1) & (slot_count - 1);
+        }
+
+        // Each blob follows its preview
+        offset += sizeof(ThumbnailPreview);
+        slots[index].name_hash = name_hash;
+        slots[index].name_check = name_check;
+        slots[index].offset = offset;
+        slots[index].size = job->size;
+        slots[index].width = (uint16_t)job->width;
+        slots[index].height = (uint16_t)job->height;
+        slots[index].format = (uint16_t)job->format;
+        slots[index].flags = (uint16_t)(job->flags | THUMBNAIL_FLAG_HAS_PREVIEW);
+        offset += job->size;
+        (*packed)++;
+    }
+
+    char path[800];
+    snprintf(path, sizeof(path), "%s/" THUMBNAIL_PACK_NAME, folder_jobs[0].res_dir);
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        free(slots);
+        return 0;
+    }
+
+    ThumbnailPackHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = THUMBNAIL_PACK_MAGIC;
+    header.version = THUMBNAIL_PACK_VERSION;
+    header.entry_count = *packed;
+    header.slot_count = slot_count;
+    ok &= fwrite(&header, sizeof(header), 1, fp) == 1;
+    ok &= fwrite(slots, sizeof(ThumbnailPackEntry), slot_count, fp) == slot_count;
+    for (int i = 0; i < count; i++) {
+        const Job *job = &folder_jobs[i];
+        if (!job->ok) continue;
+        ok &= fwrite(&job->preview, sizeof(ThumbnailPreview), 1, fp) == 1;
+        ok &= fwrite(job->data, 1, job->size, fp) == job->size;
+    }
+    if (fclose(fp) != 0) ok = 0;
+    free(slots);
+    return ok;
+}
+
+static void usage(void) {
+    fprintf(stderr, "Usage: frogui_thumbconv [-j threads] [--pack] [--raw] [--prescale] [--dither] <roms directory>\n");
+}
+
+int main(int argc, char **argv) {
+    int thread_count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char *roms_dir = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            thread_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pack") == 0) {
+            option_pack = 1;
+        } else if (strcmp(argv[i], "--raw") == 0) {
+            option_raw = 1;
+        } else if (strcmp(argv[i], "--prescale") == 0) {
+            option_prescale = 1;
+        } else if (strcmp(argv[i], "--dither") == 0) {
+            option_dither = 1;
+        } else if (argv[i][0] != '-' && !roms_dir) {
+            roms_dir = argv[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (!roms_dir) {
+        usage();
+        return 1;
+    }
+    if (thread_count < 1) thread_count = 1;
+    if (thread_count > MAX_THREADS) thread_count = MAX_THREADS;
+
+    char root[512];
+    snprintf(root, sizeof(root), "%s", roms_dir);
+    size_t root_len = strlen(root);
+    while (root_len > 1 && root[root_len - 1] == '/') {
+        root[--root_len] = '\0';
+    }
+    struct stat st;
+    if (stat(root, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        fprintf(stderr, "Directory '%s' not found\n", root);
+        return 1;
+    }
+    queue_folder(root, strcmp(strrchr(root, '/') ? strrchr(root, '/') + 1 : root, ".res") == 0);
+
+    // Folder order, so a pack's jobs are together
+    if (job_count > 0) qsort(jobs, job_count, sizeof(Job), compare_jobs_by_folder);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pthread_t threads[MAX_THREADS];
+    for (int i = 0; i < thread_count; i++) {
+        pthread_create(&threads[i], NULL, worker, NULL);
+    }
+    for (int i = 0; i < thread_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    int converted = 0;
+    int pack_count = 0;
+    int failed = 0;
+    for (int i = 0; i < job_count; i++) {
+        if (jobs[i].ok) converted++;
+        else failed++;
+    }
+
+    if (option_pack) {
+        for (int first = 0; first < job_count; ) {
+            int count = 1;
+            while (first + count < job_count && strcmp(jobs[first + count].res_dir, jobs[first].res_dir) == 0) {
+                count++;
+            }
+            int packed = 0;
+            int result = write_pack(&jobs[first], count, &packed);
+            if (result < 0) {
+                fprintf(stderr, "%s: two names share both pack hashes, writing loose files\n", jobs[first].res_dir);
+                int listed = 0;
+                for (int i = first; i < first + count; i++) listed += jobs[i].ok;
+                int written = write_folder_loose(&jobs[first], count);
+                failed += listed - written;
+                converted -= listed - written;
+            } else if (result) {
+                pack_count++;
+            } else {
+                fprintf(stderr, "Cannot write the pack for %s\n", jobs[first].res_dir);
+                failed += packed;
+                converted -= packed;
+            }
+            for (int i = first; i < first + count; i++) free(jobs[i].data);
+            first += count;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    printf("%d images, %d converted, %d failed, %d packs, %d threads, %.0f ms\n",
+           job_count, converted, failed, pack_count, thread_count, elapsed_ms);
+
+    free(jobs);
+    return failed ? 1 : 0;
+}
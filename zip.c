@@ -0,0 +1,132 @@
+#include "zip.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define ZIP_EOCD_SIGNATURE 0x06054b50
+#define ZIP_CENTRAL_SIGNATURE 0x02014b50
+#define ZIP_EOCD_SIZE 22
+#define ZIP_CENTRAL_SIZE 46
+#define ZIP_MAX_COMMENT 65535
+
+// Most archives have no comment, so the end record sits in the last few
+// bytes; the full comment-sized tail is only read when it is not found there
+#define ZIP_TAIL_READ 1024
+
+// Central directories larger than this are refused (about 40k members)
+#define ZIP_MAX_CENTRAL_SIZE (4 * 1024 * 1024)
+
+// Fields are little-endian and unaligned - read them byte by byte
+static uint16_t read_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t read_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Read the last tail_size bytes and find the end of central directory record
+static const uint8_t* find_end_record(FILE *fp, long file_size, uint8_t *tail, long tail_size) {
+    if (tail_size > file_size) tail_size = file_size;
+    if (tail_size < ZIP_EOCD_SIZE) return NULL;
+
+    if (fseek(fp, file_size - tail_size, SEEK_SET) != 0 ||
+        fread(tail, 1, tail_size, fp) != (size_t)tail_size) {
+        return NULL;
+    }
+
+    for (long i = tail_size - ZIP_EOCD_SIZE; i >= 0; i--) {
+        if (read_u32(tail + i) == ZIP_EOCD_SIGNATURE) {
+            return tail + i;
+        }
+    }
+    return NULL;
+}
+
+int zip_list_members(const char *zip_path, ZipMemberCallback callback, void *context) {
+    FILE *fp = fopen(zip_path, "rb");
+    if (!fp) return -1;
+
+    fseek(fp, 0, SEEK_END);
+    long file_size = ftell(fp);
+
+    uint8_t small_tail[ZIP_TAIL_READ];
+    const uint8_t *end_record = find_end_record(fp, file_size, small_tail, sizeof(small_tail));
+
+    uint8_t *large_tail = NULL;
+    if (!end_record && file_size > ZIP_TAIL_READ) {
+        large_tail = (uint8_t*)malloc(ZIP_EOCD_SIZE + ZIP_MAX_COMMENT);
+        if (large_tail) {
+            end_record = find_end_record(fp, file_size, large_tail, ZIP_EOCD_SIZE + ZIP_MAX_COMMENT);
+        }
+    }
+
+    if (!end_record) {
+        free(large_tail);
+        fclose(fp);
+        return -1;
+    }
+
+    uint16_t member_total = read_u16(end_record + 10);
+    uint32_t central_size = read_u32(end_record + 12);
+    uint32_t central_offset = read_u32(end_record + 16);
+    free(large_tail);
+
+    // Zip64 archives mark these fields with all ones - not supported
+    if (member_total == 0xFFFF || central_offset == 0xFFFFFFFF ||
+        central_size > ZIP_MAX_CENTRAL_SIZE ||
+        (long)central_offset + (long)central_size > file_size) {
+        fclose(fp);
+        return -1;
+    }
+
+    // Whole central directory in one read
+    uint8_t *central = (uint8_t*)malloc(central_size ? central_size : 1);
+    if (!central ||
+        fseek(fp, central_offset, SEEK_SET) != 0 ||
+        fread(central, 1, central_size, fp) != central_size) {
+        free(central);
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+
+    int member_count = 0;
+    uint32_t pos = 0;
+    for (int i = 0; i < member_total; i++) {
+        if (pos + ZIP_CENTRAL_SIZE > central_size ||
+            read_u32(central + pos) != ZIP_CENTRAL_SIGNATURE) {
+            break;  // Truncated directory - keep what was listed
+        }
+
+        const uint8_t *header = central + pos;
+        uint32_t size = read_u32(header + 24);
+        uint16_t name_len = read_u16(header + 28);
+        uint16_t extra_len = read_u16(header + 30);
+        uint16_t comment_len = read_u16(header + 32);
+
+        if (pos + ZIP_CENTRAL_SIZE + name_len > central_size) break;
+
+        char name[256];
+        int copy_len = name_len < sizeof(name) - 1 ? name_len : (int)sizeof(name) - 1;
+        memcpy(name, header + ZIP_CENTRAL_SIZE, copy_len);
+        name[copy_len] = '\0';
+
+        // Names ending in '/' are folder records
+        if (copy_len > 0 && name[copy_len - 1] != '/') {
+            if (callback) callback(name, size, context);
+            member_count++;
+        }
+
+        pos += ZIP_CENTRAL_SIZE + name_len + extra_len + comment_len;
+    }
+
+    free(central);
+    return member_count;
+}
+
+int zip_is_archive_name(const char *name) {
+    const char *dot = strrchr(name, '.');
+    return dot && strcasecmp(dot + 1, "zip") == 0;
+}
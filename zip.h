@@ -0,0 +1,19 @@
+#ifndef ZIP_H
+#define ZIP_H
+
+#include <stdint.h>
+
+// Zip member listing from the central directory only - the archive body is
+// never read and nothing is inflated.
+
+// Called for every file member (folders inside the archive are skipped)
+typedef void (*ZipMemberCallback)(const char *name, uint32_t size, void *context);
+
+// List the members of a zip archive. Returns the number of members, or -1 if
+// the file is not a readable zip (missing end record, zip64, truncated).
+int zip_list_members(const char *zip_path, ZipMemberCallback callback, void *context);
+
+// 1 if the name has a .zip extension (case-insensitive)
+int zip_is_archive_name(const char *name);
+
+#endif // ZIP_H